@@ -0,0 +1,547 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "catalogwindow.h"
+#include <QAbstractTableModel>
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QSortFilterProxyModel>
+#include <QStandardPaths>
+#include <QStatusBar>
+#include <QToolBar>
+#include <set>
+#include <unordered_set>
+
+namespace {
+
+enum Column {
+    FileColumn,
+    SamplesColumn,
+    MeanColumn,
+    MedianColumn,
+    P95Column,
+    P99Column,
+    MaxColumn,
+    StdevColumn,
+    DurationColumn,
+    MissingColumn,
+    ModifiedColumn,
+    ColumnCount
+};
+
+const char *const kTitles[ColumnCount] = { "File", "Samples", "Mean (us)", "Median (us)", "p95 (us)", "p99 (us)",
+                                           "Max (us)", "Stdev (us)", "Duration (s)", "Missing", "Modified" };
+
+// Names accepted by the filter, "p95>8ms"
+struct FilterField {
+    const char *name;
+    int column;
+};
+
+const FilterField kFilterFields[] = {
+    { "samples", SamplesColumn }, { "n", SamplesColumn }, { "mean", MeanColumn }, { "avg", MeanColumn },
+    { "median", MedianColumn }, { "p50", MedianColumn }, { "p95", P95Column }, { "p99", P99Column },
+    { "max", MaxColumn }, { "stdev", StdevColumn }, { "duration", DurationColumn }, { "missing", MissingColumn }
+};
+
+bool isLatency(int column) {
+    return column >= MeanColumn && column <= StdevColumn;
+}
+
+double columnValue(const xlat::CatalogEntry &entry, int column) {
+    const xlat::LatencySummary &s = entry.summary;
+    switch (column) {
+    case SamplesColumn:  return double(s.count);
+    case MeanColumn:     return s.avgLatency;
+    case MedianColumn:   return s.medianLatency;
+    case P95Column:      return s.p95;
+    case P99Column:      return s.p99;
+    case MaxColumn:      return s.maxLatency;
+    case StdevColumn:    return s.stdev;
+    case DurationColumn: return entry.durationSeconds;
+    case MissingColumn:  return double(entry.missingReports);
+    case ModifiedColumn: return double(entry.file.modifiedMs);
+    }
+    return 0.0;
+}
+
+QString toQString(const std::string &path) {
+    return QFile::decodeName(QByteArray::fromStdString(path));
+}
+
+std::vector<xlat::FileStamp> listCaptures(const QString &folder, const std::atomic<bool> &cancel) {
+    std::vector<xlat::FileStamp> files;
+    QDirIterator it(folder, QStringList() << "*.csv" << "*.xlatc", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext() && !cancel) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        xlat::FileStamp stamp;
+        stamp.path = QFile::encodeName(info.absoluteFilePath()).toStdString();
+        stamp.size = std::uint64_t(info.size());
+        stamp.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+        files.push_back(std::move(stamp));
+    }
+    return files;
+}
+
+} // namespace
+
+// Rows are the catalog entries in index order, the proxy sorts and filters them
+class CatalogModel : public QAbstractTableModel
+{
+public:
+    CatalogModel(xlat::SessionCatalog &catalog, QObject *parent)
+        : QAbstractTableModel(parent)
+        , m_catalog(catalog)
+    {
+    }
+
+    const xlat::CatalogEntry &entry(int row) const { return m_catalog.entries()[std::size_t(row)]; }
+
+    QString displayPath(int row) const {
+        return QDir::toNativeSeparators(m_root.relativeFilePath(toQString(entry(row).file.path)));
+    }
+
+    bool load(const QString &folder, const std::string &indexPath, std::string *error) {
+        beginResetModel();
+        m_root = QDir(folder);
+        bool ok = m_catalog.load(indexPath, error);
+        endResetModel();
+        return ok;
+    }
+
+    // Drops files that disappeared, a full reset but it only happens on rescans
+    std::size_t retain(const std::vector<xlat::FileStamp> &files) {
+        std::unordered_set<std::string> present;
+        for (const xlat::FileStamp &file : files) {
+            present.insert(file.path);
+        }
+        bool gone = false;
+        for (const xlat::CatalogEntry &e : m_catalog.entries()) {
+            if (!present.count(e.file.path)) {
+                gone = true;
+                break;
+            }
+        }
+        if (!gone) return 0;
+
+        beginResetModel();
+        std::size_t removed = m_catalog.retain(files);
+        endResetModel();
+        return removed;
+    }
+
+    // New files are appended as rows, re-indexed ones are updated in place
+    void add(std::vector<xlat::CatalogEntry> &entries) {
+        std::vector<xlat::CatalogEntry> fresh;
+        bool updated = false;
+        for (xlat::CatalogEntry &e : entries) {
+            if (m_catalog.contains(e.file.path)) {
+                m_catalog.insert(std::move(e));
+                updated = true;
+            } else {
+                fresh.push_back(std::move(e));
+            }
+        }
+        if (updated && rowCount() > 0) {
+            emit dataChanged(index(0, 0), index(rowCount() - 1, ColumnCount - 1));
+        }
+        if (!fresh.empty()) {
+            beginInsertRows(QModelIndex(), rowCount(), rowCount() + int(fresh.size()) - 1);
+            for (xlat::CatalogEntry &e : fresh) {
+                m_catalog.insert(std::move(e));
+            }
+            endInsertRows();
+        }
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : int(m_catalog.size());
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : ColumnCount;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override {
+        if (!index.isValid()) return QVariant();
+        const xlat::CatalogEntry &e = entry(index.row());
+        const int column = index.column();
+
+        switch (role) {
+        case Qt::DisplayRole:
+            if (column == FileColumn) return displayPath(index.row());
+            if (column == ModifiedColumn) {
+                return QDateTime::fromMSecsSinceEpoch(e.file.modifiedMs).toString("yyyy-MM-dd hh:mm");
+            }
+            if (!e.ok || (column == DurationColumn && e.durationSeconds < 0.0)) return "-";
+            if (column == MeanColumn || column == StdevColumn) return QString::number(columnValue(e, column), 'f', 1);
+            if (column == DurationColumn) return QString::number(e.durationSeconds, 'f', 1);
+            return QString::number(columnValue(e, column), 'f', 0);
+        case Qt::UserRole:
+            // Sort key, failed files sort below every real value
+            if (column == FileColumn) return displayPath(index.row()).toLower();
+            if (column != ModifiedColumn && !e.ok) return -1.0;
+            return columnValue(e, column);
+        case Qt::ToolTipRole:
+            return e.ok ? toQString(e.file.path) : toQString(e.file.path) + "\n" + QString::fromStdString(e.error);
+        case Qt::ForegroundRole:
+            if (!e.ok) return QColor(Qt::gray);
+            break;
+        case Qt::TextAlignmentRole:
+            if (column != FileColumn) return int(Qt::AlignRight | Qt::AlignVCenter);
+            break;
+        }
+        return QVariant();
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override {
+        if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < ColumnCount) {
+            return kTitles[section];
+        }
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+private:
+    xlat::SessionCatalog &m_catalog;
+    QDir m_root;
+};
+
+// "p95>8ms samples>=10000 mouse": every condition must hold and every other
+// word must appear in the file path. Parsed once per edit, rows are then
+// checked against the summaries only.
+class CatalogFilter : public QSortFilterProxyModel
+{
+public:
+    CatalogFilter(CatalogModel *model, QObject *parent)
+        : QSortFilterProxyModel(parent)
+        , m_model(model)
+    {
+        setSourceModel(model);
+        setSortRole(Qt::UserRole);
+    }
+
+    void setFilterText(const QString &text) {
+        static const QRegularExpression condition("([a-z0-9]+)\\s*(<=|>=|!=|<|>|=)\\s*(-?\\d+(?:\\.\\d+)?)\\s*(us|ms|s|min|h)?\\b",
+                                                  QRegularExpression::CaseInsensitiveOption);
+        m_conditions.clear();
+        QString words = text;
+        QRegularExpressionMatchIterator it = condition.globalMatch(text);
+        int removed = 0;
+        while (it.hasNext()) {
+            QRegularExpressionMatch match = it.next();
+            int column = -1;
+            for (const FilterField &field : kFilterFields) {
+                if (match.captured(1).compare(field.name, Qt::CaseInsensitive) == 0) column = field.column;
+            }
+            if (column < 0) continue; // not a field, left to the path words
+
+            Condition c;
+            c.column = column;
+            c.op = match.captured(2);
+            c.value = match.captured(3).toDouble() * unitScale(column, match.captured(4).toLower());
+            m_conditions.push_back(c);
+            words.remove(match.capturedStart() - removed, match.capturedLength());
+            removed += match.capturedLength();
+        }
+        m_words = words.split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+        invalidateFilter();
+    }
+
+protected:
+    bool filterAcceptsRow(int row, const QModelIndex &) const override {
+        const xlat::CatalogEntry &e = m_model->entry(row);
+        for (const Condition &c : m_conditions) {
+            if (!e.ok || (c.column == DurationColumn && e.durationSeconds < 0.0)) return false;
+            double v = columnValue(e, c.column);
+            bool pass = c.op == "<" ? v < c.value : c.op == ">" ? v > c.value : c.op == "<=" ? v <= c.value
+                      : c.op == ">=" ? v >= c.value : c.op == "!=" ? v != c.value : v == c.value;
+            if (!pass) return false;
+        }
+        if (!m_words.isEmpty()) {
+            const QString path = m_model->displayPath(row);
+            for (const QString &word : m_words) {
+                if (!path.contains(word, Qt::CaseInsensitive)) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Condition {
+        int column;
+        QString op;
+        double value;
+    };
+
+    // Latencies are kept in us and durations in s
+    static double unitScale(int column, const QString &unit) {
+        if (isLatency(column)) {
+            return unit == "ms" ? 1e3 : unit == "s" ? 1e6 : 1.0;
+        }
+        if (column == DurationColumn) {
+            return unit == "ms" ? 1e-3 : unit == "min" ? 60.0 : unit == "h" ? 3600.0 : 1.0;
+        }
+        return 1.0;
+    }
+
+    CatalogModel *m_model;
+    std::vector<Condition> m_conditions;
+    QStringList m_words;
+};
+
+CatalogWindow::CatalogWindow(QWidget *parent)
+    : QMainWindow(parent)
+{
+    setWindowTitle("Session Catalog");
+    resize(1200, 700);
+
+    m_model = new CatalogModel(m_catalog, this);
+    m_filter = new CatalogFilter(m_model, this);
+
+    m_table = new QTableView();
+    m_table->setModel(m_filter);
+    m_table->setSortingEnabled(true);
+    m_table->sortByColumn(ModifiedColumn, Qt::DescendingOrder);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(FileColumn, QHeaderView::Stretch);
+    setCentralWidget(m_table);
+
+    QToolBar *toolbar = addToolBar("Catalog");
+    toolbar->setMovable(false);
+    toolbar->addAction("Folder...", [this]() { chooseFolder(); });
+    toolbar->addAction("Rescan", [this]() { rescan(); });
+    m_folderLabel = new QLabel();
+    toolbar->addWidget(m_folderLabel);
+    toolbar->addSeparator();
+    m_filterEdit = new QLineEdit();
+    m_filterEdit->setPlaceholderText("Filter, e.g. p95>8ms samples>=10000 mouse");
+    m_filterEdit->setToolTip("Conditions on samples, mean, median, p95, p99, max, stdev (us, ms or s), "
+                             "duration (s, min or h) and missing, other words must appear in the file path");
+    m_filterEdit->setClearButtonEnabled(true);
+    toolbar->addWidget(m_filterEdit);
+
+    m_status = new QLabel();
+    statusBar()->addWidget(m_status);
+
+    m_watcher = new QFileSystemWatcher(this);
+    m_rescanTimer = new QTimer(this);
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(2000);
+    m_collectTimer = new QTimer(this);
+    m_collectTimer->setInterval(200);
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_rescanTimer, QOverload<>::of(&QTimer::start));
+    connect(m_rescanTimer, &QTimer::timeout, this, &CatalogWindow::rescan);
+    connect(m_collectTimer, &QTimer::timeout, this, &CatalogWindow::collectResults);
+    connect(m_filterEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
+        m_filter->setFilterText(text);
+        updateStatus();
+    });
+    connect(m_table, &QTableView::activated, this, [this](const QModelIndex &index) {
+        const xlat::CatalogEntry &entry = m_model->entry(m_filter->mapToSource(index).row());
+        if (!entry.ok) {
+            statusBar()->showMessage("Cannot open: " + QString::fromStdString(entry.error), 5000);
+            return;
+        }
+        emit openRequested(toQString(entry.file.path));
+    });
+
+    QString folder = QSettings("xlat-Evtool", "xlat-Evtool").value("catalog/folder").toString();
+    if (!folder.isEmpty() && QDir(folder).exists()) {
+        setFolder(folder);
+    } else {
+        updateStatus();
+    }
+}
+
+CatalogWindow::~CatalogWindow() {
+    stopScan();
+}
+
+void CatalogWindow::chooseFolder() {
+    QString folder = QFileDialog::getExistingDirectory(this, "Capture Folder", m_folder);
+    if (!folder.isEmpty()) {
+        setFolder(folder);
+    }
+}
+
+QString CatalogWindow::indexPath() const {
+    // One index per folder, next to the app data rather than on a shared drive
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation));
+    dir.mkpath(".");
+    QByteArray key = QCryptographicHash::hash(QDir(m_folder).canonicalPath().toUtf8(), QCryptographicHash::Sha1);
+    return dir.filePath("catalog-" + QString::fromLatin1(key.toHex().left(16)) + ".idx");
+}
+
+void CatalogWindow::setFolder(const QString &folder) {
+    stopScan();
+    if (!m_watcher->directories().isEmpty()) {
+        m_watcher->removePaths(m_watcher->directories());
+    }
+
+    m_folder = folder;
+    m_folderLabel->setText(QDir::toNativeSeparators(folder));
+    QSettings("xlat-Evtool", "xlat-Evtool").setValue("catalog/folder", folder);
+
+    std::string error;
+    if (!m_model->load(folder, QFile::encodeName(indexPath()).toStdString(), &error)) {
+        statusBar()->showMessage(QString::fromStdString(error) + ", rebuilding", 5000);
+    }
+    m_watcher->addPath(folder);
+    rescan();
+}
+
+void CatalogWindow::rescan() {
+    if (m_folder.isEmpty()) {
+        return;
+    }
+    if (m_scanning) {
+        m_rescanQueued = true;
+        return;
+    }
+
+    m_scanning = true;
+    m_cancel = false;
+    m_finished = false;
+    m_indexed = 0;
+    m_toIndex = 0;
+
+    // The worker compares stamps against a snapshot, the catalog itself is
+    // only touched on this thread
+    const QString folder = m_folder;
+    const xlat::SessionCatalog known = m_catalog;
+    m_worker = std::thread([this, folder, known]() {
+        std::vector<xlat::FileStamp> files = listCaptures(folder, m_cancel);
+        std::vector<xlat::FileStamp> stale = known.staleFiles(files);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_listed = !m_cancel; // a cut-short listing must not drop entries
+            m_listing = std::move(files);
+            m_toIndex = stale.size();
+        }
+        xlat::indexCaptures(stale, m_cancel, [this](xlat::CatalogEntry &&entry) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::move(entry));
+        });
+        m_finished = true;
+    });
+    m_collectTimer->start();
+    updateStatus();
+}
+
+void CatalogWindow::stopScan() {
+    m_rescanQueued = false;
+    m_rescanTimer->stop();
+    if (m_scanning) {
+        m_cancel = true;
+        m_worker.join();
+        collectResults();
+    }
+}
+
+void CatalogWindow::collectResults() {
+    // Read before the hand-over, everything the worker produced is then in it
+    const bool finished = m_finished;
+
+    bool listed;
+    std::vector<xlat::FileStamp> listing;
+    std::vector<xlat::CatalogEntry> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        listed = m_listed;
+        m_listed = false;
+        listing.swap(m_listing);
+        results.swap(m_results);
+    }
+
+    if (listed) {
+        m_unsaved += m_model->retain(listing);
+
+        // Watch every folder holding captures, for files dropped in later
+        std::set<QString> folders;
+        for (const xlat::FileStamp &file : listing) {
+            folders.insert(QFileInfo(toQString(file.path)).absolutePath());
+        }
+        QStringList watched = m_watcher->directories();
+        for (const QString &folder : folders) {
+            if (!watched.contains(folder)) m_watcher->addPath(folder);
+        }
+    }
+    if (!results.empty()) {
+        m_indexed += results.size();
+        m_unsaved += results.size();
+        m_model->add(results);
+    }
+
+    // A long first scan keeps what it has done so far
+    if (m_unsaved >= 500) {
+        saveIndex();
+    }
+
+    if (finished) {
+        m_collectTimer->stop();
+        if (m_worker.joinable()) m_worker.join();
+        m_scanning = false;
+        if (m_unsaved) saveIndex();
+        if (m_rescanQueued) {
+            m_rescanQueued = false;
+            rescan();
+        }
+    }
+    updateStatus();
+}
+
+void CatalogWindow::saveIndex() {
+    std::string error;
+    if (!m_catalog.save(QFile::encodeName(indexPath()).toStdString(), &error)) {
+        statusBar()->showMessage(QString::fromStdString(error), 5000);
+    }
+    m_unsaved = 0;
+}
+
+void CatalogWindow::updateStatus() {
+    if (m_folder.isEmpty()) {
+        m_status->setText("Choose a folder of captures");
+        return;
+    }
+
+    QString text = QString::number(m_catalog.size()) + " sessions, " + QString::number(m_filter->rowCount()) + " shown";
+    if (m_scanning) {
+        std::size_t toIndex;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            toIndex = m_toIndex;
+        }
+        text += toIndex ? ", indexing " + QString::number(m_indexed) + "/" + QString::number(toIndex) : ", scanning...";
+    }
+    m_status->setText(text);
+}
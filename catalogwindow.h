@@ -0,0 +1,91 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef CATALOGWINDOW_H
+#define CATALOGWINDOW_H
+
+#include "xlat_catalog.h"
+#include <QFileSystemWatcher>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMainWindow>
+#include <QTableView>
+#include <QTimer>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CatalogModel;
+class CatalogFilter;
+
+// Browses the summaries of every capture under a folder. The index is built in
+// the background on all cores and kept in the app data folder, so a rescan
+// only reads new or changed files. Filtering and sorting work on the index
+// alone, a session is opened when its row is activated.
+class CatalogWindow : public QMainWindow
+{
+    Q_OBJECT
+public:
+    explicit CatalogWindow(QWidget *parent = nullptr);
+    ~CatalogWindow() override;
+
+signals:
+    void openRequested(const QString &path);
+
+private:
+    void chooseFolder();
+    void setFolder(const QString &folder);
+    void rescan();
+    void stopScan();
+    void collectResults();
+    void saveIndex();
+    void updateStatus();
+    QString indexPath() const;
+
+    xlat::SessionCatalog m_catalog;
+    QString m_folder;
+
+    CatalogModel *m_model;
+    CatalogFilter *m_filter;
+    QTableView *m_table;
+    QLineEdit *m_filterEdit;
+    QLabel *m_folderLabel;
+    QLabel *m_status;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_rescanTimer;  // folds bursts of directory changes into one scan
+    QTimer *m_collectTimer; // moves finished summaries into the table while scanning
+
+    // Background scan: lists the folder, then indexes what changed. Results are
+    // handed over under m_mutex and picked up by collectResults().
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{ false };
+    std::atomic<bool> m_finished{ false };
+    std::mutex m_mutex;
+    bool m_listed = false;
+    std::vector<xlat::FileStamp> m_listing;
+    std::vector<xlat::CatalogEntry> m_results;
+    std::size_t m_toIndex = 0;
+
+    bool m_scanning = false;
+    bool m_rescanQueued = false;
+    std::size_t m_indexed = 0;
+    std::size_t m_unsaved = 0;
+};
+
+#endif // CATALOGWINDOW_H
@@ -0,0 +1,460 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "chartrenderer.h"
+#include "xlat_parallel.h"
+#include "xlat_session.h"
+#include "xlat_stats.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QPolygonF>
+#include <QSvgGenerator>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+namespace {
+
+const QColor kScatterColor(Qt::blue);
+const QColor kOutlierColor(Qt::red);
+const QColor kBandColor(69, 117, 180, 90);
+const QColor kBandBorder(69, 117, 180);
+const QColor kMedianColor(49, 54, 149);
+const QColor kMaxColor(165, 0, 38);
+const QColor kGridColor(225, 225, 225);
+
+// Same labels as the distribution window's spectrum axis
+const double kSpectrumLabels[] = { 0.5, 0.9, 0.99, 0.999, 0.9999 };
+const char *const kSpectrumNames[] = { "p50", "p90", "p99", "p99.9", "p99.99" };
+
+// Segments merged past this many points, like the timeline window
+const std::size_t kMaxTimelinePoints = 2000;
+
+// Round step giving about `ticks` gridlines over `range`
+double tickStep(double range, int ticks) {
+    double raw = range / std::max(ticks, 1);
+    if (!(raw > 0.0)) return 1.0;
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    double n = raw / magnitude;
+    return (n < 1.5 ? 1.0 : n < 3.0 ? 2.0 : n < 7.0 ? 5.0 : 10.0) * magnitude;
+}
+
+QString tickLabel(double value, double step) {
+    return QString::number(value, 'f', step >= 1.0 ? 0 : int(std::ceil(-std::log10(step))));
+}
+
+// A titled plot area with value axes, everything scaled from the font size
+class Plot
+{
+public:
+    Plot(QPainter &painter, const QRectF &rect, const QString &title, const QString &xTitle, const QString &yTitle,
+         double x0, double x1, double y0, double y1, bool xTicks = true)
+        : m_painter(painter)
+        , m_x0(x0), m_x1(x1 > x0 ? x1 : x0 + 1.0)
+        , m_y0(y0), m_y1(y1 > y0 ? y1 : y0 + 1.0)
+    {
+        QFontMetricsF metrics(painter.font());
+        const double line = metrics.height();
+        const double yLabelWidth = std::max(metrics.horizontalAdvance(tickLabel(m_y1, tickStep(m_y1 - m_y0, 8))),
+                                            metrics.horizontalAdvance("0.00"));
+        m_area = QRectF(rect.left() + line * 1.5 + yLabelWidth + line * 0.5, rect.top() + line * 2.0, 0, 0);
+        m_area.setRight(rect.right() - line);
+        m_area.setBottom(rect.bottom() - line * 3.0);
+
+        painter.save();
+        QFont titleFont = painter.font();
+        titleFont.setBold(true);
+        painter.setFont(titleFont);
+        painter.setPen(Qt::black);
+        painter.drawText(QRectF(rect.left(), rect.top(), rect.width(), line * 2.0), Qt::AlignCenter, title);
+        painter.restore();
+
+        painter.save();
+        painter.setPen(Qt::black);
+        if (xTicks) {
+            const double step = tickStep(m_x1 - m_x0, 10);
+            for (double x = std::ceil(m_x0 / step) * step; x <= m_x1 + step * 1e-9; x += step) {
+                gridX(x, tickLabel(x, step));
+            }
+        }
+        const double step = tickStep(m_y1 - m_y0, 8);
+        for (double y = std::ceil(m_y0 / step) * step; y <= m_y1 + step * 1e-9; y += step) {
+            QPointF p = map(m_x0, y);
+            painter.setPen(kGridColor);
+            painter.drawLine(QPointF(m_area.left(), p.y()), QPointF(m_area.right(), p.y()));
+            painter.setPen(Qt::black);
+            painter.drawText(QRectF(rect.left(), p.y() - line / 2, m_area.left() - rect.left() - line * 0.3, line),
+                             Qt::AlignRight | Qt::AlignVCenter, tickLabel(y, step));
+        }
+        painter.drawRect(m_area);
+        painter.drawText(QRectF(m_area.left(), m_area.bottom() + line * 1.5, m_area.width(), line * 1.5),
+                         Qt::AlignCenter, xTitle);
+        painter.translate(rect.left(), m_area.center().y());
+        painter.rotate(-90);
+        painter.drawText(QRectF(-m_area.height() / 2, 0, m_area.height(), line * 1.5), Qt::AlignCenter, yTitle);
+        painter.restore();
+    }
+
+    QPointF map(double x, double y) const {
+        return QPointF(m_area.left() + (x - m_x0) / (m_x1 - m_x0) * m_area.width(),
+                       m_area.bottom() - (y - m_y0) / (m_y1 - m_y0) * m_area.height());
+    }
+
+    // Vertical gridline with its label under the axis
+    void gridX(double x, const QString &label) {
+        const double line = QFontMetricsF(m_painter.font()).height();
+        QPointF p = map(x, m_y0);
+        m_painter.save();
+        m_painter.setPen(kGridColor);
+        m_painter.drawLine(QPointF(p.x(), m_area.top()), QPointF(p.x(), m_area.bottom()));
+        m_painter.setPen(Qt::black);
+        m_painter.drawText(QRectF(p.x() - line * 3, m_area.bottom() + line * 0.2, line * 6, line),
+                           Qt::AlignHCenter | Qt::AlignTop, label);
+        m_painter.restore();
+    }
+
+    // Everything drawn between begin/endData is clipped to the plot area
+    void beginData() {
+        m_painter.save();
+        m_painter.setClipRect(m_area);
+    }
+    void endData() { m_painter.restore(); }
+
+    void legend(const QVector<QPair<QString, QColor>> &entries) {
+        const double line = QFontMetricsF(m_painter.font()).height();
+        m_painter.save();
+        double y = m_area.top() + line * 0.5;
+        for (const auto &entry : entries) {
+            QRectF swatch(m_area.right() - line * 8, y + line * 0.2, line * 0.6, line * 0.6);
+            m_painter.fillRect(swatch, entry.second);
+            m_painter.setPen(Qt::black);
+            m_painter.drawText(QRectF(swatch.right() + line * 0.4, y, line * 7, line), Qt::AlignLeft | Qt::AlignVCenter,
+                               entry.first);
+            y += line * 1.2;
+        }
+        m_painter.restore();
+    }
+
+private:
+    QPainter &m_painter;
+    QRectF m_area;
+    double m_x0, m_x1, m_y0, m_y1;
+};
+
+QString chartTitle(const ChartData &data, const char *chart) {
+    return data.title.isEmpty() ? QString(chart) : data.title + " - " + chart;
+}
+
+void paintScatter(QPainter &painter, const QRect &rect, const ChartData &data) {
+    QVector<QPointF> points = data.store ? ChartRenderer::scatterPoints(*data.store) : QVector<QPointF>();
+    double x0 = 0.0, x1 = 1.0;
+    if (!points.isEmpty()) {
+        auto range = std::minmax_element(points.begin(), points.end(),
+                                         [](const QPointF &a, const QPointF &b) { return a.x() < b.x(); });
+        x0 = range.first->x();
+        x1 = range.second->x();
+    }
+    const int maxLatency = data.histogram ? data.histogram->maxValue() : 0;
+    Plot plot(painter, rect, chartTitle(data, "Latency Scatter Chart"), "Report number", "Latency (us)", x0, x1, 0,
+              std::max(maxLatency, 1) * 1.1); // 10% above the max like the scatter window
+
+    const double marker = std::max(2.0, QFontMetricsF(painter.font()).height() / 4);
+    plot.beginData();
+    QVector<QPointF> mapped;
+    mapped.reserve(points.size());
+    for (const QPointF &p : points) {
+        mapped.append(plot.map(p.x(), p.y()));
+    }
+    painter.setPen(QPen(kScatterColor, marker, Qt::SolidLine, Qt::RoundCap));
+    painter.drawPoints(mapped.constData(), mapped.size());
+
+    // Flagged reports drawn on top in red
+    const bool outliers = data.outliers && !data.outliers->empty();
+    if (outliers) {
+        mapped.clear();
+        for (const xlat::OutlierRecord &outlier : *data.outliers) {
+            mapped.append(plot.map(outlier.reportNumber, outlier.latency));
+        }
+        painter.setPen(QPen(kOutlierColor, marker * 1.75, Qt::SolidLine, Qt::RoundCap));
+        painter.drawPoints(mapped.constData(), mapped.size());
+    }
+    plot.endData();
+    if (outliers) {
+        plot.legend({ qMakePair(QString("Outliers"), kOutlierColor) });
+    }
+}
+
+void paintDistribution(QPainter &painter, const QRect &rect, const ChartData &data) {
+    static const xlat::LatencyHistogram empty;
+    const xlat::LatencyHistogram &histogram = data.histogram ? *data.histogram : empty;
+    const QRect left(rect.left(), rect.top(), rect.width() / 2, rect.height());
+    const QRect right(left.right() + 1, rect.top(), rect.width() - left.width(), rect.height());
+
+    Plot cdf(painter, left, chartTitle(data, "Empirical CDF"), "Latency (us)", "Fraction of samples",
+             histogram.minValue(), std::max(histogram.maxValue(), histogram.minValue() + 1), 0, 1);
+    const double first = xlat::spectrumPosition(0.5);
+    const double last = xlat::spectrumPosition(0.9999);
+    Plot spectrum(painter, right, chartTitle(data, "Percentile spectrum"), "Percentile", "Latency (us)", first, last,
+                  histogram.median() * 0.9, histogram.maxValue() * 1.05, false);
+    for (std::size_t i = 0; i < sizeof(kSpectrumLabels) / sizeof(kSpectrumLabels[0]); ++i) {
+        spectrum.gridX(xlat::spectrumPosition(kSpectrumLabels[i]), kSpectrumNames[i]);
+    }
+    if (histogram.isEmpty()) {
+        return;
+    }
+
+    const double width = std::max(1.5, QFontMetricsF(painter.font()).height() / 8);
+    QPolygonF line;
+    for (const xlat::CdfPoint &p : xlat::ecdfPoints(histogram)) {
+        line.append(cdf.map(p.latency, p.fraction));
+    }
+    cdf.beginData();
+    painter.setPen(QPen(kScatterColor, width));
+    painter.drawPolyline(line);
+    cdf.endData();
+
+    line.clear();
+    for (const xlat::SpectrumPoint &p : xlat::percentileSpectrum(histogram)) {
+        line.append(spectrum.map(xlat::spectrumPosition(p.fraction), p.latency));
+    }
+    spectrum.beginData();
+    painter.setPen(QPen(kScatterColor, width));
+    painter.drawPolyline(line);
+    spectrum.endData();
+}
+
+void paintTimeline(QPainter &painter, const QRect &rect, const ChartData &data) {
+    std::vector<xlat::TimelineSegment> segments;
+    if (data.timeline) {
+        segments = data.timeline->segments();
+        xlat::TimelineSegment open = data.timeline->openSegment();
+        if (open.count) {
+            segments.push_back(open);
+        }
+    }
+    const bool timed = !segments.empty() && segments.front().startNs >= 0;
+
+    // Neighbours merged: widest band, highest max, count-weighted median
+    const std::size_t stride = std::max<std::size_t>(1, (segments.size() + kMaxTimelinePoints - 1) / kMaxTimelinePoints);
+    QVector<double> xs, p5, p50, p95, max;
+    int highest = 0;
+    for (std::size_t i = 0; i < segments.size(); i += stride) {
+        const std::size_t end = std::min(segments.size(), i + stride);
+        int low = segments[i].p5, high = segments[i].p95, top = segments[i].maxLatency;
+        double medianSum = 0.0, count = 0.0;
+        for (std::size_t j = i; j < end; ++j) {
+            low = std::min(low, segments[j].p5);
+            high = std::max(high, segments[j].p95);
+            top = std::max(top, segments[j].maxLatency);
+            medianSum += double(segments[j].p50) * segments[j].count;
+            count += segments[j].count;
+        }
+        xs.append(timed ? double(segments[i].startNs) / 1e9 : double(segments[i].firstIndex));
+        p5.append(low);
+        p95.append(high);
+        p50.append(count > 0.0 ? medianSum / count : 0.0);
+        max.append(top);
+        highest = std::max(highest, top);
+    }
+
+    Plot plot(painter, rect, chartTitle(data, "Latency per Segment"), timed ? "Time (s)" : "Report index",
+              "Latency (us)", 0, xs.isEmpty() ? 1.0 : std::max(xs.back(), 1.0), 0, std::max(highest, 1) * 1.1);
+    if (xs.isEmpty()) {
+        return;
+    }
+
+    QPolygonF band, median, peak;
+    for (int i = 0; i < xs.size(); ++i) {
+        band.append(plot.map(xs[i], p95[i]));
+        median.append(plot.map(xs[i], p50[i]));
+        peak.append(plot.map(xs[i], max[i]));
+    }
+    for (int i = xs.size() - 1; i >= 0; --i) {
+        band.append(plot.map(xs[i], p5[i]));
+    }
+
+    const double width = std::max(1.5, QFontMetricsF(painter.font()).height() / 8);
+    plot.beginData();
+    painter.setPen(QPen(kBandBorder, 1));
+    painter.setBrush(kBandColor);
+    painter.drawPolygon(band);
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(kMedianColor, width));
+    painter.drawPolyline(median);
+    painter.setPen(QPen(kMaxColor, width));
+    painter.drawPolyline(peak);
+    plot.endData();
+    plot.legend({ qMakePair(QString("p5 - p95"), kBandBorder), qMakePair(QString("p50"), kMedianColor),
+                  qMakePair(QString("max"), kMaxColor) });
+}
+
+const char *chartSuffix(ChartKind kind) {
+    switch (kind) {
+    case ScatterChart: return "scatter";
+    case DistributionChart: return "distribution";
+    case TimelineChart: return "timeline";
+    default: return "chart";
+    }
+}
+
+// Loads, analyses like an import, then renders. Empty on success.
+QString renderCapture(const QString &filePath, const QString &basePath, const ChartRenderSettings &settings) {
+    // Runs on render workers, where an escaping exception would end the app
+    try {
+        const std::string path = QFile::encodeName(filePath).toStdString();
+        xlat::CaptureCsv capture;
+        std::string error;
+        if (!xlat::readCapture(path, capture, &error)) {
+            return QString::fromStdString(error);
+        }
+        if (capture.samples.empty()) {
+            return "no samples";
+        }
+
+        xlat::CaptureSession session;
+        session.pushCapture(capture.samples, capture.hostTimesNs, false);
+        if (!session.timeline().load(QFile::encodeName(filePath + ".xlatseg").toStdString(),
+                                     std::uint64_t(QFileInfo(filePath).size()), session.store())) {
+            session.timeline().rebuild(session.store(), session.timeline().settings());
+        }
+
+        ChartData data;
+        data.title = QFileInfo(filePath).completeBaseName();
+        data.store = &session.store();
+        data.histogram = &session.metrics().histogram();
+        data.outliers = &session.outliers().outliers();
+        data.timeline = &session.timeline();
+
+        QString renderError;
+        return ChartRenderer::render(data, basePath, settings, &renderError) ? QString() : renderError;
+    } catch (const std::exception &e) {
+        return QString::fromLocal8Bit(e.what());
+    }
+}
+
+} // namespace
+
+void ChartRenderer::paint(QPainter &painter, const QRect &rect, ChartKind kind, const ChartData &data) {
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect, Qt::white);
+    QFont font = painter.font();
+    font.setPixelSize(std::max(10, std::min(rect.width(), rect.height() * 16 / 9) / 110));
+    painter.setFont(font);
+
+    switch (kind) {
+    case ScatterChart: paintScatter(painter, rect, data); break;
+    case DistributionChart: paintDistribution(painter, rect, data); break;
+    case TimelineChart: paintTimeline(painter, rect, data); break;
+    default: break;
+    }
+    painter.restore();
+}
+
+bool ChartRenderer::render(const ChartData &data, const QString &basePath, const ChartRenderSettings &settings,
+                           QString *error) {
+    const QRect rect(QPoint(0, 0), settings.size);
+    for (ChartKind kind : { ScatterChart, DistributionChart, TimelineChart }) {
+        if (!(settings.charts & kind)) continue;
+        const QString base = basePath + "-" + chartSuffix(kind);
+
+        if (settings.png) {
+            QImage image(settings.size, QImage::Format_ARGB32_Premultiplied);
+            QPainter painter(&image);
+            paint(painter, rect, kind, data);
+            painter.end();
+            if (!image.save(base + ".png", "PNG")) {
+                if (error) *error = "Cannot write " + base + ".png";
+                return false;
+            }
+        }
+        if (settings.svg) {
+            QSvgGenerator generator;
+            generator.setFileName(base + ".svg");
+            generator.setSize(settings.size);
+            generator.setViewBox(rect);
+            generator.setTitle(data.title);
+            QPainter painter;
+            if (!painter.begin(&generator)) {
+                if (error) *error = "Cannot write " + base + ".svg";
+                return false;
+            }
+            paint(painter, rect, kind, data);
+            painter.end();
+        }
+    }
+    return true;
+}
+
+std::size_t ChartRenderer::renderCaptures(const QStringList &files, const QString &outputDir,
+                                          const ChartRenderSettings &settings, const std::atomic<bool> &cancel,
+                                          const std::function<void(const QString &, const QString &)> &onRendered) {
+    // Output names from the capture names, numbered where two captures share one
+    QStringList bases;
+    QHash<QString, int> seen;
+    for (const QString &file : files) {
+        QString name = QFileInfo(file).completeBaseName();
+        int n = ++seen[name.toLower()];
+        bases << QDir(outputDir).filePath(n == 1 ? name : name + "-" + QString::number(n));
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    std::atomic<std::size_t> failed{ 0 };
+    const std::size_t count = std::size_t(files.size());
+    unsigned workers = xlat::workerCount(count, 1);
+    xlat::parallelChunks(workers, workers, [&](std::size_t, std::size_t, unsigned) {
+        for (std::size_t i = next++; i < count && !cancel.load(std::memory_order_relaxed); i = next++) {
+            QString error = renderCapture(files.at(int(i)), bases.at(int(i)), settings);
+            if (!error.isEmpty()) ++failed;
+            if (onRendered) onRendered(files.at(int(i)), error);
+        }
+    });
+    return failed;
+}
+
+QVector<QPointF> ChartRenderer::scatterPoints(const xlat::SampleStore &store, std::size_t maxPoints) {
+    // Past one chunk per run the resident segment aggregates are enough and
+    // nothing has to be paged in from the spill file
+    const std::size_t stride = std::max<std::size_t>(1, (store.size() * 2 + maxPoints - 1) / maxPoints);
+    QVector<QPointF> points;
+    if (stride == 1) {
+        points.reserve(int(store.size()));
+        store.forEach([&](std::size_t, const xlatData &data, std::int64_t) {
+            points.append(QPointF(data.reportNumber, data.latency));
+        });
+    } else if (stride >= xlat::SampleStore::kChunkSize) {
+        for (const xlat::SegmentSummary &segment : store.segments()) {
+            points.append(QPointF(segment.firstReport, segment.minLatency));
+            points.append(QPointF(segment.lastReport, segment.maxLatency));
+        }
+    } else {
+        xlatData low = {}, high = {};
+        store.forEach([&](std::size_t i, const xlatData &data, std::int64_t) {
+            if (i % stride == 0 || data.latency < low.latency) low = data;
+            if (i % stride == 0 || data.latency > high.latency) high = data;
+            if (i % stride == stride - 1 || i + 1 == store.size()) {
+                points.append(QPointF(low.reportNumber, low.latency));
+                points.append(QPointF(high.reportNumber, high.latency));
+            }
+        });
+    }
+    return points;
+}
@@ -0,0 +1,85 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef CHARTRENDERER_H
+#define CHARTRENDERER_H
+
+#include "xlat_histogram.h"
+#include "xlat_outliers.h"
+#include "xlat_samplestore.h"
+#include "xlat_timeline.h"
+#include <QPainter>
+#include <QPointF>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// One session as the charts see it, everything borrowed
+struct ChartData {
+    QString title;
+    const xlat::SampleStore *store = nullptr;
+    const xlat::LatencyHistogram *histogram = nullptr;
+    const std::vector<xlat::OutlierRecord> *outliers = nullptr;
+    const xlat::SegmentTimeline *timeline = nullptr;
+};
+
+enum ChartKind {
+    ScatterChart = 0x1,
+    DistributionChart = 0x2,
+    TimelineChart = 0x4,
+    AllCharts = 0x7
+};
+
+struct ChartRenderSettings {
+    QSize size = QSize(1600, 900);
+    int charts = AllCharts;
+    bool png = true;
+    bool svg = false;
+};
+
+// The scatter, distribution and timeline charts drawn with QPainter alone.
+// Unlike QtCharts this works on any thread and needs no window, so reports for
+// a folder of captures render in parallel, from the GUI or the command line.
+class ChartRenderer
+{
+public:
+    static void paint(QPainter &painter, const QRect &rect, ChartKind kind, const ChartData &data);
+
+    // Writes <basePath>-scatter.png, -distribution.svg, ... as selected. Stops at
+    // the first file that can't be written.
+    static bool render(const ChartData &data, const QString &basePath, const ChartRenderSettings &settings,
+                       QString *error = nullptr);
+
+    // Loads each capture and renders its charts into outputDir, captures spread
+    // over worker threads. onRendered(file, error) runs on the workers, error is
+    // empty on success. Returns how many captures failed.
+    static std::size_t renderCaptures(const QStringList &files, const QString &outputDir,
+                                      const ChartRenderSettings &settings, const std::atomic<bool> &cancel,
+                                      const std::function<void(const QString &, const QString &)> &onRendered);
+
+    // Long captures are reduced to the min and max of each run of reports, so
+    // spikes survive; shared with the interactive scatter chart
+    static QVector<QPointF> scatterPoints(const xlat::SampleStore &store, std::size_t maxPoints = 200000);
+};
+
+#endif // CHARTRENDERER_H
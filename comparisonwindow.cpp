@@ -0,0 +1,428 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "comparisonwindow.h"
+#include "distributionwindow.h"
+#include "xlat_parallel.h"
+#include "xlat_session.h"
+#include <QApplication>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSplitter>
+#include <QVBoxLayout>
+#include <QtCharts/QChart>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+const int kHistogramBins = 64;
+const int kCdfPoints = 512;   // chart cost stays flat no matter how big the sessions are
+const double kSignificance = 0.05;
+
+const QColor kSessionColors[] = {
+    QColor(50, 204, 153), QColor(255, 128, 0), QColor(60, 120, 255),
+    QColor(212, 0, 0), QColor(170, 85, 255), QColor(128, 128, 128)
+};
+
+QColor sessionColor(std::size_t index) {
+    return kSessionColors[index % (sizeof(kSessionColors) / sizeof(kSessionColors[0]))];
+}
+
+QString withDelta(double value, double baseline, bool isBaseline, int decimals = 0) {
+    QString text = QString::number(value, 'f', decimals);
+    if (isBaseline) {
+        return text;
+    }
+    double delta = value - baseline;
+    QString sign = delta > 0 ? "+" : "";
+    QString relative;
+    if (baseline != 0.0) {
+        relative = ", " + sign + QString::number(100.0 * delta / baseline, 'f', 1) + "%";
+    }
+    return text + "  (" + sign + QString::number(delta, 'f', decimals) + relative + ")";
+}
+
+QString formatPValue(double p) {
+    return p < 1e-4 ? QString::number(p, 'e', 2) : QString::number(p, 'f', 4);
+}
+
+} // namespace
+
+ComparisonWindow::ComparisonWindow(QWidget *parent)
+    : QMainWindow(parent)
+{
+    setWindowTitle("Session Comparison");
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    QWidget *central = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(central);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    m_addButton = new QPushButton("Add sessions...");
+    QPushButton *clearButton = new QPushButton("Clear");
+    buttons->addWidget(m_addButton);
+    buttons->addWidget(clearButton);
+    buttons->addStretch();
+    layout->addLayout(buttons);
+
+    connect(m_addButton, &QPushButton::clicked, this, &ComparisonWindow::addSessionFiles);
+    connect(clearButton, &QPushButton::clicked, this, &ComparisonWindow::clearSessions);
+
+    m_metricTable = new QTableWidget();
+    m_metricTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_metricTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    m_testTable = new QTableWidget();
+    m_testTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_testTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    m_histogramView = new QtCharts::QChartView();
+    m_histogramView->setRenderHint(QPainter::Antialiasing);
+    m_cdfView = new QtCharts::QChartView();
+    m_cdfView->setRenderHint(QPainter::Antialiasing);
+    m_spectrumView = new QtCharts::QChartView();
+    m_spectrumView->setRenderHint(QPainter::Antialiasing);
+
+    QSplitter *tables = new QSplitter(Qt::Vertical);
+    tables->addWidget(m_metricTable);
+    tables->addWidget(m_testTable);
+
+    QSplitter *charts = new QSplitter(Qt::Vertical);
+    charts->addWidget(m_histogramView);
+    charts->addWidget(m_cdfView);
+    charts->addWidget(m_spectrumView);
+
+    QSplitter *main = new QSplitter(Qt::Horizontal);
+    main->addWidget(tables);
+    main->addWidget(charts);
+    main->setStretchFactor(1, 1);
+    layout->addWidget(main);
+
+    setCentralWidget(central);
+    resize(1600, 900);
+
+    refresh();
+}
+
+ComparisonWindow::~ComparisonWindow() {
+    if (m_loader.joinable()) {
+        m_cancel = true;
+        m_loader.join();
+        QApplication::restoreOverrideCursor();
+    }
+}
+
+void ComparisonWindow::addSession(const QString &name, const std::vector<xlatData> &samples) {
+    if (samples.empty()) {
+        return;
+    }
+    addSession(name, xlat::LatencyHistogram::fromSamples(samples));
+}
+
+void ComparisonWindow::addSession(const QString &name, const xlat::LatencyHistogram &histogram) {
+    if (histogram.isEmpty()) {
+        return;
+    }
+    Session session;
+    session.name = name;
+    session.histogram = histogram;
+    session.summary = xlat::summarize(session.histogram);
+    m_sessions.push_back(std::move(session));
+    refresh();
+}
+
+void ComparisonWindow::addSessionFiles() {
+    QStringList files = QFileDialog::getOpenFileNames(this, tr("Open Captures"), "",
+                                                      tr("Captures (*.csv *.xlatc);;CSV Files (*.csv);;Compressed Captures (*.xlatc)"));
+    if (files.isEmpty() || m_loader.joinable()) {
+        return;
+    }
+
+    m_addButton->setEnabled(false);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    // Parsing dominates: one file per worker at a time, so no more captures are
+    // in memory than there are cores
+    m_loader = std::thread([this, files]() {
+        auto loaded = std::make_shared<std::vector<Session>>(std::size_t(files.size()));
+        std::vector<QString> errors(std::size_t(files.size()));
+        std::atomic<std::size_t> next{ 0 };
+        const std::size_t count = loaded->size();
+        unsigned workers = xlat::workerCount(count, 1);
+        xlat::parallelChunks(workers, workers, [&](std::size_t, std::size_t, unsigned) {
+            for (std::size_t i = next++; i < count && !m_cancel.load(std::memory_order_relaxed); i = next++) {
+                xlat::CaptureCsv capture;
+                std::string error;
+                bool read = xlat::readCapture(QFile::encodeName(files.at(int(i))).toStdString(), capture, &error);
+                if (capture.samples.empty()) {
+                    errors[i] = !read || capture.errors.empty()
+                        ? QString::fromStdString(error)
+                        : "line " + QString::number(capture.errors.front().line) + ": " + QString::fromStdString(capture.errors.front().message);
+                    continue;
+                }
+                Session &session = (*loaded)[i];
+                session.name = QFileInfo(files.at(int(i))).completeBaseName();
+                for (const auto &d : capture.samples) {
+                    session.histogram.add(d.latency);
+                }
+                session.summary = xlat::summarize(session.histogram);
+            }
+        });
+
+        QStringList failures;
+        for (std::size_t i = 0; i < count; ++i) {
+            if ((*loaded)[i].histogram.isEmpty()) {
+                failures << QFileInfo(files.at(int(i))).fileName() + ": " + (errors[i].isEmpty() ? "no samples" : errors[i]);
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, loaded, failures]() { sessionsLoaded(*loaded, failures); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void ComparisonWindow::sessionsLoaded(std::vector<Session> &loaded, const QStringList &failures) {
+    m_loader.join();
+    for (Session &session : loaded) {
+        if (!session.histogram.isEmpty()) {
+            m_sessions.push_back(std::move(session));
+        }
+    }
+
+    refresh();
+    QApplication::restoreOverrideCursor();
+    m_addButton->setEnabled(true);
+
+    if (!failures.isEmpty()) {
+        QMessageBox::warning(this, "Import Error", failures.join("\n"));
+    }
+}
+
+void ComparisonWindow::clearSessions() {
+    m_sessions.clear();
+    refresh();
+}
+
+void ComparisonWindow::refresh() {
+    fillMetricTable();
+    fillTestTable();
+    fillCharts();
+}
+
+void ComparisonWindow::fillMetricTable() {
+    struct Row {
+        const char *label;
+        double (*value)(const xlat::LatencySummary &);
+        int decimals;
+    };
+    static const Row rows[] = {
+        { "Samples",         [](const xlat::LatencySummary &s) { return double(s.count); }, 0 },
+        { "Minimum Latency", [](const xlat::LatencySummary &s) { return double(s.minLatency); }, 0 },
+        { "Maximum Latency", [](const xlat::LatencySummary &s) { return double(s.maxLatency); }, 0 },
+        { "Average Latency", [](const xlat::LatencySummary &s) { return s.avgLatency; }, 2 },
+        { "Median Latency",  [](const xlat::LatencySummary &s) { return double(s.medianLatency); }, 0 },
+        { "p5",              [](const xlat::LatencySummary &s) { return double(s.p5); }, 0 },
+        { "p10",             [](const xlat::LatencySummary &s) { return double(s.p10); }, 0 },
+        { "p90",             [](const xlat::LatencySummary &s) { return double(s.p90); }, 0 },
+        { "p95",             [](const xlat::LatencySummary &s) { return double(s.p95); }, 0 },
+        { "p99",             [](const xlat::LatencySummary &s) { return double(s.p99); }, 0 },
+        { "IQR",             [](const xlat::LatencySummary &s) { return double(s.iqr); }, 0 },
+        { "MAD",             [](const xlat::LatencySummary &s) { return s.mad; }, 2 },
+        { "STDEV",           [](const xlat::LatencySummary &s) { return s.stdev; }, 2 },
+    };
+    const int rowCount = sizeof(rows) / sizeof(rows[0]);
+
+    m_metricTable->clear();
+    m_metricTable->setRowCount(rowCount);
+    m_metricTable->setColumnCount(int(m_sessions.size()));
+
+    QStringList headers;
+    for (std::size_t i = 0; i < m_sessions.size(); ++i) {
+        headers << (i == 0 ? m_sessions[i].name + " (baseline)" : m_sessions[i].name);
+    }
+    m_metricTable->setHorizontalHeaderLabels(headers);
+
+    QStringList labels;
+    for (int r = 0; r < rowCount; ++r) {
+        labels << rows[r].label;
+        for (std::size_t c = 0; c < m_sessions.size(); ++c) {
+            double value = rows[r].value(m_sessions[c].summary);
+            double baseline = rows[r].value(m_sessions[0].summary);
+            m_metricTable->setItem(r, int(c), new QTableWidgetItem(withDelta(value, baseline, c == 0, rows[r].decimals)));
+        }
+    }
+    m_metricTable->setVerticalHeaderLabels(labels);
+}
+
+void ComparisonWindow::fillTestTable() {
+    m_testTable->clear();
+    m_testTable->setColumnCount(6);
+    m_testTable->setHorizontalHeaderLabels({ "KS D", "KS p-value", "Mann-Whitney U", "MW p-value",
+                                             "P(slower than baseline)", "Verdict" });
+    m_testTable->setRowCount(m_sessions.size() > 1 ? int(m_sessions.size()) - 1 : 0);
+
+    if (m_sessions.size() < 2) {
+        return;
+    }
+
+    // Each pairing is independent, run them side by side, at most one per core
+    std::vector<xlat::TestResult> ks(m_sessions.size());
+    std::vector<xlat::TestResult> mw(m_sessions.size());
+    std::atomic<std::size_t> next{ 1 };
+    unsigned workers = xlat::workerCount(m_sessions.size() - 1, 1);
+    xlat::parallelChunks(workers, workers, [&](std::size_t, std::size_t, unsigned) {
+        for (std::size_t i = next++; i < m_sessions.size(); i = next++) {
+            ks[i] = xlat::kolmogorovSmirnov(m_sessions[0].histogram, m_sessions[i].histogram);
+            mw[i] = xlat::mannWhitneyU(m_sessions[0].histogram, m_sessions[i].histogram);
+        }
+    });
+
+    QStringList labels;
+    for (std::size_t i = 1; i < m_sessions.size(); ++i) {
+        int row = int(i) - 1;
+        labels << m_sessions[i].name;
+
+        bool different = ks[i].pValue < kSignificance || mw[i].pValue < kSignificance;
+        m_testTable->setItem(row, 0, new QTableWidgetItem(QString::number(ks[i].statistic, 'f', 4)));
+        m_testTable->setItem(row, 1, new QTableWidgetItem(formatPValue(ks[i].pValue)));
+        m_testTable->setItem(row, 2, new QTableWidgetItem(QString::number(mw[i].statistic, 'f', 1)));
+        m_testTable->setItem(row, 3, new QTableWidgetItem(formatPValue(mw[i].pValue)));
+        m_testTable->setItem(row, 4, new QTableWidgetItem(QString::number(mw[i].effect, 'f', 3)));
+        m_testTable->setItem(row, 5, new QTableWidgetItem(different ? "Significant difference"
+                                                                    : "No significant difference"));
+    }
+    m_testTable->setVerticalHeaderLabels(labels);
+}
+
+void ComparisonWindow::fillCharts() {
+    QtCharts::QChart *histogramChart = new QtCharts::QChart();
+    histogramChart->setTitle("Latency distribution (fraction of samples)");
+    QtCharts::QChart *cdfChart = new QtCharts::QChart();
+    cdfChart->setTitle("Cumulative distribution");
+    QtCharts::QChart *spectrumChart = new QtCharts::QChart();
+    spectrumChart->setTitle("Percentile spectrum (tail)");
+
+    if (!m_sessions.empty()) {
+        int lo = m_sessions[0].summary.minLatency;
+        int hi = m_sessions[0].summary.maxLatency;
+        for (const auto &s : m_sessions) {
+            lo = std::min(lo, s.summary.minLatency);
+            hi = std::max(hi, s.summary.maxLatency);
+        }
+        double width = std::max(1.0, double(hi - lo + 1) / kHistogramBins);
+        double yMax = 0.0;
+
+        QtCharts::QValueAxis *hx = new QtCharts::QValueAxis();
+        QtCharts::QValueAxis *hy = new QtCharts::QValueAxis();
+        QtCharts::QValueAxis *cx = new QtCharts::QValueAxis();
+        QtCharts::QValueAxis *cy = new QtCharts::QValueAxis();
+        histogramChart->addAxis(hx, Qt::AlignBottom);
+        histogramChart->addAxis(hy, Qt::AlignLeft);
+        cdfChart->addAxis(cx, Qt::AlignBottom);
+        cdfChart->addAxis(cy, Qt::AlignLeft);
+        QtCharts::QCategoryAxis *sx = DistributionWindow::createSpectrumAxis();
+        QtCharts::QValueAxis *sy = new QtCharts::QValueAxis();
+        spectrumChart->addAxis(sx, Qt::AlignBottom);
+        spectrumChart->addAxis(sy, Qt::AlignLeft);
+        int medianLow = m_sessions[0].summary.medianLatency;
+
+        for (std::size_t i = 0; i < m_sessions.size(); ++i) {
+            const Session &s = m_sessions[i];
+            double total = double(s.histogram.count());
+
+            // Shared bin edges so the outlines overlay exactly
+            std::vector<double> bins(kHistogramBins, 0.0);
+            s.histogram.forEachBin([&](int latency, std::uint64_t count) {
+                int b = std::min(kHistogramBins - 1, int((latency - lo) / width));
+                bins[b] += double(count) / total;
+            });
+
+            QtCharts::QLineSeries *outline = new QtCharts::QLineSeries();
+            outline->setName(s.name);
+            outline->setColor(sessionColor(i));
+            for (int b = 0; b < kHistogramBins; ++b) {
+                outline->append(lo + b * width, bins[b]);
+                outline->append(lo + (b + 1) * width, bins[b]);
+                yMax = std::max(yMax, bins[b]);
+            }
+            histogramChart->addSeries(outline);
+            outline->attachAxis(hx);
+            outline->attachAxis(hy);
+
+            // CDF sampled on a fixed grid, independent of the sample count
+            QtCharts::QLineSeries *cdf = new QtCharts::QLineSeries();
+            cdf->setName(s.name);
+            cdf->setColor(sessionColor(i));
+            double step = double(hi - lo) / (kCdfPoints - 1);
+            int point = 0;
+            double cumulative = 0.0;
+            s.histogram.forEachBin([&](int latency, std::uint64_t count) {
+                while (point < kCdfPoints && lo + point * step < latency) {
+                    cdf->append(lo + point * step, cumulative / total);
+                    ++point;
+                }
+                cumulative += double(count);
+            });
+            while (point < kCdfPoints) {
+                cdf->append(lo + point * step, cumulative / total);
+                ++point;
+            }
+            cdfChart->addSeries(cdf);
+            cdf->attachAxis(cx);
+            cdf->attachAxis(cy);
+
+            // Tails side by side, p50 to p99.99
+            QtCharts::QLineSeries *spectrum = new QtCharts::QLineSeries();
+            spectrum->setName(s.name);
+            spectrum->setColor(sessionColor(i));
+            DistributionWindow::fillSpectrum(spectrum, s.histogram);
+            spectrumChart->addSeries(spectrum);
+            spectrum->attachAxis(sx);
+            spectrum->attachAxis(sy);
+            medianLow = std::min(medianLow, s.summary.medianLatency);
+        }
+
+        hx->setRange(lo, lo + kHistogramBins * width);
+        hy->setRange(0, yMax * 1.1);
+        cx->setRange(lo, hi);
+        cy->setRange(0, 1);
+        sy->setRange(medianLow * 0.9, hi * 1.05);
+    }
+
+    histogramChart->legend()->setAlignment(Qt::AlignBottom);
+    cdfChart->legend()->setAlignment(Qt::AlignBottom);
+    spectrumChart->legend()->setAlignment(Qt::AlignBottom);
+
+    // setChart() leaves the old chart to us
+    QtCharts::QChart *oldHistogram = m_histogramView->chart();
+    QtCharts::QChart *oldCdf = m_cdfView->chart();
+    QtCharts::QChart *oldSpectrum = m_spectrumView->chart();
+    m_histogramView->setChart(histogramChart);
+    m_cdfView->setChart(cdfChart);
+    m_spectrumView->setChart(spectrumChart);
+    delete oldHistogram;
+    delete oldCdf;
+    delete oldSpectrum;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef COMPARISONWINDOW_H
+#define COMPARISONWINDOW_H
+
+#include "xlat_data.h"
+#include "xlat_stats.h"
+#include <QMainWindow>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QtCharts/QChartView>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// A/B view: loads two or more captures, shows every metric with its delta to the
+// first (baseline) session, KS and Mann-Whitney tests against the baseline and
+// overlaid distribution / CDF / percentile spectrum charts. Sessions are reduced to latency histograms
+// on load, so the raw samples are never kept around.
+class ComparisonWindow : public QMainWindow
+{
+    Q_OBJECT
+public:
+    explicit ComparisonWindow(QWidget *parent = nullptr);
+    ~ComparisonWindow() override;
+
+    void addSession(const QString &name, const std::vector<xlatData> &samples);
+    void addSession(const QString &name, const xlat::LatencyHistogram &histogram);
+
+private slots:
+    void addSessionFiles();
+    void clearSessions();
+
+private:
+    struct Session {
+        QString name;
+        xlat::LatencyHistogram histogram;
+        xlat::LatencySummary summary;
+    };
+
+    void sessionsLoaded(std::vector<Session> &loaded, const QStringList &failures);
+    void refresh();
+    void fillMetricTable();
+    void fillTestTable();
+    void fillCharts();
+
+    std::vector<Session> m_sessions;
+
+    // Files are parsed on m_loader, one per core at a time
+    std::thread m_loader;
+    std::atomic<bool> m_cancel{ false };
+
+    QPushButton *m_addButton;
+    QTableWidget *m_metricTable;
+    QTableWidget *m_testTable;
+    QtCharts::QChartView *m_histogramView;
+    QtCharts::QChartView *m_cdfView;
+    QtCharts::QChartView *m_spectrumView;
+};
+
+#endif // COMPARISONWINDOW_H
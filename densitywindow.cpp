@@ -0,0 +1,253 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "densitywindow.h"
+#include "xlat_density.h"
+#include "xlat_samplestore.h"
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStatusBar>
+#include <QTimer>
+#include <QToolBar>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+
+const int kCellSize = 2; // screen pixels per grid cell
+const int kLeftMargin = 64;
+const int kBottomMargin = 40;
+const int kTopMargin = 12;
+const int kRightMargin = 16;
+
+// Dark blue through yellow to dark red
+QRgb colourAt(double t) {
+    static const QColor stops[] = { QColor(49, 54, 149), QColor(69, 117, 180), QColor(254, 224, 144),
+                                    QColor(244, 109, 67), QColor(165, 0, 38) };
+    const int last = int(sizeof(stops) / sizeof(stops[0])) - 1;
+    double pos = std::min(std::max(t, 0.0), 1.0) * last;
+    int i = std::min(int(pos), last - 1);
+    double f = pos - i;
+    return qRgb(int(stops[i].red() + f * (stops[i + 1].red() - stops[i].red())),
+                int(stops[i].green() + f * (stops[i + 1].green() - stops[i].green())),
+                int(stops[i].blue() + f * (stops[i + 1].blue() - stops[i].blue())));
+}
+
+} // namespace
+
+class DensityPlot : public QWidget
+{
+public:
+    DensityPlot(const xlat::SampleStore &store, QWidget *parent)
+        : QWidget(parent)
+        , m_store(store)
+    {
+        setMinimumSize(400, 300);
+        for (int i = 0; i < 256; ++i) m_palette[i] = colourAt(i / 255.0);
+
+        // Resizes and wheel steps come in bursts, bin once they settle
+        m_rebinTimer.setSingleShot(true);
+        m_rebinTimer.setInterval(40);
+        connect(&m_rebinTimer, &QTimer::timeout, this, [this]() { rebin(); });
+        resetView();
+    }
+
+    std::function<void(const QString &)> onStatus;
+
+    void setAxis(xlat::DensityAxis axis) {
+        m_axis = axis;
+        resetView();
+    }
+
+    void resetView() {
+        m_view = xlat::fullDensityView(m_store, m_axis);
+        m_rebinTimer.start();
+    }
+
+protected:
+    void resizeEvent(QResizeEvent *) override { m_rebinTimer.start(); }
+
+    void paintEvent(QPaintEvent *) override {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::white);
+        QRect plot = plotRect();
+        if (!m_image.isNull()) {
+            painter.drawImage(plot, m_image);
+        }
+        painter.setPen(Qt::black);
+        painter.drawRect(plot.adjusted(0, 0, -1, -1));
+
+        // Five ticks per axis
+        const xlat::DensityView &v = m_grid.view;
+        QFontMetrics metrics(font());
+        for (int i = 0; i <= 4; ++i) {
+            int x = plot.left() + i * (plot.width() - 1) / 4;
+            QString label = QString::number(v.xMin + i * (v.xMax - v.xMin) / 4, 'f', m_axis == xlat::DensityAxis::HostTime ? 1 : 0);
+            painter.drawLine(x, plot.bottom(), x, plot.bottom() + 4);
+            painter.drawText(x - metrics.horizontalAdvance(label) / 2, plot.bottom() + 6 + metrics.ascent(), label);
+
+            int y = plot.bottom() - i * (plot.height() - 1) / 4;
+            label = QString::number(v.yMin + i * (v.yMax - v.yMin) / 4, 'f', 0);
+            painter.drawLine(plot.left() - 4, y, plot.left(), y);
+            painter.drawText(plot.left() - 8 - metrics.horizontalAdvance(label), y + metrics.ascent() / 2, label);
+        }
+        QString xTitle = m_axis == xlat::DensityAxis::HostTime ? "Host time (s)" : "Report number";
+        painter.drawText(plot.center().x() - metrics.horizontalAdvance(xTitle) / 2, height() - 4, xTitle);
+        painter.save();
+        painter.translate(12, plot.center().y());
+        painter.rotate(-90);
+        painter.drawText(-metrics.horizontalAdvance("Latency (us)") / 2, 0, "Latency (us)");
+        painter.restore();
+
+        if (!m_band.isNull()) {
+            painter.setPen(QPen(Qt::black, 1, Qt::DashLine));
+            painter.drawRect(m_band.normalized());
+        }
+    }
+
+    void mousePressEvent(QMouseEvent *event) override {
+        if (event->button() == Qt::LeftButton) {
+            m_band = QRect(event->pos(), QSize());
+        }
+    }
+
+    void mouseMoveEvent(QMouseEvent *event) override {
+        if (event->buttons() & Qt::LeftButton) {
+            m_band.setBottomRight(event->pos());
+            update();
+        }
+    }
+
+    void mouseReleaseEvent(QMouseEvent *event) override {
+        if (event->button() != Qt::LeftButton) return;
+        QRect band = m_band.normalized().intersected(plotRect());
+        m_band = QRect();
+        if (band.width() > 4 && band.height() > 4) {
+            xlat::DensityView view;
+            view.xMin = xAt(band.left());
+            view.xMax = xAt(band.right());
+            view.yMin = yAt(band.bottom());
+            view.yMax = yAt(band.top());
+            m_view = view;
+            m_rebinTimer.start();
+        }
+        update();
+    }
+
+    void mouseDoubleClickEvent(QMouseEvent *) override { resetView(); }
+
+    // Zooms around the cursor, Shift for the latency axis only, Ctrl for x only
+    void wheelEvent(QWheelEvent *event) override {
+        double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+        QPoint pos = event->pos();
+        double cx = xAt(pos.x());
+        double cy = yAt(pos.y());
+        if (!(event->modifiers() & Qt::ShiftModifier)) {
+            m_view.xMin = cx - (cx - m_view.xMin) * factor;
+            m_view.xMax = cx + (m_view.xMax - cx) * factor;
+        }
+        if (!(event->modifiers() & Qt::ControlModifier)) {
+            m_view.yMin = cy - (cy - m_view.yMin) * factor;
+            m_view.yMax = cy + (m_view.yMax - cy) * factor;
+        }
+        m_rebinTimer.start();
+    }
+
+private:
+    QRect plotRect() const {
+        return rect().adjusted(kLeftMargin, kTopMargin, -kRightMargin, -kBottomMargin);
+    }
+
+    // Data coordinates of a widget position, against the grid on screen
+    double xAt(int x) const {
+        QRect plot = plotRect();
+        const xlat::DensityView &v = m_grid.view;
+        return v.xMin + double(x - plot.left()) / plot.width() * (v.xMax - v.xMin);
+    }
+
+    double yAt(int y) const {
+        QRect plot = plotRect();
+        const xlat::DensityView &v = m_grid.view;
+        return v.yMin + double(plot.bottom() - y) / plot.height() * (v.yMax - v.yMin);
+    }
+
+    void rebin() {
+        QRect plot = plotRect();
+        QElapsedTimer timer;
+        timer.start();
+        m_grid = xlat::binDensity(m_store, m_axis, m_view, std::max(1, plot.width() / kCellSize),
+                                  std::max(1, plot.height() / kCellSize));
+
+        // log(1 + n) so single stray samples stay visible next to the dense core
+        m_image = QImage(m_grid.columns, m_grid.rows, QImage::Format_RGB32);
+        const double scale = m_grid.maxCount ? 255.0 / std::log1p(double(m_grid.maxCount)) : 0.0;
+        for (int row = 0; row < m_grid.rows; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(m_grid.rows - 1 - row));
+            for (int column = 0; column < m_grid.columns; ++column) {
+                std::uint32_t n = m_grid.at(column, row);
+                line[column] = n ? m_palette[std::min(255, int(std::log1p(double(n)) * scale))] : qRgb(255, 255, 255);
+            }
+        }
+
+        if (onStatus) {
+            onStatus(QString::number(m_grid.samples) + " samples in view, up to " + QString::number(m_grid.maxCount)
+                     + " per cell, binned in " + QString::number(timer.elapsed()) + " ms");
+        }
+        update();
+    }
+
+    const xlat::SampleStore &m_store;
+    xlat::DensityAxis m_axis = xlat::DensityAxis::ReportNumber;
+    xlat::DensityView m_view;
+    xlat::DensityGrid m_grid;
+    QImage m_image;
+    QRgb m_palette[256];
+    QTimer m_rebinTimer;
+    QRect m_band;
+};
+
+DensityWindow::DensityWindow(const xlat::SampleStore &store, QWidget *parent)
+    : QMainWindow(parent)
+{
+    setWindowTitle("Latency Density");
+    resize(1600, 900);
+
+    m_plot = new DensityPlot(store, this);
+    setCentralWidget(m_plot);
+
+    QToolBar *toolbar = addToolBar("Density");
+    toolbar->setMovable(false);
+    m_axis = new QComboBox();
+    m_axis->addItem("Report number");
+    if (store.hasHostTimes()) {
+        m_axis->addItem("Host time");
+    }
+    toolbar->addWidget(m_axis);
+    toolbar->addAction("Reset Zoom", [this]() { m_plot->resetView(); });
+
+    m_status = new QLabel();
+    statusBar()->addWidget(m_status);
+    m_plot->onStatus = [this](const QString &text) { m_status->setText(text); };
+
+    connect(m_axis, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        m_plot->setAxis(index == 1 ? xlat::DensityAxis::HostTime : xlat::DensityAxis::ReportNumber);
+    });
+}
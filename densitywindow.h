@@ -0,0 +1,49 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef DENSITYWINDOW_H
+#define DENSITYWINDOW_H
+
+#include <QComboBox>
+#include <QLabel>
+#include <QMainWindow>
+
+namespace xlat {
+class SampleStore;
+}
+
+class DensityPlot;
+
+// Latency density over report number or host time, for captures too large for
+// a scatter plot. Rendered as an image with a log colour scale; drag a
+// rectangle or use the wheel to zoom, double-click to reset. Only the visible
+// region is re-binned.
+class DensityWindow : public QMainWindow
+{
+    Q_OBJECT
+public:
+    // The store must outlive the window, parent it to the store's owner
+    DensityWindow(const xlat::SampleStore &store, QWidget *parent = nullptr);
+
+private:
+    DensityPlot *m_plot;
+    QComboBox *m_axis;
+    QLabel *m_status;
+};
+
+#endif // DENSITYWINDOW_H
@@ -0,0 +1,138 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "distributionwindow.h"
+#include "xlat_stats.h"
+#include <QSplitter>
+#include <QStatusBar>
+#include <QtCharts/QValueAxis>
+#include <algorithm>
+
+namespace {
+
+// Labelled percentiles, up to the p99.99 the spectrum reaches by default
+const double kSpectrumLabels[] = { 0.5, 0.9, 0.99, 0.999, 0.9999 };
+const char *const kSpectrumNames[] = { "p50", "p90", "p99", "p99.9", "p99.99" };
+
+} // namespace
+
+DistributionWindow::DistributionWindow(const xlat::LatencyHistogram &histogram, QWidget *parent)
+    : QMainWindow(parent)
+    , m_histogram(histogram)
+{
+    setWindowTitle("Latency Distribution");
+    resize(1600, 900);
+
+    m_cdfView = new QtCharts::QChartView();
+    m_cdfView->setRenderHint(QPainter::Antialiasing);
+    m_spectrumView = new QtCharts::QChartView();
+    m_spectrumView->setRenderHint(QPainter::Antialiasing);
+
+    QSplitter *charts = new QSplitter(Qt::Horizontal);
+    charts->addWidget(m_cdfView);
+    charts->addWidget(m_spectrumView);
+    setCentralWidget(charts);
+
+    m_status = new QLabel();
+    statusBar()->addWidget(m_status);
+
+    // Follows a running capture, redrawn only when samples arrived
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this]() {
+        if (m_histogram.count() != m_shownCount) refresh();
+    });
+    m_refreshTimer->start();
+
+    refresh();
+}
+
+QtCharts::QCategoryAxis *DistributionWindow::createSpectrumAxis() {
+    QtCharts::QCategoryAxis *axis = new QtCharts::QCategoryAxis();
+    axis->setLabelsPosition(QtCharts::QCategoryAxis::AxisLabelsPositionOnValue);
+    for (std::size_t i = 0; i < sizeof(kSpectrumLabels) / sizeof(kSpectrumLabels[0]); ++i) {
+        axis->append(kSpectrumNames[i], xlat::spectrumPosition(kSpectrumLabels[i]));
+    }
+    axis->setRange(xlat::spectrumPosition(0.5), xlat::spectrumPosition(0.9999));
+    return axis;
+}
+
+void DistributionWindow::fillSpectrum(QtCharts::QLineSeries *series, const xlat::LatencyHistogram &histogram) {
+    QVector<QPointF> points;
+    for (const xlat::SpectrumPoint &p : xlat::percentileSpectrum(histogram)) {
+        points.append(QPointF(xlat::spectrumPosition(p.fraction), p.latency));
+    }
+    series->replace(points);
+}
+
+void DistributionWindow::refresh() {
+    m_shownCount = m_histogram.count();
+
+    QtCharts::QChart *cdfChart = new QtCharts::QChart();
+    cdfChart->setTitle("Empirical CDF");
+    cdfChart->legend()->hide();
+    QtCharts::QChart *spectrumChart = new QtCharts::QChart();
+    spectrumChart->setTitle("Percentile spectrum");
+    spectrumChart->legend()->hide();
+
+    if (!m_histogram.isEmpty()) {
+        QtCharts::QLineSeries *cdf = new QtCharts::QLineSeries();
+        QVector<QPointF> points;
+        for (const xlat::CdfPoint &p : xlat::ecdfPoints(m_histogram)) {
+            points.append(QPointF(p.latency, p.fraction));
+        }
+        cdf->replace(points);
+        cdfChart->addSeries(cdf);
+        QtCharts::QValueAxis *cx = new QtCharts::QValueAxis();
+        QtCharts::QValueAxis *cy = new QtCharts::QValueAxis();
+        cx->setTitleText("Latency (us)");
+        cx->setRange(m_histogram.minValue(), std::max(m_histogram.maxValue(), m_histogram.minValue() + 1));
+        cy->setRange(0, 1);
+        cdfChart->addAxis(cx, Qt::AlignBottom);
+        cdfChart->addAxis(cy, Qt::AlignLeft);
+        cdf->attachAxis(cx);
+        cdf->attachAxis(cy);
+
+        QtCharts::QLineSeries *spectrum = new QtCharts::QLineSeries();
+        fillSpectrum(spectrum, m_histogram);
+        spectrumChart->addSeries(spectrum);
+        QtCharts::QCategoryAxis *sx = createSpectrumAxis();
+        QtCharts::QValueAxis *sy = new QtCharts::QValueAxis();
+        sy->setTitleText("Latency (us)");
+        sy->setRange(m_histogram.median() * 0.9, m_histogram.maxValue() * 1.05);
+        spectrumChart->addAxis(sx, Qt::AlignBottom);
+        spectrumChart->addAxis(sy, Qt::AlignLeft);
+        spectrum->attachAxis(sx);
+        spectrum->attachAxis(sy);
+    }
+
+    // setChart() leaves the old chart to us
+    QtCharts::QChart *oldCdf = m_cdfView->chart();
+    QtCharts::QChart *oldSpectrum = m_spectrumView->chart();
+    m_cdfView->setChart(cdfChart);
+    m_spectrumView->setChart(spectrumChart);
+    delete oldCdf;
+    delete oldSpectrum;
+
+    // Past 1 - 1/n the percentiles are all the max, the spectrum stops there
+    QString text = QString::number(m_shownCount) + " samples";
+    if (m_shownCount > 0 && m_shownCount < 10000) {
+        text += ", the spectrum reaches p99.99 from 10000 samples";
+    }
+    m_status->setText(text);
+}
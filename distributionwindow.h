@@ -0,0 +1,56 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef DISTRIBUTIONWINDOW_H
+#define DISTRIBUTIONWINDOW_H
+
+#include "xlat_histogram.h"
+#include <QLabel>
+#include <QMainWindow>
+#include <QTimer>
+#include <QtCharts/QCategoryAxis>
+#include <QtCharts/QChartView>
+#include <QtCharts/QLineSeries>
+
+// Empirical CDF and percentile spectrum (p50 to p99.99, one axis unit per
+// "nine") of the live capture. Both are read off the histogram the metrics
+// already maintain, no samples are sorted, and the point count is fixed.
+class DistributionWindow : public QMainWindow
+{
+    Q_OBJECT
+public:
+    // The histogram must outlive the window, parent it to the histogram's owner
+    DistributionWindow(const xlat::LatencyHistogram &histogram, QWidget *parent = nullptr);
+
+    // Shared with the session comparison, which overlays several spectra
+    static QtCharts::QCategoryAxis *createSpectrumAxis();
+    static void fillSpectrum(QtCharts::QLineSeries *series, const xlat::LatencyHistogram &histogram);
+
+private:
+    void refresh();
+
+    const xlat::LatencyHistogram &m_histogram;
+    std::uint64_t m_shownCount = 0;
+
+    QtCharts::QChartView *m_cdfView;
+    QtCharts::QChartView *m_spectrumView;
+    QLabel *m_status;
+    QTimer *m_refreshTimer;
+};
+
+#endif // DISTRIBUTIONWINDOW_H
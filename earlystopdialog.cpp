@@ -0,0 +1,106 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "earlystopdialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QVBoxLayout>
+#include <algorithm>
+
+EarlyStopDialog::EarlyStopDialog(const xlat::EarlyStopSettings &settings, QWidget *parent)
+    : QDialog(parent)
+    , m_settings(settings)
+{
+    setWindowTitle("Early Stop");
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_enabled = new QCheckBox("Stop the capture adaptively");
+    m_enabled->setChecked(settings.enabled);
+    layout->addWidget(m_enabled);
+
+    QGroupBox *targetBox = new QGroupBox("Stop once every enabled target is met");
+    QFormLayout *targets = new QFormLayout(targetBox);
+
+    m_ciEnabled = new QCheckBox("p95 95% interval at most (us)");
+    m_ciEnabled->setChecked(settings.p95CiWidthUs > 0.0);
+    m_ciWidth = new QDoubleSpinBox();
+    m_ciWidth->setRange(0.1, 100000.0);
+    m_ciWidth->setValue(settings.p95CiWidthUs > 0.0 ? settings.p95CiWidthUs : 10.0);
+    targets->addRow(m_ciEnabled, m_ciWidth);
+
+    m_driftEnabled = new QCheckBox("Median change at most (%)");
+    m_driftEnabled->setChecked(settings.medianDriftPercent > 0.0);
+    m_drift = new QDoubleSpinBox();
+    m_drift->setRange(0.01, 100.0);
+    m_drift->setSingleStep(0.1);
+    m_drift->setValue(settings.medianDriftPercent > 0.0 ? settings.medianDriftPercent : 0.5);
+    targets->addRow(m_driftEnabled, m_drift);
+
+    m_window = new QSpinBox();
+    m_window->setRange(10, 10000000);
+    m_window->setValue(int(settings.window));
+    targets->addRow("...over the last (samples)", m_window);
+
+    m_minSamples = new QSpinBox();
+    m_minSamples->setRange(1, 10000000);
+    m_minSamples->setValue(int(settings.minSamples));
+    targets->addRow("Samples before a verdict", m_minSamples);
+
+    m_ciEnabled->setToolTip("Distribution-free interval of p95 from order statistics, it narrows as 1/sqrt(n)");
+    m_driftEnabled->setToolTip("Relative change of the median between now and the given number of samples ago");
+    layout->addWidget(targetBox);
+
+    QGroupBox *limitBox = new QGroupBox("Hard limits (0 = none)");
+    QFormLayout *limits = new QFormLayout(limitBox);
+
+    m_maxSamples = new QSpinBox();
+    m_maxSamples->setRange(0, 2000000000);
+    m_maxSamples->setValue(int(std::min<std::uint64_t>(settings.maxSamples, 2000000000)));
+    limits->addRow("Samples", m_maxSamples);
+
+    m_maxMinutes = new QDoubleSpinBox();
+    m_maxMinutes->setRange(0.0, 100000.0);
+    m_maxMinutes->setValue(settings.maxSeconds / 60.0);
+    limits->addRow("Minutes", m_maxMinutes);
+    layout->addWidget(limitBox);
+
+    m_stopCapture = new QCheckBox("Stop recording (otherwise only alert)");
+    m_stopCapture->setChecked(settings.stopCapture);
+    m_stopCapture->setToolTip("A stopped capture drops incoming reports until it is cleared or these settings are applied again");
+    layout->addWidget(m_stopCapture);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+}
+
+xlat::EarlyStopSettings EarlyStopDialog::settings() const {
+    xlat::EarlyStopSettings settings = m_settings;
+    settings.enabled = m_enabled->isChecked();
+    settings.p95CiWidthUs = m_ciEnabled->isChecked() ? m_ciWidth->value() : 0.0;
+    settings.medianDriftPercent = m_driftEnabled->isChecked() ? m_drift->value() : 0.0;
+    settings.window = std::uint64_t(m_window->value());
+    settings.minSamples = std::uint64_t(m_minSamples->value());
+    settings.maxSamples = std::uint64_t(m_maxSamples->value());
+    settings.maxSeconds = m_maxMinutes->value() * 60.0;
+    settings.stopCapture = m_stopCapture->isChecked();
+    return settings;
+}
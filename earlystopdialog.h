@@ -0,0 +1,52 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef EARLYSTOPDIALOG_H
+#define EARLYSTOPDIALOG_H
+
+#include "xlat_convergence.h"
+#include <QCheckBox>
+#include <QDialog>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+
+// Edits the adaptive capture targets and limits
+class EarlyStopDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    EarlyStopDialog(const xlat::EarlyStopSettings &settings, QWidget *parent = nullptr);
+
+    xlat::EarlyStopSettings settings() const;
+
+private:
+    xlat::EarlyStopSettings m_settings;
+
+    QCheckBox *m_enabled;
+    QCheckBox *m_ciEnabled;
+    QDoubleSpinBox *m_ciWidth;
+    QCheckBox *m_driftEnabled;
+    QDoubleSpinBox *m_drift;
+    QSpinBox *m_window;
+    QSpinBox *m_minSamples;
+    QSpinBox *m_maxSamples;
+    QDoubleSpinBox *m_maxMinutes;
+    QCheckBox *m_stopCapture;
+};
+
+#endif // EARLYSTOPDIALOG_H
@@ -17,13 +17,233 @@
 ******************************************************************************/
 
 #include "xlat_evtool.h"
+#include "chartrenderer.h"
+#include "xlat_alloctrack.h"
+#include "xlat_session.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+// Headless allocation regression check: replays a capture, or synthetic samples
+// without one, through the core pipeline and fails when the steady state
+// allocates more than the budget
+int runAllocationCheck(const QString &filePath, double budget) {
+    if (!xlat::allocTrackingEnabled()) {
+        std::fprintf(stderr, "Allocation tracking is not built in, rebuild with CONFIG+=alloc_tracking\n");
+        return 2;
+    }
+
+    xlat::CaptureCsv capture;
+    if (filePath.isEmpty()) {
+        capture.samples = xlat::syntheticAllocSamples();
+    } else {
+        std::string error;
+        if (!xlat::readCapture(QFile::encodeName(filePath).toStdString(), capture, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+    }
+
+    xlat::AllocProfile profile = xlat::profileSteadyState(capture.samples);
+    double perSample = profile.allocationsPerSample();
+    std::printf("%s", xlat::formatAllocProfile(profile).c_str());
+    std::printf("%s: %.4f allocations per sample, budget %.4f\n", perSample > budget ? "FAIL" : "OK", perSample, budget);
+    return perSample > budget ? 1 : 0;
+}
+
+// Saves a synthetic capture with every header line and reads it back, false
+// with the first line that didn't survive in `error`
+bool checkCaptureCsvRoundTrip(std::string *error) {
+    // Gaps, a duplicate and host times, so every optional line is written
+    xlat::CaptureSession session;
+    std::int64_t time = 1000000000;
+    for (int report = 1; report <= 2000; ++report) {
+        if (report % 500 == 0) continue;
+        xlatData record = { report, 800 + (report * 37) % 400, 1000, 100 };
+        session.pushRecord(record, time);
+        if (report == 1200) session.pushRecord(record, time);
+        time += 1000000 + (report % 7) * 1000;
+    }
+    session.evaluate();
+    xlat::BootstrapIntervals intervals = xlat::bootstrapIntervals(session.metrics().histogram(), xlat::BootstrapSettings());
+    intervals.p95.high = 1234567.0; // written with an exponent, must not come back as NaN
+
+    std::string text = xlat::captureCsvHeader(session, intervals);
+    std::vector<std::string> written;
+    std::istringstream lines(text);
+    for (std::string line; std::getline(lines, line) && !line.empty();) {
+        written.push_back(line);
+    }
+    const std::int64_t origin = session.store().hostTimeOrigin();
+    session.store().forEach([&](std::size_t, const xlatData &data, std::int64_t timestampNs) {
+        text += std::to_string(data.reportNumber) + "," + std::to_string(data.latency) + ","
+              + std::to_string(data.avgLatency) + "," + std::to_string(data.stdev) + ","
+              + std::to_string(timestampNs - origin) + "\n";
+    });
+
+    xlat::CaptureCsv capture;
+    xlat::CsvReadStatus status = xlat::parseCaptureCsv(text.data(), text.size(), capture);
+    for (std::size_t i = 0; i < written.size(); ++i) {
+        const std::string &line = written[i];
+        bool kept = i < capture.header.size()
+                 && line.compare(0, line.find(':'), capture.header[i].label) == 0
+                 && line.compare(line.size() - capture.header[i].text.size(), std::string::npos, capture.header[i].text) == 0;
+        if (!kept) {
+            if (error) *error = "header line not read back: " + line;
+            return false;
+        }
+    }
+    if (status != xlat::CsvReadStatus::Ok || capture.header.size() != written.size()
+        || capture.samples.size() != session.store().size() || capture.hostTimesNs.size() != capture.samples.size()) {
+        if (error) {
+            *error = capture.errors.empty() ? "samples not read back"
+                                            : "line " + std::to_string(capture.errors.front().line) + ": "
+                                              + capture.errors.front().message;
+        }
+        return false;
+    }
+    const xlat::CsvHeaderField *p95 = capture.headerField("p95 95% CI");
+    if (!p95 || !(p95->high > 1234000.0 && p95->high < 1235000.0)) {
+        if (error) *error = "p95 95% CI upper bound not read back as a number";
+        return false;
+    }
+    return true;
+}
+
+// Saves a synthetic capture and re-imports it, every metric header line must come back
+int runCsvCheck() {
+    std::string error;
+    if (!checkCaptureCsvRoundTrip(&error)) {
+        std::fprintf(stderr, "FAIL: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("OK: CSV header round trip\n");
+    return 0;
+}
+
+// Headless chart rendering for reports, no window is created
+int runChartRendering(const QStringList &files, const QString &outputDir, const QString &size, const QString &formats) {
+    ChartRenderSettings settings;
+    QStringList dimensions = size.split('x');
+    bool widthOk = false, heightOk = false;
+    if (dimensions.size() == 2) {
+        settings.size = QSize(dimensions[0].toInt(&widthOk), dimensions[1].toInt(&heightOk));
+    }
+    if (!widthOk || !heightOk || settings.size.width() < 1 || settings.size.height() < 1) {
+        qCritical() << "Invalid size, expected <width>x<height>:" << size;
+        return 2;
+    }
+    QStringList formatList = formats.toLower().split(',');
+    settings.png = formatList.contains("png");
+    settings.svg = formatList.contains("svg");
+    if (!settings.png && !settings.svg) {
+        qCritical() << "Invalid format, expected png, svg or png,svg:" << formats;
+        return 2;
+    }
+    if (!QDir().mkpath(outputDir)) {
+        qCritical() << "Cannot create" << outputDir;
+        return 2;
+    }
+
+    std::atomic<bool> cancel{ false };
+    std::size_t failed = ChartRenderer::renderCaptures(files, outputDir, settings, cancel,
+                                                       [](const QString &file, const QString &error) {
+        if (!error.isEmpty()) {
+            std::fprintf(stderr, "%s: %s\n", QFile::encodeName(file).constData(), error.toLocal8Bit().constData());
+        }
+    });
+    std::printf("%d of %d captures rendered\n", files.size() - int(failed), files.size());
+    return failed ? 1 : 0;
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startup;
+    startup.start();
+
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption metricsOption("metrics",
+                                     "Serve live metrics for scraping on 127.0.0.1:<port> or unix:<socket path>.",
+                                     "address");
+    parser.addOption(metricsOption);
+    QCommandLineOption startupOption("startup-time",
+                                     "Print how long startup takes and exit once the serial port scan is done.");
+    parser.addOption(startupOption);
+    QCommandLineOption allocCheckOption("alloc-check",
+                                        "Replay the capture given as argument, or synthetic samples without one, through "
+                                        "the pipeline, print the steady-state allocations per stage and exit non-zero when "
+                                        "they exceed the budget (needs CONFIG+=alloc_tracking).");
+    parser.addOption(allocCheckOption);
+    parser.addPositionalArgument("capture", "Capture replayed by --alloc-check.", "[capture]");
+    QCommandLineOption allocBudgetOption("alloc-budget",
+                                         "Allocations per sample allowed by --alloc-check, default "
+                                         + QString::number(xlat::kAllocBudgetPerSample) + ".",
+                                         "allocations");
+    parser.addOption(allocBudgetOption);
+    QCommandLineOption csvCheckOption("csv-check", "Save a synthetic capture as CSV, read it back and exit non-zero "
+                                      "when a metric header line is lost.");
+    parser.addOption(csvCheckOption);
+    QCommandLineOption renderOption("render",
+                                    "Render the scatter, distribution and timeline charts of a capture to image files "
+                                    "and exit, repeat for more captures. Use -platform offscreen without a display.",
+                                    "capture");
+    parser.addOption(renderOption);
+    QCommandLineOption renderDirOption("render-dir", "Folder for --render images, default the current one.", "folder", ".");
+    parser.addOption(renderDirOption);
+    QCommandLineOption renderSizeOption("render-size", "Image size for --render, default 1600x900.", "width>x<height",
+                                        "1600x900");
+    parser.addOption(renderSizeOption);
+    QCommandLineOption renderFormatOption("render-format", "png, svg or png,svg, default png.", "formats", "png");
+    parser.addOption(renderFormatOption);
+    parser.process(a);
+
+    if (parser.isSet(renderOption)) {
+        return runChartRendering(parser.values(renderOption), parser.value(renderDirOption),
+                                 parser.value(renderSizeOption), parser.value(renderFormatOption));
+    }
+
+    if (parser.isSet(csvCheckOption)) {
+        return runCsvCheck();
+    }
+
+    if (parser.isSet(allocCheckOption)) {
+        bool ok = true;
+        double budget = parser.isSet(allocBudgetOption) ? parser.value(allocBudgetOption).toDouble(&ok)
+                                                        : xlat::kAllocBudgetPerSample;
+        if (!ok) {
+            qCritical() << "Invalid allocation budget:" << parser.value(allocBudgetOption);
+            return 2;
+        }
+        const QStringList captures = parser.positionalArguments();
+        if (captures.size() > 1) {
+            qCritical() << "--alloc-check replays one capture at a time";
+            return 2;
+        }
+        return runAllocationCheck(captures.value(0), budget);
+    }
+
     xlat_evtool w;
+    if (parser.isSet(metricsOption)) {
+        QString error;
+        if (!w.startMetricsEndpoint(parser.value(metricsOption), &error)) {
+            qCritical() << "Metrics endpoint:" << error;
+            return 1;
+        }
+    }
+    w.measureStartup(startup, parser.isSet(startupOption));
     w.show();
     return a.exec();
 }
@@ -0,0 +1,193 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "metricsserver.h"
+#include <QByteArray>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+
+const qint64 kMaxRequestLine = 4096;
+
+QByteArray httpResponse(const char *status, const char *contentType, const std::string &body) {
+    QByteArray response;
+    response.reserve(int(body.size()) + 160);
+    response += "HTTP/1.0 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += contentType;
+    response += "\r\nContent-Length: ";
+    response += QByteArray::number(qulonglong(body.size()));
+    response += "\r\nConnection: close\r\n\r\n";
+    response.append(body.data(), int(body.size()));
+    return response;
+}
+
+void closeSocket(QTcpSocket *socket) { socket->disconnectFromHost(); }
+void closeSocket(QLocalSocket *socket) { socket->disconnectFromServer(); }
+
+// Lives on the server thread, it is the only reader of the snapshot exchange
+class MetricsWorker : public QObject
+{
+public:
+    explicit MetricsWorker(xlat::SnapshotExchange<xlat::MetricsSnapshot> &snapshots)
+        : m_snapshots(snapshots)
+    {
+    }
+
+    bool listen(const QString &address, QString *errorMessage) {
+        if (address.startsWith("unix:")) {
+            QString path = address.mid(5);
+            QLocalServer::removeServer(path);
+            QLocalServer *server = new QLocalServer(this);
+            QObject::connect(server, &QLocalServer::newConnection, this, [this, server]() {
+                while (QLocalSocket *socket = server->nextPendingConnection()) {
+                    QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+                    serve(socket);
+                }
+            });
+            if (!server->listen(path)) {
+                *errorMessage = server->errorString();
+                return false;
+            }
+            return true;
+        }
+
+        // Loopback only, the endpoint has no authentication
+        QHostAddress host(QHostAddress::LocalHost);
+        QString portText = address;
+        int colon = address.lastIndexOf(':');
+        if (colon >= 0) {
+            QString hostText = address.left(colon);
+            host = hostText == "localhost" ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(hostText);
+            portText = address.mid(colon + 1);
+            if (!host.isLoopback()) {
+                *errorMessage = "Only loopback addresses are allowed: " + hostText;
+                return false;
+            }
+        }
+        bool portOk = false;
+        quint16 port = portText.toUShort(&portOk);
+        if (!portOk) {
+            *errorMessage = "Invalid port: " + portText;
+            return false;
+        }
+
+        QTcpServer *server = new QTcpServer(this);
+        QObject::connect(server, &QTcpServer::newConnection, this, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                serve(socket);
+            }
+        });
+        if (!server->listen(host, port)) {
+            *errorMessage = server->errorString();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // Only the request line matters, headers and body are never looked at
+    template <typename Socket>
+    void serve(Socket *socket) {
+        QObject::connect(socket, &QIODevice::readyRead, socket, [this, socket]() {
+            if (!socket->canReadLine()) {
+                if (socket->bytesAvailable() > kMaxRequestLine) {
+                    socket->abort();
+                }
+                return;
+            }
+            QByteArray requestLine = socket->readLine(kMaxRequestLine);
+            QObject::disconnect(socket, &QIODevice::readyRead, nullptr, nullptr);
+            socket->write(respond(requestLine));
+            closeSocket(socket);
+        });
+    }
+
+    QByteArray respond(const QByteArray &requestLine) {
+        QList<QByteArray> parts = requestLine.trimmed().split(' ');
+        if (parts.size() < 2 || parts[0] != "GET") {
+            return httpResponse("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+        }
+
+        QByteArray path = parts[1];
+        int query = path.indexOf('?');
+        if (query >= 0) path.truncate(query);
+
+        const xlat::MetricsSnapshot &snapshot = m_snapshots.latest();
+        if (path == "/metrics") {
+            return httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", xlat::formatPrometheus(snapshot));
+        }
+        if (path == "/metrics.json") {
+            return httpResponse("200 OK", "application/json", xlat::formatJson(snapshot));
+        }
+        return httpResponse("404 Not Found", "text/plain", "Try /metrics or /metrics.json\n");
+    }
+
+    xlat::SnapshotExchange<xlat::MetricsSnapshot> &m_snapshots;
+};
+
+} // namespace
+
+MetricsServer::MetricsServer(xlat::SnapshotExchange<xlat::MetricsSnapshot> &snapshots, QObject *parent)
+    : QObject(parent)
+    , m_snapshots(snapshots)
+{
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const QString &address, QString *errorMessage) {
+    stop();
+
+    MetricsWorker *worker = new MetricsWorker(m_snapshots);
+    worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, worker, &QObject::deleteLater);
+    m_thread.start();
+
+    // Sockets must be created on the thread that serves them
+    bool ok = false;
+    QString error;
+    QMetaObject::invokeMethod(worker, [&]() { ok = worker->listen(address, &error); },
+                              Qt::BlockingQueuedConnection);
+    if (!ok) {
+        stop();
+        if (errorMessage) *errorMessage = error;
+        return false;
+    }
+
+    m_address = address;
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!m_thread.isRunning()) {
+        return;
+    }
+    m_thread.quit();
+    m_thread.wait();
+    m_address.clear();
+}
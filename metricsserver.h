@@ -0,0 +1,56 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "xlat_metrics.h"
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+// Tiny HTTP/1.0 endpoint for scraping a running capture:
+//   GET /metrics       Prometheus text format
+//   GET /metrics.json  JSON
+// It listens on 127.0.0.1:<port>, or on a local socket (Unix domain socket or
+// Windows named pipe) when the address is "unix:<path>". Connections are served
+// on a thread of their own, out of the snapshots the capture side publishes, so
+// a slow or stuck scraper never holds up ingest.
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(xlat::SnapshotExchange<xlat::MetricsSnapshot> &snapshots, QObject *parent = nullptr);
+    ~MetricsServer();
+
+    // Starts serving on `address` ("9464", "127.0.0.1:9464" or "unix:/tmp/xlat.sock").
+    // Returns false with `errorMessage` set when it can't listen.
+    bool start(const QString &address, QString *errorMessage = nullptr);
+    void stop();
+
+    bool isRunning() const { return m_thread.isRunning(); }
+    QString address() const { return m_address; }
+
+private:
+    xlat::SnapshotExchange<xlat::MetricsSnapshot> &m_snapshots;
+    QThread m_thread;
+    QString m_address;
+};
+
+#endif // METRICSSERVER_H
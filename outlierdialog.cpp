@@ -0,0 +1,115 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "outlierdialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QStringList>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+OutlierDialog::OutlierDialog(const xlat::OutlierRules &rules, const std::vector<xlat::OutlierRecord> &outliers,
+                             QWidget *parent)
+    : QDialog(parent)
+    , m_rules(rules)
+{
+    setWindowTitle("Outliers");
+    resize(600, 600);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QGroupBox *rulesBox = new QGroupBox("Detection rules");
+    QFormLayout *form = new QFormLayout(rulesBox);
+
+    m_tukeyEnabled = new QCheckBox("Tukey IQR fences, k =");
+    m_tukeyEnabled->setChecked(rules.tukey);
+    m_tukeyK = new QDoubleSpinBox();
+    m_tukeyK->setRange(0.5, 20.0);
+    m_tukeyK->setSingleStep(0.5);
+    m_tukeyK->setValue(rules.tukeyK);
+    form->addRow(m_tukeyEnabled, m_tukeyK);
+
+    m_madEnabled = new QCheckBox("k x MAD from median, k =");
+    m_madEnabled->setChecked(rules.mad);
+    m_madK = new QDoubleSpinBox();
+    m_madK->setRange(1.0, 50.0);
+    m_madK->setSingleStep(0.5);
+    m_madK->setValue(rules.madK);
+    form->addRow(m_madEnabled, m_madK);
+
+    m_absoluteEnabled = new QCheckBox("Latency at or above");
+    m_absoluteEnabled->setChecked(rules.absolute);
+    m_absoluteThreshold = new QSpinBox();
+    m_absoluteThreshold->setRange(0, 100000000);
+    m_absoluteThreshold->setValue(rules.absoluteThreshold);
+    form->addRow(m_absoluteEnabled, m_absoluteThreshold);
+
+    m_warmup = new QSpinBox();
+    m_warmup->setRange(1, 100000);
+    m_warmup->setValue(int(rules.warmup));
+    form->addRow("Samples before IQR/MAD rules engage", m_warmup);
+
+    m_tukeyEnabled->setToolTip("Flags reports below Q1 - k*IQR or above Q3 + k*IQR. k = 1.5 marks mild outliers, k = 3 far-out ones.");
+    m_madEnabled->setToolTip("Flags reports further than k robust standard deviations (1.4826 * median absolute deviation) from the median.");
+
+    layout->addWidget(rulesBox);
+
+    QTableWidget *table = new QTableWidget(int(outliers.size()), 4);
+    table->setHorizontalHeaderLabels({ "Report", "Latency", "Rule", "Host time (ms)" });
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+    for (std::size_t i = 0; i < outliers.size(); ++i) {
+        const xlat::OutlierRecord &o = outliers[i];
+        int row = int(i);
+        table->setItem(row, 0, new QTableWidgetItem(QString::number(o.reportNumber)));
+        table->setItem(row, 1, new QTableWidgetItem(QString::number(o.latency)));
+        table->setItem(row, 2, new QTableWidgetItem(describeRules(o.rules)));
+        table->setItem(row, 3, new QTableWidgetItem(o.hostTimeNs < 0 ? QString("-")
+                                                    : QString::number(o.hostTimeNs / 1e6, 'f', 3)));
+    }
+    layout->addWidget(table);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+}
+
+xlat::OutlierRules OutlierDialog::rules() const {
+    xlat::OutlierRules rules = m_rules;
+    rules.tukey = m_tukeyEnabled->isChecked();
+    rules.tukeyK = m_tukeyK->value();
+    rules.mad = m_madEnabled->isChecked();
+    rules.madK = m_madK->value();
+    rules.absolute = m_absoluteEnabled->isChecked();
+    rules.absoluteThreshold = m_absoluteThreshold->value();
+    rules.warmup = std::uint64_t(m_warmup->value());
+    return rules;
+}
+
+QString OutlierDialog::describeRules(std::uint8_t rules) {
+    QStringList names;
+    if (rules & xlat::TukeyFence) names << "IQR";
+    if (rules & xlat::MadDistance) names << "MAD";
+    if (rules & xlat::AbsoluteThreshold) names << "Threshold";
+    return names.join(", ");
+}
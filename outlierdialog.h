@@ -0,0 +1,53 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef OUTLIERDIALOG_H
+#define OUTLIERDIALOG_H
+
+#include "xlat_outliers.h"
+#include <QCheckBox>
+#include <QDialog>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <vector>
+
+// Edits the spike detection rules and lists the reports flagged so far
+class OutlierDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    OutlierDialog(const xlat::OutlierRules &rules, const std::vector<xlat::OutlierRecord> &outliers,
+                  QWidget *parent = nullptr);
+
+    xlat::OutlierRules rules() const;
+
+    static QString describeRules(std::uint8_t rules);
+
+private:
+    xlat::OutlierRules m_rules;
+
+    QCheckBox *m_tukeyEnabled;
+    QDoubleSpinBox *m_tukeyK;
+    QCheckBox *m_madEnabled;
+    QDoubleSpinBox *m_madK;
+    QCheckBox *m_absoluteEnabled;
+    QSpinBox *m_absoluteThreshold;
+    QSpinBox *m_warmup;
+};
+
+#endif // OUTLIERDIALOG_H
@@ -0,0 +1,240 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "renderchartsdialog.h"
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QSettings>
+#include <QVBoxLayout>
+
+RenderChartsDialog::RenderChartsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Render Charts");
+    resize(640, 480);
+
+    QSettings stored("xlat-Evtool", "xlat-Evtool");
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_files = new QListWidget();
+    m_files->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    layout->addWidget(m_files);
+
+    QHBoxLayout *fileButtons = new QHBoxLayout();
+    QPushButton *addButton = new QPushButton("Add Captures...");
+    QPushButton *removeButton = new QPushButton("Remove");
+    fileButtons->addWidget(addButton);
+    fileButtons->addWidget(removeButton);
+    fileButtons->addStretch();
+    layout->addLayout(fileButtons);
+    connect(addButton, &QPushButton::clicked, this, &RenderChartsDialog::addFiles);
+    connect(removeButton, &QPushButton::clicked, this, [this]() {
+        qDeleteAll(m_files->selectedItems());
+        updateButtons();
+    });
+
+    QFormLayout *form = new QFormLayout();
+
+    QHBoxLayout *outputRow = new QHBoxLayout();
+    m_outputDir = new QLineEdit(stored.value("render/folder").toString());
+    QPushButton *browseButton = new QPushButton("Browse...");
+    outputRow->addWidget(m_outputDir);
+    outputRow->addWidget(browseButton);
+    form->addRow("Output folder", outputRow);
+    connect(browseButton, &QPushButton::clicked, this, &RenderChartsDialog::chooseOutputDir);
+    connect(m_outputDir, &QLineEdit::textChanged, this, &RenderChartsDialog::updateButtons);
+
+    QHBoxLayout *sizeRow = new QHBoxLayout();
+    m_width = new QSpinBox();
+    m_width->setRange(200, 16000);
+    m_width->setValue(stored.value("render/width", 1600).toInt());
+    m_height = new QSpinBox();
+    m_height->setRange(150, 16000);
+    m_height->setValue(stored.value("render/height", 900).toInt());
+    sizeRow->addWidget(m_width);
+    sizeRow->addWidget(new QLabel("x"));
+    sizeRow->addWidget(m_height);
+    sizeRow->addStretch();
+    form->addRow("Size (px)", sizeRow);
+
+    const int charts = stored.value("render/charts", int(AllCharts)).toInt();
+    QHBoxLayout *chartRow = new QHBoxLayout();
+    m_scatter = new QCheckBox("Scatter");
+    m_scatter->setChecked(charts & ScatterChart);
+    m_distribution = new QCheckBox("Distribution");
+    m_distribution->setChecked(charts & DistributionChart);
+    m_timeline = new QCheckBox("Timeline");
+    m_timeline->setChecked(charts & TimelineChart);
+    chartRow->addWidget(m_scatter);
+    chartRow->addWidget(m_distribution);
+    chartRow->addWidget(m_timeline);
+    chartRow->addStretch();
+    form->addRow("Charts", chartRow);
+
+    QHBoxLayout *formatRow = new QHBoxLayout();
+    m_png = new QCheckBox("PNG");
+    m_png->setChecked(stored.value("render/png", true).toBool());
+    m_svg = new QCheckBox("SVG");
+    m_svg->setChecked(stored.value("render/svg", false).toBool());
+    formatRow->addWidget(m_png);
+    formatRow->addWidget(m_svg);
+    formatRow->addStretch();
+    form->addRow("Formats", formatRow);
+    layout->addLayout(form);
+
+    for (QCheckBox *box : { m_scatter, m_distribution, m_timeline, m_png, m_svg }) {
+        connect(box, &QCheckBox::toggled, this, &RenderChartsDialog::updateButtons);
+    }
+
+    m_progress = new QProgressBar();
+    m_progress->setValue(0);
+    layout->addWidget(m_progress);
+    m_status = new QLabel();
+    layout->addWidget(m_status);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    m_renderButton = buttons->addButton("Render", QDialogButtonBox::ActionRole);
+    m_cancelButton = buttons->addButton("Cancel", QDialogButtonBox::ActionRole);
+    connect(m_renderButton, &QPushButton::clicked, this, &RenderChartsDialog::start);
+    connect(m_cancelButton, &QPushButton::clicked, this, [this]() { m_cancel = true; });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    updateButtons();
+}
+
+RenderChartsDialog::~RenderChartsDialog() {
+    stop();
+}
+
+void RenderChartsDialog::addFiles() {
+    QStringList files = QFileDialog::getOpenFileNames(this, "Add Captures", "",
+                                                      "Captures (*.csv *.xlatc);;CSV Files (*.csv);;Compressed Captures (*.xlatc)");
+    for (const QString &file : files) {
+        if (m_files->findItems(file, Qt::MatchExactly).isEmpty()) {
+            m_files->addItem(file);
+        }
+    }
+    if (!files.isEmpty() && m_outputDir->text().isEmpty()) {
+        m_outputDir->setText(QFileInfo(files.front()).absolutePath());
+    }
+    updateButtons();
+}
+
+void RenderChartsDialog::chooseOutputDir() {
+    QString folder = QFileDialog::getExistingDirectory(this, "Output Folder", m_outputDir->text());
+    if (!folder.isEmpty()) {
+        m_outputDir->setText(folder);
+    }
+}
+
+ChartRenderSettings RenderChartsDialog::settings() const {
+    ChartRenderSettings s;
+    s.size = QSize(m_width->value(), m_height->value());
+    s.charts = (m_scatter->isChecked() ? ScatterChart : 0) | (m_distribution->isChecked() ? DistributionChart : 0)
+             | (m_timeline->isChecked() ? TimelineChart : 0);
+    s.png = m_png->isChecked();
+    s.svg = m_svg->isChecked();
+    return s;
+}
+
+void RenderChartsDialog::start() {
+    const QString folder = m_outputDir->text();
+    if (!QDir().mkpath(folder)) {
+        QMessageBox::warning(this, "Render Charts", "Cannot create " + folder);
+        return;
+    }
+
+    const ChartRenderSettings s = settings();
+    QSettings stored("xlat-Evtool", "xlat-Evtool");
+    stored.setValue("render/folder", folder);
+    stored.setValue("render/width", s.size.width());
+    stored.setValue("render/height", s.size.height());
+    stored.setValue("render/charts", s.charts);
+    stored.setValue("render/png", s.png);
+    stored.setValue("render/svg", s.svg);
+
+    QStringList files;
+    for (int i = 0; i < m_files->count(); ++i) {
+        files << m_files->item(i)->text();
+    }
+
+    stop();
+    m_cancel = false;
+    m_running = true;
+    m_errors.clear();
+    m_progress->setRange(0, files.size());
+    m_progress->setValue(0);
+    m_status->setText("Rendering...");
+    updateButtons();
+
+    // Every capture is loaded and drawn on a worker, results come back as queued calls
+    m_worker = std::thread([this, files, folder, s]() {
+        std::size_t failed = ChartRenderer::renderCaptures(files, folder, s, m_cancel,
+                                                           [this](const QString &file, const QString &error) {
+            QMetaObject::invokeMethod(this, [this, file, error]() { rendered(file, error); }, Qt::QueuedConnection);
+        });
+        QMetaObject::invokeMethod(this, [this, failed]() { finished(failed); }, Qt::QueuedConnection);
+    });
+}
+
+void RenderChartsDialog::stop() {
+    if (m_worker.joinable()) {
+        m_cancel = true;
+        m_worker.join();
+    }
+}
+
+void RenderChartsDialog::rendered(const QString &file, const QString &error) {
+    m_progress->setValue(m_progress->value() + 1);
+    if (!error.isEmpty()) {
+        m_errors << QFileInfo(file).fileName() + ": " + error;
+    }
+}
+
+void RenderChartsDialog::finished(std::size_t failed) {
+    m_running = false;
+    QString text = QString::number(m_progress->value() - int(failed)) + " of " + QString::number(m_progress->maximum())
+                 + " captures rendered";
+    if (m_cancel) {
+        text += ", cancelled";
+    }
+    m_status->setText(text);
+    updateButtons();
+
+    if (!m_errors.isEmpty()) {
+        QStringList lines = m_errors.mid(0, 10);
+        if (m_errors.size() > lines.size()) {
+            lines << "... " + QString::number(m_errors.size() - lines.size()) + " more";
+        }
+        QMessageBox::warning(this, "Render Charts", QString::number(failed) + " capture(s) failed.\n\n" + lines.join("\n"));
+    }
+}
+
+void RenderChartsDialog::updateButtons() {
+    const ChartRenderSettings s = settings();
+    m_renderButton->setEnabled(!m_running && m_files->count() > 0 && !m_outputDir->text().isEmpty()
+                               && s.charts != 0 && (s.png || s.svg));
+    m_cancelButton->setEnabled(m_running);
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef RENDERCHARTSDIALOG_H
+#define RENDERCHARTSDIALOG_H
+
+#include "chartrenderer.h"
+#include <QCheckBox>
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <atomic>
+#include <thread>
+
+// Renders the charts of many captures to image files in the background, for
+// review reports. Settings are remembered between runs.
+class RenderChartsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit RenderChartsDialog(QWidget *parent = nullptr);
+    ~RenderChartsDialog() override;
+
+private:
+    void addFiles();
+    void chooseOutputDir();
+    ChartRenderSettings settings() const;
+    void start();
+    void stop();
+    void rendered(const QString &file, const QString &error);
+    void finished(std::size_t failed);
+    void updateButtons();
+
+    QListWidget *m_files;
+    QLineEdit *m_outputDir;
+    QSpinBox *m_width;
+    QSpinBox *m_height;
+    QCheckBox *m_scatter;
+    QCheckBox *m_distribution;
+    QCheckBox *m_timeline;
+    QCheckBox *m_png;
+    QCheckBox *m_svg;
+    QProgressBar *m_progress;
+    QLabel *m_status;
+    QPushButton *m_renderButton;
+    QPushButton *m_cancelButton;
+
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{ false };
+    bool m_running = false;
+    QStringList m_errors;
+};
+
+#endif // RENDERCHARTSDIALOG_H
@@ -0,0 +1,106 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "samplefilterdialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <limits>
+
+namespace {
+
+// -1 is shown as "any" and leaves that side of the range open
+QSpinBox *boundSpinBox(const QString &suffix) {
+    QSpinBox *box = new QSpinBox();
+    box->setRange(-1, std::numeric_limits<int>::max());
+    box->setSpecialValueText("any");
+    box->setSuffix(suffix);
+    return box;
+}
+
+int toBox(int bound) {
+    return bound == std::numeric_limits<int>::min() || bound == std::numeric_limits<int>::max() ? -1 : bound;
+}
+
+int fromBox(const QSpinBox *box, int open) {
+    return box->value() < 0 ? open : box->value();
+}
+
+} // namespace
+
+SampleFilterDialog::SampleFilterDialog(const xlat::SampleFilter &filter, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Filter Samples");
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    QFormLayout *form = new QFormLayout();
+
+    m_minLatency = boundSpinBox(" us");
+    m_maxLatency = boundSpinBox(" us");
+    m_minReport = boundSpinBox(QString());
+    m_maxReport = boundSpinBox(QString());
+    form->addRow("Latency from", m_minLatency);
+    form->addRow("Latency to", m_maxLatency);
+    form->addRow("Report from", m_minReport);
+    form->addRow("Report to", m_maxReport);
+
+    m_outliersOnly = new QCheckBox("Outliers only");
+    form->addRow(m_outliersOnly);
+
+    m_order = new QComboBox();
+    m_order->addItem("Capture order", int(xlat::SampleOrder::Capture));
+    m_order->addItem("Latency, lowest first", int(xlat::SampleOrder::LatencyAscending));
+    m_order->addItem("Latency, highest first", int(xlat::SampleOrder::LatencyDescending));
+    m_order->addItem("Report number", int(xlat::SampleOrder::ReportNumber));
+    form->addRow("Order", m_order);
+
+    layout->addLayout(form);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel
+                                                     | QDialogButtonBox::Reset);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(buttons->button(QDialogButtonBox::Reset), &QPushButton::clicked, this, [this]() {
+        setFields(xlat::SampleFilter());
+    });
+    layout->addWidget(buttons);
+
+    setFields(filter);
+}
+
+void SampleFilterDialog::setFields(const xlat::SampleFilter &filter) {
+    m_minLatency->setValue(toBox(filter.minLatency));
+    m_maxLatency->setValue(toBox(filter.maxLatency));
+    m_minReport->setValue(toBox(filter.minReport));
+    m_maxReport->setValue(toBox(filter.maxReport));
+    m_outliersOnly->setChecked(filter.outliersOnly);
+    m_order->setCurrentIndex(m_order->findData(int(filter.order)));
+}
+
+xlat::SampleFilter SampleFilterDialog::filter() const {
+    xlat::SampleFilter filter;
+    filter.minLatency = fromBox(m_minLatency, std::numeric_limits<int>::min());
+    filter.maxLatency = fromBox(m_maxLatency, std::numeric_limits<int>::max());
+    filter.minReport = fromBox(m_minReport, std::numeric_limits<int>::min());
+    filter.maxReport = fromBox(m_maxReport, std::numeric_limits<int>::max());
+    filter.outliersOnly = m_outliersOnly->isChecked();
+    filter.order = xlat::SampleOrder(m_order->currentData().toInt());
+    return filter;
+}
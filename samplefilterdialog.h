@@ -0,0 +1,48 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef SAMPLEFILTERDIALOG_H
+#define SAMPLEFILTERDIALOG_H
+
+#include "xlat_sampleindex.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialog>
+#include <QSpinBox>
+
+// Picks the latency range, report range, outlier flag and order of the sample table
+class SampleFilterDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit SampleFilterDialog(const xlat::SampleFilter &filter, QWidget *parent = nullptr);
+
+    xlat::SampleFilter filter() const;
+
+private:
+    void setFields(const xlat::SampleFilter &filter);
+
+    QSpinBox *m_minLatency;
+    QSpinBox *m_maxLatency;
+    QSpinBox *m_minReport;
+    QSpinBox *m_maxReport;
+    QCheckBox *m_outliersOnly;
+    QComboBox *m_order;
+};
+
+#endif // SAMPLEFILTERDIALOG_H
@@ -0,0 +1,172 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "sampletablemodel.h"
+#include <QColor>
+#include <algorithm>
+
+SampleTableModel::SampleTableModel(const xlat::SampleStore &store, const xlat::OutlierDetector &outliers,
+                                   QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_store(store)
+    , m_outliers(outliers)
+{
+    // A sorted view reshuffles on every append, those are folded in twice a second
+    m_refresh.setSingleShot(true);
+    m_refresh.setInterval(500);
+    connect(&m_refresh, &QTimer::timeout, this, &SampleTableModel::refilter);
+}
+
+int SampleTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_rows;
+}
+
+int SampleTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : 4;
+}
+
+QVariant SampleTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows) {
+        return QVariant();
+    }
+
+    std::size_t row = sampleIndex(index.row());
+    if (role == Qt::BackgroundRole) {
+        return isOutlier(row) ? QVariant(QColor(120, 30, 30)) : QVariant();
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    xlatData sample = m_store.at(row);
+    switch (index.column()) {
+    case 0: return QString::number(sample.reportNumber);
+    case 1: return QString::number(sample.latency);
+    case 2: return QString::number(sample.avgLatency);
+    case 3: return QString::number(sample.stdev);
+    }
+    return QVariant();
+}
+
+// Plain section numbers, like the QStandardItemModel this replaces. Filtered
+// rows keep the number of the sample they show.
+QVariant SampleTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    if (orientation == Qt::Vertical && section < m_rows) {
+        return qulonglong(sampleIndex(section) + 1);
+    }
+    return section + 1;
+}
+
+void SampleTableModel::samplesAppended() {
+    if (isFiltered()) {
+        if (m_filter.order != xlat::SampleOrder::Capture) {
+            if (!m_refresh.isActive()) m_refresh.start();
+            return;
+        }
+        // Capture order: only the new samples are tested, matches go at the end
+        std::size_t first = m_index.size();
+        m_index.update(m_store);
+        m_appended.clear();
+        m_index.selectFrom(first, m_filter, m_outliers.outliers(), m_appended);
+        if (m_appended.empty()) {
+            return;
+        }
+        beginInsertRows(QModelIndex(), m_rows, m_rows + int(m_appended.size()) - 1);
+        m_visible.insert(m_visible.end(), m_appended.begin(), m_appended.end());
+        m_rows = int(m_visible.size());
+        endInsertRows();
+        return;
+    }
+
+    int rows = int(m_store.size());
+    if (rows <= m_rows) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_rows, rows - 1);
+    m_rows = rows;
+    endInsertRows();
+}
+
+void SampleTableModel::reload() {
+    if (isFiltered()) {
+        m_index.clear();
+        refilter();
+        return;
+    }
+    beginResetModel();
+    m_rows = int(m_store.size());
+    endResetModel();
+}
+
+void SampleTableModel::outlierMarked(int sampleRow) {
+    int row = rowOf(std::size_t(sampleRow));
+    if (row >= 0) {
+        emit dataChanged(index(row, 0), index(row, 3), { Qt::BackgroundRole });
+    }
+}
+
+void SampleTableModel::setFilter(const xlat::SampleFilter &filter) {
+    m_filter = filter;
+    if (isFiltered()) {
+        refilter();
+        return;
+    }
+
+    // Back to the plain view, the index memory goes with it
+    m_refresh.stop();
+    m_index = xlat::SampleIndex();
+    m_visible = std::vector<std::uint32_t>();
+    reload();
+}
+
+std::size_t SampleTableModel::sampleIndex(int row) const {
+    return isFiltered() ? m_visible[std::size_t(row)] : std::size_t(row);
+}
+
+int SampleTableModel::rowOf(std::size_t sample) const {
+    if (!isFiltered()) {
+        return sample < std::size_t(m_rows) ? int(sample) : -1;
+    }
+    if (m_filter.order == xlat::SampleOrder::Capture) {
+        auto it = std::lower_bound(m_visible.begin(), m_visible.end(), sample);
+        return it != m_visible.end() && *it == sample ? int(it - m_visible.begin()) : -1;
+    }
+    auto it = std::find(m_visible.begin(), m_visible.end(), sample);
+    return it != m_visible.end() ? int(it - m_visible.begin()) : -1;
+}
+
+void SampleTableModel::refilter() {
+    m_refresh.stop();
+    m_index.update(m_store);
+    beginResetModel();
+    m_visible = m_index.select(m_filter, m_outliers.outliers());
+    m_rows = int(m_visible.size());
+    endResetModel();
+}
+
+bool SampleTableModel::isOutlier(std::size_t row) const {
+    // Outliers are recorded in sample order
+    const auto &outliers = m_outliers.outliers();
+    auto it = std::lower_bound(outliers.begin(), outliers.end(), row,
+                               [](const xlat::OutlierRecord &o, std::size_t r) { return o.sampleIndex < r; });
+    return it != outliers.end() && it->sampleIndex == row;
+}
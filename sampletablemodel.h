@@ -0,0 +1,80 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef SAMPLETABLEMODEL_H
+#define SAMPLETABLEMODEL_H
+
+#include "xlat_outliers.h"
+#include "xlat_sampleindex.h"
+#include "xlat_samplestore.h"
+#include <QAbstractTableModel>
+#include <QTimer>
+#include <vector>
+
+// Read-only view of a SampleStore for the main table. Cells are formatted when
+// the view asks for them, so nothing is duplicated as strings, and rows living
+// in spilled chunks are paged in only while they are on screen.
+//
+// With a filter set, rows map to the matching samples through a SampleIndex,
+// which is built on first use and dropped again when the filter is cleared.
+class SampleTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    SampleTableModel(const xlat::SampleStore &store, const xlat::OutlierDetector &outliers,
+                     QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // The store grew, rows past the last known count are announced to the view
+    void samplesAppended();
+    // The store was cleared or refilled
+    void reload();
+    // Outlier flags changed for sample `sampleRow`
+    void outlierMarked(int sampleRow);
+
+    // Shows only the samples matching `filter`, in its order
+    void setFilter(const xlat::SampleFilter &filter);
+    const xlat::SampleFilter &filter() const { return m_filter; }
+    bool isFiltered() const { return m_filter.isActive(); }
+
+    // Sample shown in table row `row`
+    std::size_t sampleIndex(int row) const;
+    // Table row of sample `sample`, -1 when it is filtered out
+    int rowOf(std::size_t sample) const;
+
+private:
+    bool isOutlier(std::size_t row) const;
+    void refilter();
+
+    const xlat::SampleStore &m_store;
+    const xlat::OutlierDetector &m_outliers;
+    int m_rows = 0;
+
+    xlat::SampleFilter m_filter;
+    xlat::SampleIndex m_index;
+    std::vector<std::uint32_t> m_visible; // sample per row while filtered
+    std::vector<std::uint32_t> m_appended;
+    QTimer m_refresh;
+};
+
+#endif // SAMPLETABLEMODEL_H
@@ -0,0 +1,83 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "serialreader.h"
+#include "xlat_timing.h"
+
+SerialReader::SerialReader(QObject *parent)
+    : QObject(parent)
+    , m_port(new QSerialPort(this))
+{
+    qRegisterMetaType<QSerialPortInfo>();
+
+    m_port->setBaudRate(QSerialPort::Baud1m);
+
+    m_port->setDataBits(QSerialPort::Data8);
+    m_port->setStopBits(QSerialPort::TwoStop);
+    m_port->setParity(QSerialPort::NoParity);
+    m_port->setFlowControl(QSerialPort::HardwareControl);
+
+    connect(m_port, &QSerialPort::readyRead, this, &SerialReader::readData);
+    connect(m_port, QOverload<QSerialPort::SerialPortError>::of(&QSerialPort::errorOccurred),
+            this, &SerialReader::handleError);
+}
+
+void SerialReader::connectPort() {
+    if (m_port->isOpen()) {
+        emit portOpened(true, QString());
+        return;
+    }
+
+    QSerialPortInfo found;
+    bool ok = false;
+    // Iterate through available serial ports
+    foreach(const QSerialPortInfo &port, QSerialPortInfo::availablePorts()) {
+        // Check if the port is open
+        if (port.isValid() && !port.isBusy()) {
+            found = port;
+            ok = true;
+            break;
+        }
+    }
+
+    // Set the port name to the first open port found, if none use a default port (COM5)
+    if (ok) {
+        m_port->setPortName(found.portName());
+    }
+    bool fallback = m_port->portName().isEmpty();
+    if (fallback) {
+        m_port->setPortName("COM5");
+    }
+    emit portScanned(found, ok, fallback);
+
+    bool opened = m_port->open(QIODevice::ReadOnly);
+    emit portOpened(opened, opened ? QString() : m_port->errorString());
+}
+
+void SerialReader::readData() {
+    QByteArray data = m_port->readAll();
+    // Every record framed out of this read shares the moment its bytes arrived
+    emit dataRead(data, xlat::monotonicNowNs());
+}
+
+void SerialReader::handleError(QSerialPort::SerialPortError error) {
+    if (error == QSerialPort::ResourceError) {
+        m_port->close();
+        emit portLost();
+    }
+}
@@ -0,0 +1,60 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef SERIALREADER_H
+#define SERIALREADER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QSerialPort>
+#include <QSerialPortInfo>
+
+Q_DECLARE_METATYPE(QSerialPortInfo)
+
+// Owns the VCOM port on a worker thread. availablePorts(), the busy probe and
+// open() touch the device and take seconds on rigs with many USB serial
+// adapters, so none of it runs on the GUI thread; the window gets the result
+// and the bytes through queued signals.
+class SerialReader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SerialReader(QObject *parent = nullptr);
+
+public slots:
+    // Picks the first free port, or keeps the last one (COM5 when there never
+    // was one), and opens it
+    void connectPort();
+
+signals:
+    // `fallback` when no port was ever found and COM5 is tried blindly
+    void portScanned(const QSerialPortInfo &port, bool found, bool fallback);
+    void portOpened(bool ok, const QString &error);
+    // Monotonic host time taken the moment the read returned
+    void dataRead(const QByteArray &data, qint64 readTimeNs);
+    // The device went away, the port is closed
+    void portLost();
+
+private:
+    void readData();
+    void handleError(QSerialPort::SerialPortError error);
+
+    QSerialPort *m_port;
+};
+
+#endif // SERIALREADER_H
@@ -0,0 +1,174 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "timelinewindow.h"
+#include "xlat_samplestore.h"
+#include "xlat_timeline.h"
+#include <QApplication>
+#include <QStatusBar>
+#include <QToolBar>
+#include <QtCharts/QChartView>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Past this many segments neighbours are merged for display: widest band,
+// highest max, count-weighted median
+const std::size_t kMaxPoints = 2000;
+
+} // namespace
+
+TimelineWindow::TimelineWindow(xlat::SegmentTimeline &timeline, const xlat::SampleStore &store, QWidget *parent)
+    : QMainWindow(parent)
+    , m_timeline(timeline)
+    , m_store(store)
+{
+    setWindowTitle("Stats Timeline");
+    resize(1600, 900);
+
+    m_chart = new QtCharts::QChart();
+    m_chart->setTitle("Latency per Segment");
+    m_chart->setBackgroundBrush(QBrush(Qt::white));
+
+    m_xAxis = new QtCharts::QValueAxis();
+    m_yAxis = new QtCharts::QValueAxis();
+    m_yAxis->setTitleText("Latency (us)");
+    m_chart->addAxis(m_xAxis, Qt::AlignBottom);
+    m_chart->addAxis(m_yAxis, Qt::AlignLeft);
+
+    m_p5 = new QtCharts::QLineSeries();
+    m_p95 = new QtCharts::QLineSeries();
+    m_band = new QtCharts::QAreaSeries(m_p95, m_p5);
+    m_band->setName("p5 - p95");
+    m_band->setColor(QColor(69, 117, 180, 90));
+    m_band->setBorderColor(QColor(69, 117, 180));
+    m_p50 = new QtCharts::QLineSeries();
+    m_p50->setName("p50");
+    m_p50->setColor(QColor(49, 54, 149));
+    m_max = new QtCharts::QLineSeries();
+    m_max->setName("max");
+    m_max->setColor(QColor(165, 0, 38));
+
+    for (QtCharts::QAbstractSeries *series : { static_cast<QtCharts::QAbstractSeries *>(m_band),
+                                               static_cast<QtCharts::QAbstractSeries *>(m_p50),
+                                               static_cast<QtCharts::QAbstractSeries *>(m_max) }) {
+        m_chart->addSeries(series);
+        series->attachAxis(m_xAxis);
+        series->attachAxis(m_yAxis);
+    }
+
+    QtCharts::QChartView *view = new QtCharts::QChartView(m_chart);
+    view->setRenderHint(QPainter::Antialiasing);
+    setCentralWidget(view);
+
+    QToolBar *toolbar = addToolBar("Segments");
+    toolbar->setMovable(false);
+    toolbar->addWidget(new QLabel("Segment: "));
+    m_size = new QDoubleSpinBox();
+    m_size->setRange(0.1, 10000000.0);
+    m_size->setDecimals(1);
+    toolbar->addWidget(m_size);
+    m_unit = new QComboBox();
+    m_unit->addItem("reports");
+    m_unit->addItem("seconds");
+    toolbar->addWidget(m_unit);
+    toolbar->addAction("Apply", [this]() { applySettings(); });
+
+    m_status = new QLabel();
+    statusBar()->addWidget(m_status);
+
+    // Segments seal as the capture runs, redraw at most once a second
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this]() {
+        if (m_timeline.samples() != m_shownSamples) refresh();
+    });
+    m_refreshTimer->start();
+
+    showSettings();
+    refresh();
+}
+
+void TimelineWindow::showSettings() {
+    const xlat::SegmentSettings &settings = m_timeline.settings();
+    m_unit->setCurrentIndex(settings.unit == xlat::SegmentUnit::Seconds ? 1 : 0);
+    m_size->setValue(settings.size);
+}
+
+void TimelineWindow::applySettings() {
+    xlat::SegmentSettings settings;
+    settings.unit = m_unit->currentIndex() == 1 ? xlat::SegmentUnit::Seconds : xlat::SegmentUnit::Reports;
+    settings.size = settings.unit == xlat::SegmentUnit::Reports ? std::max(1.0, std::round(m_size->value())) : m_size->value();
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_timeline.rebuild(m_store, settings);
+    QApplication::restoreOverrideCursor();
+
+    // Seconds may have fallen back to reports
+    showSettings();
+    refresh();
+}
+
+void TimelineWindow::refresh() {
+    std::vector<xlat::TimelineSegment> segments = m_timeline.segments();
+    xlat::TimelineSegment open = m_timeline.openSegment();
+    if (open.count) {
+        segments.push_back(open);
+    }
+    m_shownSamples = m_timeline.samples();
+
+    const bool timed = !segments.empty() && segments.front().startNs >= 0;
+    m_xAxis->setTitleText(timed ? "Time (s)" : "Report index");
+
+    const std::size_t stride = std::max<std::size_t>(1, (segments.size() + kMaxPoints - 1) / kMaxPoints);
+    QVector<QPointF> p5, p50, p95, max;
+    int highest = 0;
+    for (std::size_t i = 0; i < segments.size(); i += stride) {
+        const std::size_t end = std::min(segments.size(), i + stride);
+        int low = segments[i].p5, high = segments[i].p95, top = segments[i].maxLatency;
+        double medianSum = 0.0, count = 0.0;
+        for (std::size_t j = i; j < end; ++j) {
+            low = std::min(low, segments[j].p5);
+            high = std::max(high, segments[j].p95);
+            top = std::max(top, segments[j].maxLatency);
+            medianSum += double(segments[j].p50) * segments[j].count;
+            count += segments[j].count;
+        }
+        const double x = timed ? double(segments[i].startNs) / 1e9 : double(segments[i].firstIndex);
+        p5.append(QPointF(x, low));
+        p95.append(QPointF(x, high));
+        p50.append(QPointF(x, count > 0.0 ? medianSum / count : 0.0));
+        max.append(QPointF(x, top));
+        highest = std::max(highest, top);
+    }
+    m_p5->replace(p5);
+    m_p95->replace(p95);
+    m_p50->replace(p50);
+    m_max->replace(max);
+
+    const double last = max.isEmpty() ? 1.0 : std::max(max.back().x(), 1.0);
+    m_xAxis->setRange(0, last);
+    m_yAxis->setRange(0, std::max(highest, 1) * 1.1);
+
+    QString text = QString::number(segments.size()) + " segments";
+    if (stride > 1) {
+        text += ", " + QString::number(stride) + " per point";
+    }
+    m_status->setText(text);
+}
@@ -0,0 +1,71 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef TIMELINEWINDOW_H
+#define TIMELINEWINDOW_H
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QMainWindow>
+#include <QTimer>
+#include <QtCharts/QAreaSeries>
+#include <QtCharts/QChart>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+
+namespace xlat {
+class SampleStore;
+class SegmentTimeline;
+}
+
+// p5-p95 band, median and max of every segment over the session. Follows a
+// live capture; changing the segment size rebuilds the timeline from the
+// store on all cores.
+class TimelineWindow : public QMainWindow
+{
+    Q_OBJECT
+public:
+    // Timeline and store belong to the capture, parent the window to their owner
+    TimelineWindow(xlat::SegmentTimeline &timeline, const xlat::SampleStore &store, QWidget *parent = nullptr);
+
+private:
+    void applySettings();
+    void showSettings();
+    void refresh();
+
+    xlat::SegmentTimeline &m_timeline;
+    const xlat::SampleStore &m_store;
+
+    QtCharts::QChart *m_chart;
+    QtCharts::QLineSeries *m_p5;
+    QtCharts::QLineSeries *m_p95;
+    QtCharts::QAreaSeries *m_band;
+    QtCharts::QLineSeries *m_p50;
+    QtCharts::QLineSeries *m_max;
+    QtCharts::QValueAxis *m_xAxis;
+    QtCharts::QValueAxis *m_yAxis;
+
+    QComboBox *m_unit;
+    QDoubleSpinBox *m_size;
+    QLabel *m_status;
+    QTimer *m_refreshTimer;
+    std::size_t m_shownSamples = 0;
+};
+
+#endif // TIMELINEWINDOW_H
@@ -0,0 +1,130 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "timingdialog.h"
+#include <QFormLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
+#include <QtCharts/QChart>
+#include <QtCharts/QChartView>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const int kHistogramBins = 100;
+
+} // namespace
+
+TimingDialog::TimingDialog(const xlat::ArrivalStats &stats, const xlat::SequenceTracker &sequence,
+                           const xlat::DeviceCrossCheck *check, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Report Timing");
+    resize(900, 650);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    xlat::ArrivalSummary s = stats.summary();
+    QFormLayout *form = new QFormLayout();
+    form->addRow("Reports", new QLabel(QString::number(s.reports)));
+    form->addRow("Report rate (reports/s)", new QLabel(QString::number(s.reportRate, 'f', 2)));
+    form->addRow("Mean inter-arrival (us)", new QLabel(QString::number(s.meanIntervalUs, 'f', 1)));
+    form->addRow("Jitter, stdev (us)", new QLabel(QString::number(s.jitterUs, 'f', 1)));
+    form->addRow("Median inter-arrival (us)", new QLabel(QString::number(s.medianIntervalUs)));
+    form->addRow("p99 inter-arrival (us)", new QLabel(QString::number(s.p99IntervalUs)));
+    form->addRow("Max inter-arrival (us)", new QLabel(QString::number(s.maxIntervalUs)));
+    QLabel *stalls = new QLabel(QString::number(s.stalls));
+    stalls->setToolTip("Inter-arrival times above " + QString::number(xlat::ArrivalStats::kStallFactor)
+                       + "x the median, the host or the USB stack held reports back");
+    form->addRow("Delivery stalls", stalls);
+
+    form->addRow("Missing reports", new QLabel(QString::number(sequence.missing()) + " in "
+                                               + QString::number(sequence.gaps()) + " gap(s)"));
+    form->addRow("Duplicate reports", new QLabel(QString::number(sequence.duplicates())));
+    form->addRow("Out-of-order reports", new QLabel(QString::number(sequence.outOfOrder())));
+    if (sequence.restarts()) {
+        form->addRow("Sequence restarts", new QLabel(QString::number(sequence.restarts())));
+    }
+    if (check) {
+        // Loss that isn't random pulls the host's statistics away from the device's
+        auto compare = [](double host, double device, double delta, double percent) {
+            return QString::number(host, 'f', 1) + " / " + QString::number(device, 'f', 0) + "  ("
+                 + (delta >= 0 ? "+" : "") + QString::number(delta, 'f', 1) + ", "
+                 + QString::number(percent, 'f', 2) + "%)";
+        };
+        QLabel *mean = new QLabel(compare(check->hostMean, check->deviceMean, check->meanDelta(), check->meanDeltaPercent()));
+        mean->setToolTip("Host mean over the reports received against the device's running average in the last report");
+        form->addRow("Mean, host / device (us)", mean);
+        form->addRow("Stdev, host / device (us)",
+                     new QLabel(compare(check->hostStdev, check->deviceStdev, check->stdevDelta(), check->stdevDeltaPercent())));
+    }
+    layout->addLayout(form);
+
+    if (!sequence.gapRanges().empty()) {
+        QPlainTextEdit *ranges = new QPlainTextEdit(QString::fromStdString(sequence.formatRanges(1000)));
+        ranges->setReadOnly(true);
+        ranges->setMaximumHeight(80);
+        ranges->setToolTip("Report numbers never received");
+        layout->addWidget(ranges);
+    }
+
+    QtCharts::QChart *chart = new QtCharts::QChart();
+    chart->setTitle("Inter-arrival time (us), up to p99");
+    chart->legend()->hide();
+
+    const xlat::LatencyHistogram &intervals = stats.intervalHistogram();
+    if (!intervals.isEmpty()) {
+        // The tail past p99 would squash the interesting part, it's folded into the last bin
+        int lo = intervals.minValue();
+        int hi = std::max(lo + 1, intervals.percentile(0.99));
+        double width = std::max(1.0, double(hi - lo + 1) / kHistogramBins);
+
+        std::vector<std::uint64_t> bins(kHistogramBins, 0);
+        intervals.forEachBin([&](int intervalUs, std::uint64_t count) {
+            int b = std::min(kHistogramBins - 1, int((intervalUs - lo) / width));
+            bins[b] += count;
+        });
+
+        QtCharts::QLineSeries *outline = new QtCharts::QLineSeries();
+        std::uint64_t yMax = 0;
+        for (int b = 0; b < kHistogramBins; ++b) {
+            outline->append(lo + b * width, double(bins[b]));
+            outline->append(lo + (b + 1) * width, double(bins[b]));
+            yMax = std::max(yMax, bins[b]);
+        }
+        chart->addSeries(outline);
+
+        QtCharts::QValueAxis *x = new QtCharts::QValueAxis();
+        QtCharts::QValueAxis *y = new QtCharts::QValueAxis();
+        chart->addAxis(x, Qt::AlignBottom);
+        chart->addAxis(y, Qt::AlignLeft);
+        outline->attachAxis(x);
+        outline->attachAxis(y);
+        x->setRange(lo, lo + kHistogramBins * width);
+        y->setRange(0, double(yMax) * 1.1);
+    }
+
+    QtCharts::QChartView *view = new QtCharts::QChartView(chart);
+    view->setRenderHint(QPainter::Antialiasing);
+    layout->addWidget(view);
+}
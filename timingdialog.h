@@ -0,0 +1,39 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef TIMINGDIALOG_H
+#define TIMINGDIALOG_H
+
+#include "xlat_sequence.h"
+#include "xlat_timing.h"
+#include <QDialog>
+
+// Host-side delivery view: report rate, inter-arrival jitter, report-number
+// continuity with the missing ranges, the host/device statistics cross-check
+// and the inter-arrival histogram of the capture, as of the moment it was opened
+class TimingDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    // `check` is null before the first report
+    TimingDialog(const xlat::ArrivalStats &stats, const xlat::SequenceTracker &sequence,
+                 const xlat::DeviceCrossCheck *check, QWidget *parent = nullptr);
+};
+
+#endif // TIMINGDIALOG_H
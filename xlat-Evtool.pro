@@ -1,20 +1,50 @@
-QT       += core gui serialport charts
+QT       += core gui serialport charts network svg
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
+
+include(xlat-core.pri)
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    catalogwindow.cpp \
+    chartrenderer.cpp \
+    comparisonwindow.cpp \
+    densitywindow.cpp \
+    distributionwindow.cpp \
+    earlystopdialog.cpp \
     ledwidget.cpp \
     main.cpp \
+    metricsserver.cpp \
+    outlierdialog.cpp \
+    renderchartsdialog.cpp \
+    samplefilterdialog.cpp \
+    sampletablemodel.cpp \
+    serialreader.cpp \
+    timelinewindow.cpp \
+    timingdialog.cpp \
     xlat_evtool.cpp
 
 HEADERS += \
+    catalogwindow.h \
+    chartrenderer.h \
+    comparisonwindow.h \
+    densitywindow.h \
+    distributionwindow.h \
+    earlystopdialog.h \
     ledwidget.h \
+    metricsserver.h \
+    outlierdialog.h \
+    renderchartsdialog.h \
+    samplefilterdialog.h \
+    sampletablemodel.h \
+    serialreader.h \
+    timelinewindow.h \
+    timingdialog.h \
     xlat_evtool.h
 
 FORMS += \
@@ -0,0 +1,56 @@
+# Ingest, storage and statistics without Qt. Compiled into the application
+# and into the standalone core library (xlat-core.pro).
+
+INCLUDEPATH += $$PWD
+
+# CONFIG+=alloc_tracking counts heap allocations per pipeline stage, see xlat_alloctrack.h
+alloc_tracking: DEFINES += XLAT_ALLOC_TRACKING
+
+SOURCES += \
+    $$PWD/xlat_alloctrack.cpp \
+    $$PWD/xlat_archive.cpp \
+    $$PWD/xlat_bootstrap.cpp \
+    $$PWD/xlat_catalog.cpp \
+    $$PWD/xlat_codec.cpp \
+    $$PWD/xlat_columnar.cpp \
+    $$PWD/xlat_convergence.cpp \
+    $$PWD/xlat_csv.cpp \
+    $$PWD/xlat_density.cpp \
+    $$PWD/xlat_histogram.cpp \
+    $$PWD/xlat_metrics.cpp \
+    $$PWD/xlat_outliers.cpp \
+    $$PWD/xlat_parser.cpp \
+    $$PWD/xlat_sampleindex.cpp \
+    $$PWD/xlat_samplestore.cpp \
+    $$PWD/xlat_sequence.cpp \
+    $$PWD/xlat_session.cpp \
+    $$PWD/xlat_stats.cpp \
+    $$PWD/xlat_timeline.cpp \
+    $$PWD/xlat_timing.cpp
+
+HEADERS += \
+    $$PWD/xlat_alloctrack.h \
+    $$PWD/xlat_archive.h \
+    $$PWD/xlat_bootstrap.h \
+    $$PWD/xlat_catalog.h \
+    $$PWD/xlat_codec.h \
+    $$PWD/xlat_columnar.h \
+    $$PWD/xlat_convergence.h \
+    $$PWD/xlat_csv.h \
+    $$PWD/xlat_data.h \
+    $$PWD/xlat_density.h \
+    $$PWD/xlat_histogram.h \
+    $$PWD/xlat_metrics.h \
+    $$PWD/xlat_metricset.h \
+    $$PWD/xlat_outliers.h \
+    $$PWD/xlat_parallel.h \
+    $$PWD/xlat_parser.h \
+    $$PWD/xlat_pipeline.h \
+    $$PWD/xlat_random.h \
+    $$PWD/xlat_sampleindex.h \
+    $$PWD/xlat_samplestore.h \
+    $$PWD/xlat_sequence.h \
+    $$PWD/xlat_session.h \
+    $$PWD/xlat_stats.h \
+    $$PWD/xlat_timeline.h \
+    $$PWD/xlat_timing.h
@@ -0,0 +1,14 @@
+# Core library for embedding the capture pipeline in other tools (test rigs,
+# CI, headless loggers). Needs no Qt modules, only a C++17 compiler; the API
+# entry point is xlat::CaptureSession in xlat_session.h. Clients link the
+# platform thread library (-pthread on Linux) for the parallel passes.
+
+TEMPLATE = lib
+TARGET = xlat-core
+
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+include(xlat-core.pri)
+
+DESTDIR = $$PWD
@@ -0,0 +1,225 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_alloctrack.h"
+#include "xlat_session.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace xlat {
+
+namespace {
+
+const std::size_t kStages = std::size_t(AllocStage::Count);
+
+std::atomic<std::uint64_t> g_allocations[kStages];
+std::atomic<std::uint64_t> g_bytes[kStages];
+std::atomic<std::uint64_t> g_samples(0);
+
+#ifdef XLAT_ALLOC_TRACKING
+// Plain enum, no TLS init guard: operator new may run before main() and on any thread
+thread_local AllocStage t_stage = AllocStage::Other;
+#endif
+
+} // namespace
+
+#ifdef XLAT_ALLOC_TRACKING
+// Called by the operator new replacements at the end of this file
+void chargeAllocation(std::size_t bytes) {
+    std::size_t stage = std::size_t(t_stage);
+    g_allocations[stage].fetch_add(1, std::memory_order_relaxed);
+    g_bytes[stage].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+AllocScope::AllocScope(AllocStage stage)
+    : m_previous(t_stage)
+{
+    t_stage = stage;
+}
+
+AllocScope::~AllocScope() {
+    t_stage = m_previous;
+}
+
+void noteAllocation(std::size_t bytes) {
+    chargeAllocation(bytes);
+}
+
+void noteAllocSamples(std::uint64_t samples) {
+    g_samples.fetch_add(samples, std::memory_order_relaxed);
+}
+#endif
+
+const char *allocStageName(AllocStage stage) {
+    static const char *const names[kStages] = {
+        "Other", "Read", "Parse", "Checks", "Store", "Metrics", "Timeline", "Evaluate", "Table", "Status"
+    };
+    return std::size_t(stage) < kStages ? names[std::size_t(stage)] : "?";
+}
+
+AllocCounts AllocProfile::total() const {
+    AllocCounts sum;
+    for (const AllocCounts &counts : stages) {
+        sum.allocations += counts.allocations;
+        sum.bytes += counts.bytes;
+    }
+    return sum;
+}
+
+double AllocProfile::allocationsPerSample() const {
+    return samples ? double(total().allocations) / double(samples) : 0.0;
+}
+
+AllocProfile AllocProfile::since(const AllocProfile &earlier) const {
+    AllocProfile delta;
+    for (std::size_t i = 0; i < kStages; ++i) {
+        delta.stages[i].allocations = stages[i].allocations - earlier.stages[i].allocations;
+        delta.stages[i].bytes = stages[i].bytes - earlier.stages[i].bytes;
+    }
+    delta.samples = samples - earlier.samples;
+    return delta;
+}
+
+bool allocTrackingEnabled() {
+#ifdef XLAT_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocProfile allocProfile() {
+    AllocProfile profile;
+    for (std::size_t i = 0; i < kStages; ++i) {
+        profile.stages[i].allocations = g_allocations[i].load(std::memory_order_relaxed);
+        profile.stages[i].bytes = g_bytes[i].load(std::memory_order_relaxed);
+    }
+    profile.samples = g_samples.load(std::memory_order_relaxed);
+    return profile;
+}
+
+void resetAllocProfile() {
+    for (std::size_t i = 0; i < kStages; ++i) {
+        g_allocations[i].store(0, std::memory_order_relaxed);
+        g_bytes[i].store(0, std::memory_order_relaxed);
+    }
+    g_samples.store(0, std::memory_order_relaxed);
+}
+
+std::string formatAllocProfile(const AllocProfile &profile) {
+    std::string text;
+    char line[128];
+    auto add = [&](const char *name, const AllocCounts &counts) {
+        double samples = profile.samples ? double(profile.samples) : 1.0;
+        std::snprintf(line, sizeof(line), "%-9s %12llu allocs %14llu bytes %10.4f allocs/sample %10.1f bytes/sample\n",
+                      name, (unsigned long long)counts.allocations, (unsigned long long)counts.bytes,
+                      double(counts.allocations) / samples, double(counts.bytes) / samples);
+        text += line;
+    };
+    for (std::size_t i = 0; i < kStages; ++i) {
+        if (profile.stages[i].allocations) {
+            add(allocStageName(AllocStage(i)), profile.stages[i]);
+        }
+    }
+    add("Total", profile.total());
+    std::snprintf(line, sizeof(line), "%llu samples\n", (unsigned long long)profile.samples);
+    text += line;
+    return text;
+}
+
+AllocProfile profileSteadyState(const std::vector<xlatData> &samples, std::size_t linesPerRead) {
+    if (linesPerRead == 0) linesPerRead = 1;
+
+    // Device text and read boundaries are laid out before anything is counted
+    std::string text;
+    std::vector<std::size_t> reads(1, 0);
+    char line[64];
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const xlatData &s = samples[i];
+        int n = std::snprintf(line, sizeof(line), "%d;%d;%d;%d\n", s.reportNumber, s.latency, s.avgLatency, s.stdev);
+        text.append(line, std::size_t(n));
+        if ((i + 1) % linesPerRead == 0 || i + 1 == samples.size()) {
+            reads.push_back(text.size());
+        }
+    }
+
+    CaptureSession session;
+    const std::size_t half = (reads.size() - 1) / 2;
+    const std::int64_t kReadIntervalNs = 1000000;
+    AllocProfile warm;
+    for (std::size_t r = 0; r + 1 < reads.size(); ++r) {
+        if (r == half) {
+            warm = allocProfile();
+        }
+        session.pushBytes(text.data() + reads[r], reads[r + 1] - reads[r], std::int64_t(r) * kReadIntervalNs);
+    }
+    return allocProfile().since(warm);
+}
+
+std::vector<xlatData> syntheticAllocSamples(std::size_t count) {
+    std::vector<xlatData> samples;
+    samples.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        int report = int(i % 1000000) + 1;
+        int latency = 800 + int((i * 37) % 400) + (i % 337 == 0 ? 5000 : 0);
+        samples.push_back({ report, latency, 1000, 100 });
+    }
+    return samples;
+}
+
+} // namespace xlat
+
+#ifdef XLAT_ALLOC_TRACKING
+
+// Global replacements, charged to the calling thread's stage
+namespace {
+
+void *trackedAllocate(std::size_t size) {
+    xlat::chargeAllocation(size);
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void *p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+void *operator new(std::size_t size) { return trackedAllocate(size); }
+void *operator new[](std::size_t size) { return trackedAllocate(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try { return trackedAllocate(size); } catch (...) { return nullptr; }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try { return trackedAllocate(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+#endif
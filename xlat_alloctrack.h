@@ -0,0 +1,121 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_ALLOCTRACK_H
+#define XLAT_ALLOCTRACK_H
+
+#include "xlat_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xlat {
+
+// Heap allocation counting for the per-sample path, a build option: qmake
+// CONFIG+=alloc_tracking defines XLAT_ALLOC_TRACKING, which replaces the global
+// operator new/delete. Every allocation is charged to the stage the calling
+// thread is in (see AllocScope). Without it the scopes compile to nothing.
+//
+// Only operator new is seen. Qt's QByteArray/QString buffers come from malloc()
+// directly, call noteAllocation() where one of those is made per read.
+
+enum class AllocStage : std::uint8_t {
+    Other,    // outside any scope, e.g. event loop and worker threads
+    Read,     // serial port read and the raw data signal
+    Parse,    // line framing
+    Checks,   // sequence, arrival and outlier checks
+    Store,    // sample store append
+    Metrics,  // histogram and outlier baseline updates
+    Timeline, // segment timeline
+    Evaluate, // metric evaluation and main window fields
+    Table,    // sample table updates
+    Status,   // status bar and early stop
+    Count
+};
+
+const char *allocStageName(AllocStage stage);
+
+struct AllocCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Totals per stage since the last reset, and the samples ingested meanwhile
+struct AllocProfile {
+    AllocCounts stages[std::size_t(AllocStage::Count)];
+    std::uint64_t samples = 0;
+
+    const AllocCounts &operator[](AllocStage stage) const { return stages[std::size_t(stage)]; }
+    AllocCounts total() const;
+    double allocationsPerSample() const;
+
+    // Counts accumulated between `earlier` and this profile
+    AllocProfile since(const AllocProfile &earlier) const;
+};
+
+bool allocTrackingEnabled();
+AllocProfile allocProfile();
+void resetAllocProfile();
+
+// Scopes nest, the innermost one is charged
+class AllocScope
+{
+public:
+#ifdef XLAT_ALLOC_TRACKING
+    explicit AllocScope(AllocStage stage);
+    ~AllocScope();
+
+    AllocScope(const AllocScope &) = delete;
+    AllocScope &operator=(const AllocScope &) = delete;
+
+private:
+    AllocStage m_previous;
+#else
+    explicit AllocScope(AllocStage) {}
+#endif
+};
+
+#ifdef XLAT_ALLOC_TRACKING
+void chargeAllocation(std::size_t bytes);
+void noteAllocation(std::size_t bytes);
+void noteAllocSamples(std::uint64_t samples);
+#else
+inline void noteAllocation(std::size_t) {}
+inline void noteAllocSamples(std::uint64_t) {}
+#endif
+
+// One line per stage with allocations, plus the total, as counts and per sample
+std::string formatAllocProfile(const AllocProfile &profile);
+
+// Steady-state check: feeds `samples` as device text through a fresh
+// CaptureSession, `linesPerRead` lines per push, and profiles the second half,
+// once every buffer has had the first half to grow.
+AllocProfile profileSteadyState(const std::vector<xlatData> &samples, std::size_t linesPerRead = 16);
+
+// Deterministic gapless capture for the check when no recording is at hand,
+// latencies spread over the histogram with a spike every few hundred samples
+std::vector<xlatData> syntheticAllocSamples(std::size_t count = 200000);
+
+// Allocations per sample allowed by the regression check; the steady state is
+// expected to allocate only when a store chunk or histogram fills up
+const double kAllocBudgetPerSample = 0.01;
+
+} // namespace xlat
+
+#endif // XLAT_ALLOCTRACK_H
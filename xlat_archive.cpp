@@ -0,0 +1,288 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_archive.h"
+#include "xlat_codec.h"
+#include "xlat_parallel.h"
+#include "xlat_samplestore.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace xlat {
+
+const std::size_t CaptureArchive::kBlockSize;
+
+namespace {
+
+const char kMagic[8] = { 'X', 'L', 'A', 'T', 'A', 'R', 'C', '1' };
+const char kFooterMagic[8] = { 'X', 'L', 'A', 'T', 'I', 'D', 'X', '1' };
+const std::uint32_t kVersion = 1;
+const std::uint32_t kHasHostTimes = 1;
+const std::size_t kHeaderSize = 24;
+const std::size_t kIndexEntrySize = 24;
+const std::size_t kFooterSize = 20;
+// Flags, sample count and four column headers of base, reference, width and
+// exception count: the least any encoded block takes, whatever its samples
+const std::uint32_t kMinBlockBytes = 18;
+
+void putLE(std::vector<std::uint8_t> &out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+}
+
+std::uint64_t getLE(const std::uint8_t *p, int bytes) {
+    std::uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v |= std::uint64_t(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+bool seekTo(std::FILE *file, std::uint64_t offset, int whence = SEEK_SET) {
+#if defined(_WIN32)
+    return _fseeki64(file, static_cast<__int64>(offset), whence) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), whence) == 0;
+#endif
+}
+
+std::uint64_t position(std::FILE *file) {
+#if defined(_WIN32)
+    return static_cast<std::uint64_t>(_ftelli64(file));
+#else
+    return static_cast<std::uint64_t>(ftello(file));
+#endif
+}
+
+bool fail(std::string *error, const std::string &message) {
+    if (error) *error = message;
+    return false;
+}
+
+} // namespace
+
+bool writeCaptureArchive(const std::string &path, const SampleStore &store, std::string *error) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return fail(error, "Cannot open " + path + " for writing: " + std::strerror(errno));
+    }
+
+    const bool timed = store.hasHostTimes();
+    const std::int64_t origin = store.hostTimeOrigin();
+    const std::uint64_t readErrors = store.readErrors();
+
+    std::vector<std::uint8_t> buffer;
+    buffer.insert(buffer.end(), kMagic, kMagic + 8);
+    putLE(buffer, kVersion, 4);
+    putLE(buffer, timed ? kHasHostTimes : 0, 4);
+    putLE(buffer, store.size(), 8);
+    bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+
+    std::vector<std::uint8_t> index;
+    std::vector<xlatData> samples(CaptureArchive::kBlockSize);
+    std::vector<std::int64_t> times(CaptureArchive::kBlockSize);
+    std::uint64_t offset = kHeaderSize;
+    std::size_t blocks = 0;
+
+    for (std::size_t begin = 0; ok && begin < store.size(); begin += CaptureArchive::kBlockSize) {
+        std::size_t count = std::min(CaptureArchive::kBlockSize, store.size() - begin);
+        store.read(begin, count, samples.data(), times.data());
+        if (timed) {
+            for (std::size_t i = 0; i < count; ++i) times[i] -= origin;
+        }
+
+        buffer.clear();
+        encodeBlock(samples.data(), timed ? times.data() : nullptr, count, buffer);
+        ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+
+        putLE(index, offset, 8);
+        putLE(index, count, 4);
+        putLE(index, buffer.size(), 4);
+        putLE(index, static_cast<std::uint32_t>(samples[0].reportNumber), 4);
+        putLE(index, static_cast<std::uint32_t>(samples[count - 1].reportNumber), 4);
+        offset += buffer.size();
+        ++blocks;
+    }
+
+    putLE(index, offset, 8);
+    putLE(index, blocks, 4);
+    index.insert(index.end(), kFooterMagic, kFooterMagic + 8);
+    ok = ok && std::fwrite(index.data(), 1, index.size(), file) == index.size();
+
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || store.readErrors() != readErrors) {
+        std::remove(path.c_str());
+        return fail(error, ok ? store.spillError() : "Failed to write " + path);
+    }
+    return true;
+}
+
+CaptureArchive::~CaptureArchive() {
+    close();
+}
+
+void CaptureArchive::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    m_size = 0;
+    m_indexOffset = 0;
+    m_hasHostTimes = false;
+    m_blocks.clear();
+}
+
+bool CaptureArchive::open(const std::string &path, std::string *error) {
+    close();
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) {
+        return fail(error, "Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    std::uint8_t header[kHeaderSize];
+    std::uint8_t footer[kFooterSize];
+    std::uint64_t fileSize = 0;
+    bool ok = std::fread(header, 1, kHeaderSize, m_file) == kHeaderSize
+        && std::memcmp(header, kMagic, 8) == 0
+        && seekTo(m_file, 0, SEEK_END)
+        && (fileSize = position(m_file)) >= kHeaderSize + kFooterSize
+        && seekTo(m_file, fileSize - kFooterSize)
+        && std::fread(footer, 1, kFooterSize, m_file) == kFooterSize
+        && std::memcmp(footer + 12, kFooterMagic, 8) == 0;
+    if (!ok) {
+        close();
+        return fail(error, path + " is not a compressed capture");
+    }
+    if (getLE(header + 8, 4) != kVersion) {
+        close();
+        return fail(error, path + " was written by a newer version");
+    }
+
+    m_hasHostTimes = (getLE(header + 12, 4) & kHasHostTimes) != 0;
+    m_size = getLE(header + 16, 8);
+    m_indexOffset = getLE(footer, 8);
+    std::uint64_t blockCount = getLE(footer + 8, 4);
+
+    // The count comes from the file, it must fit before anything is sized from it
+    if (blockCount > (fileSize - kHeaderSize - kFooterSize) / kIndexEntrySize) {
+        close();
+        return fail(error, path + " has a damaged block index");
+    }
+    std::vector<std::uint8_t> index(static_cast<std::size_t>(blockCount) * kIndexEntrySize);
+    ok = m_indexOffset >= kHeaderSize && m_indexOffset <= fileSize
+        && m_indexOffset + index.size() + kFooterSize == fileSize
+        && seekTo(m_file, m_indexOffset)
+        && std::fread(index.data(), 1, index.size(), m_file) == index.size();
+
+    std::uint64_t firstIndex = 0;
+    m_blocks.resize(ok ? static_cast<std::size_t>(blockCount) : 0);
+    for (std::size_t i = 0; ok && i < m_blocks.size(); ++i) {
+        const std::uint8_t *entry = index.data() + i * kIndexEntrySize;
+        ArchiveBlock &block = m_blocks[i];
+        block.offset = getLE(entry, 8);
+        block.firstIndex = firstIndex;
+        block.count = static_cast<std::uint32_t>(getLE(entry + 8, 4));
+        block.bytes = static_cast<std::uint32_t>(getLE(entry + 12, 4));
+        block.firstReport = static_cast<std::int32_t>(getLE(entry + 16, 4));
+        block.lastReport = static_cast<std::int32_t>(getLE(entry + 20, 4));
+        // Blocks are written back to back, all full but the last. That bounds
+        // m_size by the file, a damaged count can't size readAll() past it.
+        const std::uint64_t expectedOffset = i ? m_blocks[i - 1].offset + m_blocks[i - 1].bytes : kHeaderSize;
+        const bool last = i + 1 == m_blocks.size();
+        ok = block.count != 0 && block.count <= kBlockSize && (last || block.count == kBlockSize)
+            && block.bytes >= kMinBlockBytes && block.offset == expectedOffset
+            && block.offset + block.bytes <= m_indexOffset;
+        firstIndex += block.count;
+    }
+    if (!ok || firstIndex != m_size) {
+        close();
+        return fail(error, path + " has a damaged block index");
+    }
+    return true;
+}
+
+std::size_t CaptureArchive::blockOfReport(std::int32_t reportNumber) const {
+    auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), reportNumber,
+                               [](const ArchiveBlock &block, std::int32_t report) {
+                                   return block.lastReport < report;
+                               });
+    return static_cast<std::size_t>(it - m_blocks.begin());
+}
+
+bool CaptureArchive::readBlock(std::size_t block, xlatData *samples, std::int64_t *hostTimesNs) const {
+    if (block >= m_blocks.size()) return false;
+    const ArchiveBlock &b = m_blocks[block];
+
+    std::vector<std::uint8_t> data(b.bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!seekTo(m_file, b.offset) || std::fread(data.data(), 1, data.size(), m_file) != data.size()) {
+            return false;
+        }
+    }
+    return decodeBlock(data.data(), data.size(), b.count, samples, hostTimesNs) == b.bytes;
+}
+
+bool CaptureArchive::readAll(std::vector<xlatData> &samples, std::vector<std::int64_t> *hostTimesNs,
+                             std::string *error) const {
+    samples.clear();
+    if (hostTimesNs) hostTimesNs->clear();
+    if (!m_file) return fail(error, "No archive open");
+
+    // One sequential read of every block, then the blocks are decoded in place
+    // by as many workers as pay off
+    std::vector<std::uint8_t> data(static_cast<std::size_t>(m_indexOffset - kHeaderSize));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!seekTo(m_file, kHeaderSize) || std::fread(data.data(), 1, data.size(), m_file) != data.size()) {
+            return fail(error, "Failed to read the archive");
+        }
+    }
+
+    samples.resize(static_cast<std::size_t>(m_size));
+    std::int64_t *times = nullptr;
+    if (hostTimesNs && m_hasHostTimes) {
+        hostTimesNs->resize(static_cast<std::size_t>(m_size));
+        times = hostTimesNs->data();
+    }
+
+    std::atomic<bool> corrupt(false);
+    parallelChunks(m_blocks.size(), workerCount(m_blocks.size(), 16),
+                   [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end && !corrupt.load(std::memory_order_relaxed); ++i) {
+            const ArchiveBlock &b = m_blocks[i];
+            std::size_t at = static_cast<std::size_t>(b.firstIndex);
+            if (decodeBlock(data.data() + (b.offset - kHeaderSize), b.bytes, b.count,
+                            samples.data() + at, times ? times + at : nullptr) != b.bytes) {
+                corrupt = true;
+            }
+        }
+    });
+
+    if (corrupt) {
+        samples.clear();
+        if (hostTimesNs) hostTimesNs->clear();
+        return fail(error, "The archive is corrupt");
+    }
+    return true;
+}
+
+} // namespace xlat
@@ -0,0 +1,99 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_ARCHIVE_H
+#define XLAT_ARCHIVE_H
+
+#include "xlat_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xlat {
+
+class SampleStore;
+
+// Compressed capture file (.xlatc). Samples are cut into blocks of kBlockSize
+// and each block is encoded with encodeBlock(), so report numbers are delta
+// coded and latencies bit-packed. An index of every block sits at the end of
+// the file: any block can be read on its own, and a whole capture is decoded
+// block-parallel from a single read.
+//
+// Layout, little-endian:
+//   "XLATARC1", u32 version, u32 flags, u64 samples
+//   blocks
+//   index: per block u64 offset, u32 samples, u32 bytes, i32 first/last report
+//   footer: u64 index offset, u32 blocks, "XLATIDX1"
+//
+// Host times are stored relative to the first report, like the CSV export.
+struct ArchiveBlock {
+    std::uint64_t offset = 0;
+    std::uint64_t firstIndex = 0; // not stored, rebuilt from the counts
+    std::uint32_t count = 0;
+    std::uint32_t bytes = 0;
+    std::int32_t firstReport = 0;
+    std::int32_t lastReport = 0;
+};
+
+bool writeCaptureArchive(const std::string &path, const SampleStore &store, std::string *error = nullptr);
+
+class CaptureArchive
+{
+public:
+    static const std::size_t kBlockSize = 4096;
+
+    CaptureArchive() = default;
+    ~CaptureArchive();
+    CaptureArchive(const CaptureArchive &) = delete;
+    CaptureArchive &operator=(const CaptureArchive &) = delete;
+
+    // Reads the header and the block index only
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+
+    bool isOpen() const { return m_file != nullptr; }
+    std::uint64_t size() const { return m_size; }
+    bool hasHostTimes() const { return m_hasHostTimes; }
+    const std::vector<ArchiveBlock> &blocks() const { return m_blocks; }
+
+    // Block holding `reportNumber`, or the first one after it; blocks().size()
+    // when the capture ends before it. Assumes increasing report numbers.
+    std::size_t blockOfReport(std::int32_t reportNumber) const;
+
+    // Random access to one block, `samples` must hold blocks()[block].count
+    bool readBlock(std::size_t block, xlatData *samples, std::int64_t *hostTimesNs = nullptr) const;
+
+    // Whole capture. `hostTimesNs` is left empty when the archive has none.
+    bool readAll(std::vector<xlatData> &samples, std::vector<std::int64_t> *hostTimesNs = nullptr,
+                 std::string *error = nullptr) const;
+
+private:
+    std::FILE *m_file = nullptr;
+    mutable std::mutex m_mutex; // guards the file position
+    std::uint64_t m_size = 0;
+    std::uint64_t m_indexOffset = 0;
+    bool m_hasHostTimes = false;
+    std::vector<ArchiveBlock> m_blocks;
+};
+
+} // namespace xlat
+
+#endif // XLAT_ARCHIVE_H
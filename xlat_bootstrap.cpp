@@ -0,0 +1,176 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_bootstrap.h"
+#include "xlat_parallel.h"
+#include "xlat_random.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace xlat {
+
+namespace {
+
+// Slots resolved in every replicate, kept in ascending rank order
+enum Slot { P5, P10, Q1, MedianLow, MedianHigh, Q3, P90, P95, SlotCount };
+
+// Resamples drawn from one RNG stream
+const std::size_t kResampleBlock = 64;
+
+enum Metric { MetricP5, MetricP10, MetricP90, MetricP95, MetricMedian, MetricIqr, MetricMean, MetricCount };
+
+// Binomial(trials, p) draw. Small means use inversion, which is exact and needs a
+// single uniform; large means use the normal approximation, whose error is far
+// below the resampling noise. Several times faster than std::binomial_distribution,
+// which rebuilds its tables for every new parameter pair.
+std::uint64_t binomialDraw(FastRng &rng, std::uint64_t trials, double p) {
+    if (p > 0.5) {
+        return trials - binomialDraw(rng, trials, 1.0 - p);
+    }
+    double q = 1.0 - p;
+    double mean = static_cast<double>(trials) * p;
+
+    if (mean < 30.0) {
+        double s = p / q;
+        double a = (static_cast<double>(trials) + 1.0) * s;
+        double r = std::pow(q, static_cast<double>(trials));
+        double u = rng.uniform();
+        std::uint64_t x = 0;
+        while (u > r && x < trials) {
+            u -= r;
+            ++x;
+            r *= a / static_cast<double>(x) - s;
+        }
+        return x;
+    }
+
+    // Box-Muller, one of the pair is enough here
+    double u1 = 1.0 - rng.uniform();
+    double u2 = rng.uniform();
+    double gauss = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    double x = std::floor(mean + std::sqrt(mean * q) * gauss + 0.5);
+    if (x < 0.0) return 0;
+    if (x > static_cast<double>(trials)) return trials;
+    return static_cast<std::uint64_t>(x);
+}
+
+ConfidenceInterval intervalOf(std::vector<double> &replicates, double confidence) {
+    ConfidenceInterval ci;
+    if (replicates.empty()) return ci;
+
+    double alpha = (1.0 - confidence) / 2.0;
+    std::size_t last = replicates.size() - 1;
+    std::size_t lo = static_cast<std::size_t>(alpha * last + 0.5);
+    std::size_t hi = static_cast<std::size_t>((1.0 - alpha) * last + 0.5);
+
+    std::nth_element(replicates.begin(), replicates.begin() + lo, replicates.end());
+    ci.low = replicates[lo];
+    std::nth_element(replicates.begin(), replicates.begin() + hi, replicates.end());
+    ci.high = replicates[hi];
+    return ci;
+}
+
+} // namespace
+
+BootstrapIntervals bootstrapIntervals(const LatencyHistogram &histogram, const BootstrapSettings &settings) {
+    BootstrapIntervals result;
+    const std::uint64_t n = histogram.count();
+    if (n == 0 || settings.resamples <= 0) return result;
+
+    // Flatten the bins once, every replicate walks these two arrays
+    std::vector<int> values;
+    std::vector<std::uint64_t> counts;
+    histogram.forEachBin([&](int latency, std::uint64_t count) {
+        values.push_back(latency);
+        counts.push_back(count);
+    });
+    const std::size_t bins = values.size();
+
+    std::uint64_t ranks[SlotCount];
+    ranks[P5] = histogram.percentileRank(0.05);
+    ranks[P10] = histogram.percentileRank(0.10);
+    ranks[Q1] = histogram.percentileRank(0.25);
+    ranks[MedianLow] = n % 2 == 0 ? n / 2 - 1 : n / 2;
+    ranks[MedianHigh] = n / 2;
+    ranks[Q3] = histogram.percentileRank(0.75);
+    ranks[P90] = histogram.percentileRank(0.90);
+    ranks[P95] = histogram.percentileRank(0.95);
+
+    const std::size_t resamples = static_cast<std::size_t>(settings.resamples);
+    std::vector<std::vector<double>> replicates(MetricCount, std::vector<double>(resamples));
+
+    // Each block of resamples has its own stream, seeded from the block index, so
+    // the intervals for a seed don't depend on how many workers share the blocks
+    const std::size_t blocks = (resamples + kResampleBlock - 1) / kResampleBlock;
+    unsigned workers = workerCount(resamples * bins, 1 << 14);
+    parallelChunks(blocks, workers, [&](std::size_t begin, std::size_t end, unsigned) {
+        int resolved[SlotCount];
+
+        for (std::size_t block = begin; block < end; ++block) {
+            FastRng rng(settings.seed + 0x632be59bd9b4e019ULL * (block + 1));
+            const std::size_t blockEnd = std::min(resamples, (block + 1) * kResampleBlock);
+            for (std::size_t r = block * kResampleBlock; r < blockEnd; ++r) {
+                std::uint64_t remainingDraws = n;
+                std::uint64_t remainingMass = n;
+                std::uint64_t seen = 0;
+                double sum = 0.0;
+                int next = 0;
+
+                for (std::size_t b = 0; b < bins && remainingDraws > 0; ++b) {
+                    // Draws landing in this bin, conditioned on the ones already placed
+                    std::uint64_t drawn = remainingDraws;
+                    if (counts[b] < remainingMass) {
+                        double p = static_cast<double>(counts[b]) / static_cast<double>(remainingMass);
+                        drawn = binomialDraw(rng, remainingDraws, p);
+                    }
+                    remainingDraws -= drawn;
+                    remainingMass -= counts[b];
+                    if (drawn == 0) continue;
+
+                    seen += drawn;
+                    sum += static_cast<double>(drawn) * values[b];
+                    while (next < SlotCount && ranks[next] < seen) {
+                        resolved[next++] = values[b];
+                    }
+                }
+
+                replicates[MetricP5][r] = resolved[P5];
+                replicates[MetricP10][r] = resolved[P10];
+                replicates[MetricP90][r] = resolved[P90];
+                replicates[MetricP95][r] = resolved[P95];
+                replicates[MetricMedian][r] = (resolved[MedianLow] + resolved[MedianHigh]) / 2;
+                replicates[MetricIqr][r] = resolved[Q3] - resolved[Q1];
+                replicates[MetricMean][r] = sum / static_cast<double>(n);
+            }
+        }
+    });
+
+    result.resamples = settings.resamples;
+    result.confidence = settings.confidence;
+    result.p5 = intervalOf(replicates[MetricP5], settings.confidence);
+    result.p10 = intervalOf(replicates[MetricP10], settings.confidence);
+    result.p90 = intervalOf(replicates[MetricP90], settings.confidence);
+    result.p95 = intervalOf(replicates[MetricP95], settings.confidence);
+    result.median = intervalOf(replicates[MetricMedian], settings.confidence);
+    result.iqr = intervalOf(replicates[MetricIqr], settings.confidence);
+    result.avgLatency = intervalOf(replicates[MetricMean], settings.confidence);
+    return result;
+}
+
+} // namespace xlat
@@ -0,0 +1,64 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_BOOTSTRAP_H
+#define XLAT_BOOTSTRAP_H
+
+#include "xlat_histogram.h"
+#include <cstdint>
+
+namespace xlat {
+
+struct ConfidenceInterval {
+    double low = 0.0;
+    double high = 0.0;
+};
+
+struct BootstrapSettings {
+    int resamples = 200;        // 0 disables the intervals
+    double confidence = 0.95;
+    std::uint64_t seed = 0x5eed;
+};
+
+// Percentile bootstrap intervals for the point estimates of the main window
+struct BootstrapIntervals {
+    int resamples = 0;
+    double confidence = 0.0;
+    ConfidenceInterval p5;
+    ConfidenceInterval p10;
+    ConfidenceInterval p90;
+    ConfidenceInterval p95;
+    ConfidenceInterval median;
+    ConfidenceInterval iqr;
+    ConfidenceInterval avgLatency;
+
+    bool isValid() const { return resamples > 0; }
+};
+
+// Resamples the capture through its histogram: a bootstrap replicate of n samples
+// drawn from k distinct latencies is a multinomial draw over the k bins, generated
+// as a chain of binomials. Each replicate costs O(k) instead of O(n log n), so the
+// intervals can be refreshed live on captures of any length. Replicates are split
+// over all cores in fixed blocks, each block with its own generator stream, so a
+// seed gives the same intervals on any machine.
+BootstrapIntervals bootstrapIntervals(const LatencyHistogram &histogram,
+                                      const BootstrapSettings &settings = BootstrapSettings());
+
+} // namespace xlat
+
+#endif // XLAT_BOOTSTRAP_H
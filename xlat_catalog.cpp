@@ -0,0 +1,236 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_catalog.h"
+#include "xlat_csv.h"
+#include "xlat_histogram.h"
+#include "xlat_sequence.h"
+#include "xlat_session.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+namespace xlat {
+
+const char *const SessionCatalog::kMagic = "XLATCAT1";
+
+namespace {
+
+// Index lines are tab separated, the error text must stay on its field
+std::string oneField(std::string text) {
+    for (char &c : text) {
+        if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+    }
+    return text;
+}
+
+// Number of fields before the path, which comes last and may hold tabs
+const int kFields = 19;
+
+} // namespace
+
+CatalogEntry indexCapture(const FileStamp &file) {
+    CatalogEntry entry;
+    entry.file = file;
+
+    // Runs on catalog workers, where an escaping exception would end the app
+    try {
+        CaptureCsv capture;
+        std::string error;
+        if (!readCapture(file.path, capture, &error)) {
+            entry.error = error;
+            return entry;
+        }
+
+        if (capture.samples.empty()) {
+            entry.error = capture.errors.empty() ? "no samples"
+                        : "line " + std::to_string(capture.errors.front().line) + ": " + capture.errors.front().message;
+            return entry;
+        }
+
+        entry.ok = true;
+        entry.summary = summarize(LatencyHistogram::fromSamples(capture.samples));
+        if (capture.hostTimesNs.size() == capture.samples.size()) {
+            entry.durationSeconds = double(capture.hostTimesNs.back() - capture.hostTimesNs.front()) / 1e9;
+        }
+        SequenceTracker sequence;
+        for (const xlatData &d : capture.samples) {
+            sequence.add(d.reportNumber);
+        }
+        entry.missingReports = sequence.missing();
+    } catch (const std::exception &e) {
+        entry.ok = false;
+        entry.error = e.what();
+    }
+    return entry;
+}
+
+void SessionCatalog::clear() {
+    m_entries.clear();
+    m_byPath.clear();
+}
+
+std::vector<FileStamp> SessionCatalog::staleFiles(const std::vector<FileStamp> &files) const {
+    std::vector<FileStamp> stale;
+    for (const FileStamp &file : files) {
+        auto it = m_byPath.find(file.path);
+        if (it == m_byPath.end()) {
+            stale.push_back(file);
+            continue;
+        }
+        const FileStamp &known = m_entries[it->second].file;
+        if (known.size != file.size || known.modifiedMs != file.modifiedMs) {
+            stale.push_back(file);
+        }
+    }
+    return stale;
+}
+
+std::size_t SessionCatalog::retain(const std::vector<FileStamp> &files) {
+    std::unordered_map<std::string, bool> present;
+    for (const FileStamp &file : files) {
+        present[file.path] = true;
+    }
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        if (present.count(m_entries[i].file.path)) {
+            if (kept != i) m_entries[kept] = std::move(m_entries[i]);
+            ++kept;
+        }
+    }
+    std::size_t removed = m_entries.size() - kept;
+    if (removed) {
+        m_entries.resize(kept);
+        m_byPath.clear();
+        for (std::size_t i = 0; i < m_entries.size(); ++i) {
+            m_byPath[m_entries[i].file.path] = i;
+        }
+    }
+    return removed;
+}
+
+void SessionCatalog::insert(CatalogEntry entry) {
+    auto it = m_byPath.find(entry.file.path);
+    if (it != m_byPath.end()) {
+        m_entries[it->second] = std::move(entry);
+        return;
+    }
+    m_byPath[entry.file.path] = m_entries.size();
+    m_entries.push_back(std::move(entry));
+}
+
+bool SessionCatalog::load(const std::string &path, std::string *error) {
+    clear();
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return true;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, std::strlen(kMagic), kMagic) != 0) {
+        if (error) *error = path + " is not a session catalog";
+        return false;
+    }
+
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        // Split the fixed fields off the front, whatever is left is the path
+        const char *fields[kFields];
+        std::size_t start = 0;
+        int n = 0;
+        for (; n < kFields; ++n) {
+            std::size_t tab = line.find('\t', start);
+            if (tab == std::string::npos) break;
+            line[tab] = '\0';
+            fields[n] = line.c_str() + start;
+            start = tab + 1;
+        }
+        if (n < kFields || start >= line.size()) {
+            continue; // damaged line, that file is simply indexed again
+        }
+
+        CatalogEntry e;
+        e.file.size = std::strtoull(fields[0], nullptr, 10);
+        e.file.modifiedMs = std::strtoll(fields[1], nullptr, 10);
+        e.ok = fields[2][0] == '1';
+        e.summary.count = std::strtoull(fields[3], nullptr, 10);
+        e.summary.minLatency = std::atoi(fields[4]);
+        e.summary.maxLatency = std::atoi(fields[5]);
+        e.summary.p5 = std::atoi(fields[6]);
+        e.summary.p10 = std::atoi(fields[7]);
+        e.summary.medianLatency = std::atoi(fields[8]);
+        e.summary.p90 = std::atoi(fields[9]);
+        e.summary.p95 = std::atoi(fields[10]);
+        e.summary.p99 = std::atoi(fields[11]);
+        e.summary.iqr = std::atoi(fields[12]);
+        parseNumber(fields[13], fields[13] + std::strlen(fields[13]), e.summary.avgLatency);
+        parseNumber(fields[14], fields[14] + std::strlen(fields[14]), e.summary.mad);
+        parseNumber(fields[15], fields[15] + std::strlen(fields[15]), e.summary.stdev);
+        parseNumber(fields[16], fields[16] + std::strlen(fields[16]), e.durationSeconds);
+        e.missingReports = std::strtoull(fields[17], nullptr, 10);
+        e.error = fields[18];
+        e.file.path = line.substr(start);
+        insert(std::move(e));
+    }
+    return true;
+}
+
+bool SessionCatalog::save(const std::string &path, std::string *error) const {
+    const std::string temp = path + ".tmp";
+    FILE *out = std::fopen(temp.c_str(), "wb");
+    if (!out) {
+        if (error) *error = "cannot write " + temp;
+        return false;
+    }
+
+    std::fprintf(out, "%s\n", kMagic);
+    for (const CatalogEntry &e : m_entries) {
+        const LatencySummary &s = e.summary;
+        // A catalog written under a "," locale must still load under a "." one
+        std::string fractions;
+        for (double value : { s.avgLatency, s.mad, s.stdev, e.durationSeconds }) {
+            appendGeneral(fractions, value);
+            fractions += '\t';
+        }
+        std::fprintf(out, "%llu\t%lld\t%d\t%llu\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%s%llu\t%s\t%s\n",
+                     static_cast<unsigned long long>(e.file.size), static_cast<long long>(e.file.modifiedMs), e.ok ? 1 : 0,
+                     static_cast<unsigned long long>(s.count), s.minLatency, s.maxLatency, s.p5, s.p10, s.medianLatency,
+                     s.p90, s.p95, s.p99, s.iqr, fractions.c_str(),
+                     static_cast<unsigned long long>(e.missingReports), oneField(e.error).c_str(), e.file.path.c_str());
+    }
+
+    bool ok = std::fflush(out) == 0 && !std::ferror(out);
+    ok = std::fclose(out) == 0 && ok;
+    // rename() won't replace an existing file on Windows
+    if (ok) {
+        std::remove(path.c_str());
+        ok = std::rename(temp.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        std::remove(temp.c_str());
+        if (error) *error = "cannot write " + path;
+    }
+    return ok;
+}
+
+} // namespace xlat
@@ -0,0 +1,100 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_CATALOG_H
+#define XLAT_CATALOG_H
+
+#include "xlat_parallel.h"
+#include "xlat_stats.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xlat {
+
+// Identity of a capture on disk. A different size or modification time means
+// the file changed and its summary must be computed again.
+struct FileStamp {
+    std::string path; // as passed to readCaptureCsv()
+    std::uint64_t size = 0;
+    std::int64_t modifiedMs = 0;
+};
+
+// Summary of one capture, enough to filter and sort without opening it
+struct CatalogEntry {
+    FileStamp file;
+    bool ok = false;              // false: unreadable or no samples, see error
+    std::string error;
+    LatencySummary summary;
+    double durationSeconds = -1.0; // host time span, -1 for files without host times
+    std::uint64_t missingReports = 0;
+};
+
+// Reads a .csv or .xlatc capture and summarizes it, never throws
+CatalogEntry indexCapture(const FileStamp &file);
+
+// Calls indexCapture() for every file on all cores, handing each result to
+// onIndexed(CatalogEntry &&) from the worker that produced it, so the callback
+// must be thread-safe. Files are handed out one at a time, a large capture
+// doesn't hold up a whole batch. Stops early once cancel is set.
+template <typename Fn>
+void indexCaptures(const std::vector<FileStamp> &files, const std::atomic<bool> &cancel, Fn onIndexed) {
+    std::atomic<std::size_t> next{ 0 };
+    unsigned workers = workerCount(files.size(), 1);
+    parallelChunks(workers, workers, [&](std::size_t, std::size_t, unsigned) {
+        for (std::size_t i = next++; i < files.size() && !cancel.load(std::memory_order_relaxed); i = next++) {
+            onIndexed(indexCapture(files[i]));
+        }
+    });
+}
+
+// Summaries of a folder of captures, persisted to a small text index so that
+// only new or changed files are read again on the next scan
+class SessionCatalog
+{
+public:
+    static const char *const kMagic;
+
+    const std::vector<CatalogEntry> &entries() const { return m_entries; }
+    std::size_t size() const { return m_entries.size(); }
+    bool contains(const std::string &path) const { return m_byPath.count(path) != 0; }
+    void clear();
+
+    // Files never indexed or changed since, by path and stamp
+    std::vector<FileStamp> staleFiles(const std::vector<FileStamp> &files) const;
+    // Drops the entries of files no longer present, returns how many
+    std::size_t retain(const std::vector<FileStamp> &files);
+    // Adds the entry, or replaces the one with the same path
+    void insert(CatalogEntry entry);
+
+    // A missing index is an empty catalog, not an error
+    bool load(const std::string &path, std::string *error = nullptr);
+    // Written to a temporary file first, an interrupted save keeps the old index
+    bool save(const std::string &path, std::string *error = nullptr) const;
+
+private:
+    std::vector<CatalogEntry> m_entries;
+    std::unordered_map<std::string, std::size_t> m_byPath;
+};
+
+} // namespace xlat
+
+#endif // XLAT_CATALOG_H
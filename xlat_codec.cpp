@@ -0,0 +1,274 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "xlat_codec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace xlat {
+
+namespace {
+
+enum BlockFlags : std::uint8_t {
+    HasHostTimes = 1
+};
+
+inline std::uint64_t zigzag(std::int64_t v) {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t u) {
+    return static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+}
+
+inline int bitWidth(std::uint64_t v) {
+    int width = 0;
+    while (v) {
+        ++width;
+        v >>= 1;
+    }
+    return width;
+}
+
+void putVarint(std::vector<std::uint8_t> &out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+inline void storeWord(std::uint8_t *p, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+}
+
+// Little-endian load of up to 8 bytes, short reads at the end of the packed run
+inline std::uint64_t loadWord(const std::uint8_t *p, std::size_t available) {
+    std::uint64_t v = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_M_X64) || defined(_M_IX86)
+    if (available >= 8) {
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+#endif
+    std::size_t n = available < 8 ? available : 8;
+    for (std::size_t i = 0; i < n; ++i) {
+        v |= std::uint64_t(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+// Bounds-checked reader, any overrun marks the whole block bad
+struct Reader {
+    const std::uint8_t *p;
+    const std::uint8_t *end;
+    bool ok = true;
+
+    std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) break;
+            std::uint8_t byte = *p++;
+            v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::uint8_t byte() {
+        if (p == end) {
+            ok = false;
+            return 0;
+        }
+        return *p++;
+    }
+};
+
+// Column: varint base, varint reference, width byte, varint exception count,
+// packed low bits, then (index gap, high bits) varint pairs for the exceptions
+void encodeColumn(std::vector<std::uint8_t> &out, const std::int64_t *values, std::size_t n, bool delta,
+                  std::vector<std::uint64_t> &scratch) {
+    std::int64_t base = n ? values[0] : 0;
+    putVarint(out, zigzag(base));
+
+    scratch.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        // Differences wrap like unsigned arithmetic, decoding wraps them back
+        std::uint64_t from = delta ? (i ? std::uint64_t(values[i - 1]) : std::uint64_t(values[i])) : std::uint64_t(base);
+        scratch[i] = zigzag(static_cast<std::int64_t>(std::uint64_t(values[i]) - from));
+    }
+
+    std::uint64_t reference = n ? *std::min_element(scratch.begin(), scratch.end()) : 0;
+    std::size_t widthCount[65] = {};
+    for (std::size_t i = 0; i < n; ++i) {
+        scratch[i] -= reference;
+        ++widthCount[bitWidth(scratch[i])];
+    }
+
+    // Pick the width with the smallest packed size plus patch cost; an exception
+    // is budgeted at three bytes (index gap and high bits)
+    int width = 64;
+    std::size_t bestCost = static_cast<std::size_t>(-1);
+    std::size_t above = 0;
+    for (int w = 64; w >= 0; --w) {
+        std::size_t cost = (n * std::size_t(w) + 7) / 8 + above * 3;
+        if (cost <= bestCost) {
+            bestCost = cost;
+            width = w;
+        }
+        above += widthCount[w];
+    }
+
+    std::size_t exceptions = 0;
+    const std::uint64_t limit = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (scratch[i] > limit) ++exceptions;
+    }
+
+    putVarint(out, reference);
+    out.push_back(static_cast<std::uint8_t>(width));
+    putVarint(out, exceptions);
+
+    std::size_t packedStart = out.size();
+    out.resize(packedStart + (n * std::size_t(width) + 7) / 8 + 8, 0);
+    std::uint8_t *packed = out.data() + packedStart;
+    std::uint64_t acc = 0;
+    int bits = 0;
+    for (std::size_t i = 0; i < n && width; ++i) {
+        std::uint64_t v = scratch[i] & limit;
+        acc |= v << bits;
+        if (bits + width >= 64) {
+            storeWord(packed, acc);
+            packed += 8;
+            acc = bits ? v >> (64 - bits) : 0;
+            bits = bits + width - 64;
+        } else {
+            bits += width;
+        }
+    }
+    storeWord(packed, acc);
+    out.resize(packedStart + (n * std::size_t(width) + 7) / 8);
+
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (scratch[i] > limit) {
+            putVarint(out, i - last);
+            putVarint(out, scratch[i] >> width);
+            last = i;
+        }
+    }
+}
+
+bool decodeColumn(Reader &in, std::int64_t *values, std::size_t n, bool delta) {
+    std::int64_t base = unzigzag(in.varint());
+    std::uint64_t reference = in.varint();
+    int width = in.byte();
+    std::uint64_t exceptions = in.varint();
+    if (!in.ok || width > 64 || exceptions > n) return false;
+
+    std::size_t packedBytes = (n * std::size_t(width) + 7) / 8;
+    if (std::size_t(in.end - in.p) < packedBytes) return false;
+
+    // Raw unsigned offsets first, exceptions need to patch them before unmapping
+    std::uint64_t *raw = reinterpret_cast<std::uint64_t *>(values);
+    const std::uint8_t *packed = in.p;
+    const std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    for (std::size_t i = 0, bit = 0; i < n; ++i, bit += std::size_t(width)) {
+        if (!width) {
+            raw[i] = 0;
+            continue;
+        }
+        std::size_t byte = bit >> 3;
+        int shift = int(bit & 7);
+        std::uint64_t word = loadWord(packed + byte, packedBytes - byte) >> shift;
+        if (shift + width > 64) {
+            word |= std::uint64_t(packed[byte + 8]) << (64 - shift);
+        }
+        raw[i] = word & mask;
+    }
+    in.p += packedBytes;
+
+    std::size_t index = 0;
+    for (std::uint64_t e = 0; e < exceptions; ++e) {
+        index += std::size_t(in.varint());
+        std::uint64_t high = in.varint();
+        if (!in.ok || index >= n || width == 64) return false;
+        raw[index] |= high << width;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint64_t v = static_cast<std::uint64_t>(unzigzag(raw[i] + reference));
+        std::uint64_t from = delta ? (i ? std::uint64_t(values[i - 1]) : std::uint64_t(base)) : std::uint64_t(base);
+        values[i] = static_cast<std::int64_t>(from + v);
+    }
+    return true;
+}
+
+} // namespace
+
+void encodeBlock(const xlatData *samples, const std::int64_t *hostTimesNs, std::size_t count,
+                 std::vector<std::uint8_t> &out) {
+    out.push_back(hostTimesNs ? HasHostTimes : 0);
+    putVarint(out, count);
+
+    std::vector<std::int64_t> column(count);
+    std::vector<std::uint64_t> scratch;
+
+    for (std::size_t i = 0; i < count; ++i) column[i] = samples[i].reportNumber;
+    encodeColumn(out, column.data(), count, true, scratch);
+    for (std::size_t i = 0; i < count; ++i) column[i] = samples[i].latency;
+    encodeColumn(out, column.data(), count, false, scratch);
+    for (std::size_t i = 0; i < count; ++i) column[i] = samples[i].avgLatency;
+    encodeColumn(out, column.data(), count, true, scratch);
+    for (std::size_t i = 0; i < count; ++i) column[i] = samples[i].stdev;
+    encodeColumn(out, column.data(), count, true, scratch);
+    if (hostTimesNs) {
+        encodeColumn(out, hostTimesNs, count, true, scratch);
+    }
+}
+
+std::size_t decodeBlock(const std::uint8_t *data, std::size_t size, std::size_t count,
+                        xlatData *samples, std::int64_t *hostTimesNs, bool *hasHostTimes) {
+    Reader in{ data, data + size };
+    std::uint8_t flags = in.byte();
+    if (in.varint() != count || !in.ok) return 0;
+
+    std::vector<std::int64_t> column(count);
+    int xlatData::*fields[] = { &xlatData::reportNumber, &xlatData::latency, &xlatData::avgLatency, &xlatData::stdev };
+    const bool deltas[] = { true, false, true, true };
+    for (int f = 0; f < 4; ++f) {
+        if (!decodeColumn(in, column.data(), count, deltas[f])) return 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            samples[i].*fields[f] = static_cast<int>(column[i]);
+        }
+    }
+
+    bool times = (flags & HasHostTimes) != 0;
+    if (hasHostTimes) *hasHostTimes = times;
+    if (times) {
+        if (!decodeColumn(in, column.data(), count, true)) return 0;
+        if (hostTimesNs) std::copy(column.begin(), column.end(), hostTimesNs);
+    }
+    return std::size_t(in.p - data);
+}
+
+} // namespace xlat
@@ -0,0 +1,51 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef XLAT_CODEC_H
+#define XLAT_CODEC_H
+
+#include "xlat_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xlat {
+
+// Compact encoding of a run of consecutive samples, one column per field:
+//  - report numbers, running average, running stdev and host times are delta
+//    coded against the previous sample, since they move by small steps
+//  - latencies are coded as offsets to the first latency of the block
+// Every column is then zigzag mapped and bit-packed at the width that fits most
+// of its values; the few that don't (spikes, stalls) are patched in afterwards
+// as varints. A typical 1 kHz capture takes ~2.5 bytes per sample, ~5 with
+// host times.
+//
+// `hostTimesNs` may be null, the block then has no time column.
+void encodeBlock(const xlatData *samples, const std::int64_t *hostTimesNs, std::size_t count,
+                 std::vector<std::uint8_t> &out);
+
+// Decodes a block written by encodeBlock(); `count` must match. Host times are
+// written only when the block has them and `hostTimesNs` isn't null. Returns
+// the bytes consumed, 0 when the block is truncated or corrupt.
+std::size_t decodeBlock(const std::uint8_t *data, std::size_t size, std::size_t count,
+                        xlatData *samples, std::int64_t *hostTimesNs, bool *hasHostTimes = nullptr);
+
+} // namespace xlat
+
+#endif // XLAT_CODEC_H
@@ -0,0 +1,604 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_columnar.h"
+#include "xlat_samplestore.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+namespace xlat {
+
+namespace {
+
+const char *const kColumnNames[] = { "reportNumber", "latency", "avgLatency", "stdev", "hostTimeNs" };
+
+std::size_t columnCount(const SampleStore &store) {
+    return store.hasHostTimes() ? 5 : 4;
+}
+
+int columnWidth(std::size_t column) {
+    return column == 4 ? 8 : 4;
+}
+
+inline std::int64_t columnValue(std::size_t column, const xlatData &d, std::int64_t hostTimeNs) {
+    switch (column) {
+    case 0: return d.reportNumber;
+    case 1: return d.latency;
+    case 2: return d.avgLatency;
+    case 3: return d.stdev;
+    default: return hostTimeNs;
+    }
+}
+
+inline std::uint8_t *putLE(std::uint8_t *p, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        *p++ = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+    return p;
+}
+
+inline std::uint64_t padded(std::uint64_t size, std::uint64_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Samples chunk by chunk with host times relative to the first report:
+// fn(const xlatData *, const std::int64_t *, std::size_t)
+template <typename Fn>
+void forEachChunk(const SampleStore &store, Fn fn) {
+    std::vector<xlatData> samples(SampleStore::kChunkSize);
+    std::vector<std::int64_t> times(SampleStore::kChunkSize);
+    const std::int64_t origin = store.hostTimeOrigin();
+    for (std::size_t begin = 0; begin < store.size(); begin += SampleStore::kChunkSize) {
+        std::size_t n = std::min(SampleStore::kChunkSize, store.size() - begin);
+        store.read(begin, n, samples.data(), times.data());
+        for (std::size_t i = 0; i < n; ++i) times[i] -= origin;
+        fn(samples.data(), times.data(), n);
+    }
+}
+
+// CRC-32 as used by zip, slicing-by-8 so checksumming keeps up with the disk
+class Crc32
+{
+public:
+    Crc32() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            m_table[0][i] = c;
+        }
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            for (int t = 1; t < 8; ++t) {
+                m_table[t][i] = (m_table[t - 1][i] >> 8) ^ m_table[0][m_table[t - 1][i] & 0xFF];
+            }
+        }
+    }
+
+    std::uint32_t update(std::uint32_t crc, const std::uint8_t *p, std::size_t n) const {
+        crc = ~crc;
+        for (; n >= 8; p += 8, n -= 8) {
+            std::uint32_t lo = crc ^ (std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24);
+            std::uint32_t hi = std::uint32_t(p[4]) | std::uint32_t(p[5]) << 8 | std::uint32_t(p[6]) << 16 | std::uint32_t(p[7]) << 24;
+            crc = m_table[7][lo & 0xFF] ^ m_table[6][(lo >> 8) & 0xFF] ^ m_table[5][(lo >> 16) & 0xFF] ^ m_table[4][lo >> 24]
+                ^ m_table[3][hi & 0xFF] ^ m_table[2][(hi >> 8) & 0xFF] ^ m_table[1][(hi >> 16) & 0xFF] ^ m_table[0][hi >> 24];
+        }
+        while (n--) crc = m_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+private:
+    std::uint32_t m_table[8][256];
+};
+
+// Buffered output that tracks its position and, on request, a running CRC
+class OutFile
+{
+public:
+    ~OutFile() {
+        if (m_file) std::fclose(m_file);
+    }
+
+    bool open(const std::string &path, std::string *error) {
+        m_path = path;
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file && error) *error = "Cannot open " + path + " for writing: " + std::strerror(errno);
+        m_buffer.reserve(1 << 20);
+        return m_file != nullptr;
+    }
+
+    std::uint64_t pos() const { return m_pos; }
+
+    void write(const void *data, std::size_t size) {
+        const std::uint8_t *p = static_cast<const std::uint8_t *>(data);
+        if (m_crc) m_crcValue = m_crc->update(m_crcValue, p, size);
+        m_buffer.insert(m_buffer.end(), p, p + size);
+        m_pos += size;
+        if (m_buffer.size() >= (1 << 20)) flush();
+    }
+
+    void write(const std::vector<std::uint8_t> &bytes) { write(bytes.data(), bytes.size()); }
+    void write(const std::string &bytes) { write(bytes.data(), bytes.size()); }
+
+    void writeLE(std::uint64_t v, int bytes) {
+        std::uint8_t b[8];
+        putLE(b, v, bytes);
+        write(b, std::size_t(bytes));
+    }
+
+    void padTo(std::uint64_t alignment) {
+        static const std::uint8_t zeros[64] = {};
+        write(zeros, std::size_t(padded(m_pos, alignment) - m_pos));
+    }
+
+    void startCrc(const Crc32 &crc) {
+        m_crc = &crc;
+        m_crcValue = 0;
+    }
+
+    std::uint32_t stopCrc() {
+        m_crc = nullptr;
+        return m_crcValue;
+    }
+
+    // Rewrites bytes already written, the file position returns to the end
+    void patch(std::uint64_t offset, std::uint64_t v, int bytes) {
+        flush();
+        std::uint8_t b[8];
+        putLE(b, v, bytes);
+#if defined(_WIN32)
+        bool ok = _fseeki64(m_file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+        bool ok = fseeko(m_file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+        ok = ok && std::fwrite(b, 1, std::size_t(bytes), m_file) == std::size_t(bytes);
+        ok = ok && std::fseek(m_file, 0, SEEK_END) == 0;
+        m_failed |= !ok;
+    }
+
+    // Fails the export when spilled samples couldn't be read back while it ran,
+    // rather than leaving a file with zeros in their place
+    bool close(const SampleStore &store, std::uint64_t readErrors, std::string *error) {
+        flush();
+        bool ok = !m_failed && std::fclose(m_file) == 0;
+        m_file = nullptr;
+        bool complete = store.readErrors() == readErrors;
+        if (!ok || !complete) {
+            std::remove(m_path.c_str());
+            if (error) *error = ok ? store.spillError() : "Failed to write " + m_path;
+        }
+        return ok && complete;
+    }
+
+private:
+    void flush() {
+        if (!m_buffer.empty() && std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+            m_failed = true;
+        }
+        m_buffer.clear();
+    }
+
+    std::string m_path;
+    std::FILE *m_file = nullptr;
+    std::vector<std::uint8_t> m_buffer;
+    std::uint64_t m_pos = 0;
+    bool m_failed = false;
+    const Crc32 *m_crc = nullptr;
+    std::uint32_t m_crcValue = 0;
+};
+
+// Streams one column as packed little-endian values
+void writeColumn(OutFile &out, const SampleStore &store, std::size_t column) {
+    const int width = columnWidth(column);
+    std::vector<std::uint8_t> bytes;
+    forEachChunk(store, [&](const xlatData *samples, const std::int64_t *times, std::size_t n) {
+        bytes.resize(n * std::size_t(width));
+        std::uint8_t *p = bytes.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            p = putLE(p, static_cast<std::uint64_t>(columnValue(column, samples[i], times[i])), width);
+        }
+        out.write(bytes);
+    });
+}
+
+// .npy v1.0 header, padded so the data starts 64-byte aligned
+std::string npyHeader(const std::string &descr, std::uint64_t rows) {
+    std::string dict = "{'descr': " + descr + ", 'fortran_order': False, 'shape': (" + std::to_string(rows) + ",), }";
+    std::size_t total = padded(10 + dict.size() + 1, 64);
+    dict.append(total - 10 - dict.size() - 1, ' ');
+    dict += '\n';
+
+    std::string header("\x93NUMPY\x01\x00", 8);
+    header += static_cast<char>(dict.size() & 0xFF);
+    header += static_cast<char>(dict.size() >> 8);
+    return header + dict;
+}
+
+// Forward-only FlatBuffers writer, just enough for the Arrow IPC metadata.
+// Children are always written after their parent, offsets are patched in by
+// link() once the child's position is known.
+class FlatBuffer
+{
+public:
+    struct Slot {
+        std::uint16_t id;
+        std::uint8_t size; // 0 for an offset to a table, vector or string
+        std::uint64_t value;
+    };
+
+    struct Table {
+        std::size_t pos;
+        std::vector<std::size_t> slots; // position of each slot, in argument order
+    };
+
+    FlatBuffer() : m_bytes(4, 0) {}
+
+    const std::vector<std::uint8_t> &bytes() const { return m_bytes; }
+
+    void root(std::size_t table) { putLE(&m_bytes[0], table, 4); }
+
+    void link(std::size_t slot, std::size_t target) {
+        putLE(&m_bytes[slot], target - slot, 4);
+    }
+
+    Table table(std::initializer_list<Slot> slots) {
+        // Layout: soffset, then the fields largest first so each is aligned
+        std::vector<Slot> fields(slots);
+        std::vector<std::size_t> order(fields.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return width(fields[a]) > width(fields[b]);
+        });
+
+        std::vector<std::size_t> offsets(fields.size());
+        std::size_t end = 4;
+        int maxId = -1;
+        for (std::size_t i : order) {
+            end = std::size_t(padded(end, width(fields[i])));
+            offsets[i] = end;
+            end += width(fields[i]);
+            maxId = std::max(maxId, int(fields[i].id));
+        }
+        end = std::size_t(padded(end, 4));
+
+        align(2);
+        std::size_t vtable = m_bytes.size();
+        std::size_t vtableSize = 4 + 2 * std::size_t(maxId + 1);
+        m_bytes.resize(vtable + vtableSize, 0);
+        putLE(&m_bytes[vtable], vtableSize, 2);
+        putLE(&m_bytes[vtable + 2], end, 2);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            putLE(&m_bytes[vtable + 4 + 2 * fields[i].id], offsets[i], 2);
+        }
+
+        align(8);
+        Table t;
+        t.pos = m_bytes.size();
+        m_bytes.resize(t.pos + end, 0);
+        putLE(&m_bytes[t.pos], t.pos - vtable, 4);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            t.slots.push_back(t.pos + offsets[i]);
+            if (fields[i].size) putLE(&m_bytes[t.pos + offsets[i]], fields[i].value, fields[i].size);
+        }
+        return t;
+    }
+
+    std::size_t string(const std::string &s) {
+        align(4);
+        std::size_t pos = m_bytes.size();
+        m_bytes.resize(pos + 4, 0);
+        putLE(&m_bytes[pos], s.size(), 4);
+        m_bytes.insert(m_bytes.end(), s.begin(), s.end());
+        m_bytes.push_back(0);
+        return pos;
+    }
+
+    // Vector of n offsets, element i is at the returned position + 4 + 4 * i
+    std::size_t offsetVector(std::size_t n) {
+        align(4);
+        std::size_t pos = m_bytes.size();
+        m_bytes.resize(pos + 4 + 4 * n, 0);
+        putLE(&m_bytes[pos], n, 4);
+        return pos;
+    }
+
+    // Vector of 8-byte aligned structs, already serialised
+    std::size_t structVector(const std::vector<std::uint8_t> &structs, std::size_t n) {
+        while ((m_bytes.size() + 4) % 8) m_bytes.push_back(0);
+        std::size_t pos = m_bytes.size();
+        m_bytes.resize(pos + 4, 0);
+        putLE(&m_bytes[pos], n, 4);
+        m_bytes.insert(m_bytes.end(), structs.begin(), structs.end());
+        return pos;
+    }
+
+private:
+    static std::size_t width(const Slot &s) { return s.size ? s.size : 4; }
+
+    void align(std::size_t alignment) {
+        m_bytes.resize(std::size_t(padded(m_bytes.size(), alignment)), 0);
+    }
+
+    std::vector<std::uint8_t> m_bytes;
+};
+
+// Arrow's Schema.fbs / Message.fbs / File.fbs enum values
+const std::uint64_t kMetadataV5 = 4;
+const std::uint64_t kHeaderSchema = 1;
+const std::uint64_t kHeaderRecordBatch = 3;
+const std::uint64_t kTypeInt = 2;
+
+void buildSchema(FlatBuffer &fb, std::size_t slot, std::size_t columns) {
+    FlatBuffer::Table schema = fb.table({ { 0, 2, 0 /* little-endian */ }, { 1, 0, 0 } });
+    fb.link(slot, schema.pos);
+
+    std::size_t fields = fb.offsetVector(columns);
+    fb.link(schema.slots[1], fields);
+    for (std::size_t c = 0; c < columns; ++c) {
+        FlatBuffer::Table field = fb.table({ { 0, 0, 0 }, { 1, 1, 0 /* not nullable */ },
+                                             { 2, 1, kTypeInt }, { 3, 0, 0 }, { 5, 0, 0 } });
+        fb.link(fields + 4 + 4 * c, field.pos);
+        fb.link(field.slots[0], fb.string(kColumnNames[c]));
+        FlatBuffer::Table type = fb.table({ { 0, 4, std::uint64_t(columnWidth(c) * 8) }, { 1, 1, 1 /* signed */ } });
+        fb.link(field.slots[3], type.pos);
+        fb.link(field.slots[4], fb.offsetVector(0));
+    }
+}
+
+// Encapsulated message: continuation marker, length, metadata padded to 8.
+// Returns the metadata length as recorded in the footer blocks.
+std::uint64_t writeMessage(OutFile &out, const FlatBuffer &fb) {
+    std::uint64_t size = padded(fb.bytes().size(), 8);
+    out.writeLE(0xFFFFFFFFu, 4);
+    out.writeLE(size, 4);
+    out.write(fb.bytes());
+    out.padTo(8);
+    return 8 + size;
+}
+
+struct ZipEntry {
+    std::string name;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t crc;
+};
+
+const std::uint32_t kZip32Max = 0xFFFFFFFFu;
+
+} // namespace
+
+bool writeNpy(const std::string &path, const SampleStore &store, std::string *error) {
+    OutFile out;
+    const std::uint64_t readErrors = store.readErrors();
+    if (!out.open(path, error)) return false;
+
+    const std::size_t columns = columnCount(store);
+    std::string descr = "[";
+    for (std::size_t c = 0; c < columns; ++c) {
+        descr += std::string(c ? ", " : "") + "('" + kColumnNames[c] + "', '<i" + std::to_string(columnWidth(c)) + "')";
+    }
+    descr += "]";
+    out.write(npyHeader(descr, store.size()));
+
+    // Records are packed, 16 or 24 bytes
+    std::vector<std::uint8_t> bytes;
+    forEachChunk(store, [&](const xlatData *samples, const std::int64_t *times, std::size_t n) {
+        bytes.resize(n * (columns == 5 ? 24 : 16));
+        std::uint8_t *p = bytes.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t c = 0; c < columns; ++c) {
+                p = putLE(p, static_cast<std::uint64_t>(columnValue(c, samples[i], times[i])), columnWidth(c));
+            }
+        }
+        out.write(bytes);
+    });
+
+    return out.close(store, readErrors, error);
+}
+
+bool writeNpz(const std::string &path, const SampleStore &store, std::string *error) {
+    OutFile out;
+    const std::uint64_t readErrors = store.readErrors();
+    if (!out.open(path, error)) return false;
+
+    // Stored (uncompressed) members, each one a 1-D .npy. Sizes are known up
+    // front, the CRC is patched into the local header once the data is out.
+    // Zip64 fields only where a size or offset needs them.
+    static const Crc32 crc32;
+    std::vector<ZipEntry> entries;
+    for (std::size_t c = 0; c < columnCount(store); ++c) {
+        std::string header = npyHeader("'<i" + std::to_string(columnWidth(c)) + "'", store.size());
+        ZipEntry entry;
+        entry.name = std::string(kColumnNames[c]) + ".npy";
+        entry.offset = out.pos();
+        entry.size = header.size() + std::uint64_t(store.size()) * std::uint64_t(columnWidth(c));
+        const bool zip64 = entry.size >= kZip32Max;
+
+        out.writeLE(0x04034b50, 4);
+        out.writeLE(zip64 ? 45 : 20, 2);
+        out.writeLE(0, 2);          // flags
+        out.writeLE(0, 2);          // stored
+        out.writeLE(0, 2);          // time
+        out.writeLE(0x21, 2);       // date, 1980-01-01
+        out.writeLE(0, 4);          // CRC, patched below
+        out.writeLE(zip64 ? kZip32Max : entry.size, 4);
+        out.writeLE(zip64 ? kZip32Max : entry.size, 4);
+        out.writeLE(entry.name.size(), 2);
+        out.writeLE(zip64 ? 20 : 0, 2);
+        out.write(entry.name);
+        if (zip64) {
+            out.writeLE(0x0001, 2);
+            out.writeLE(16, 2);
+            out.writeLE(entry.size, 8);
+            out.writeLE(entry.size, 8);
+        }
+
+        out.startCrc(crc32);
+        out.write(header);
+        writeColumn(out, store, c);
+        entry.crc = out.stopCrc();
+        out.patch(entry.offset + 14, entry.crc, 4);
+        entries.push_back(entry);
+    }
+
+    const std::uint64_t directory = out.pos();
+    for (const ZipEntry &entry : entries) {
+        const bool bigSize = entry.size >= kZip32Max;
+        const bool bigOffset = entry.offset >= kZip32Max;
+        const int extra = (bigSize ? 16 : 0) + (bigOffset ? 8 : 0);
+        out.writeLE(0x02014b50, 4);
+        out.writeLE(extra ? 45 : 20, 2);
+        out.writeLE(extra ? 45 : 20, 2);
+        out.writeLE(0, 2);
+        out.writeLE(0, 2);
+        out.writeLE(0, 2);
+        out.writeLE(0x21, 2);
+        out.writeLE(entry.crc, 4);
+        out.writeLE(bigSize ? kZip32Max : entry.size, 4);
+        out.writeLE(bigSize ? kZip32Max : entry.size, 4);
+        out.writeLE(entry.name.size(), 2);
+        out.writeLE(extra ? extra + 4 : 0, 2);
+        out.writeLE(0, 2);          // comment
+        out.writeLE(0, 2);          // disk
+        out.writeLE(0, 2);          // internal attributes
+        out.writeLE(0, 4);          // external attributes
+        out.writeLE(bigOffset ? kZip32Max : entry.offset, 4);
+        out.write(entry.name);
+        if (extra) {
+            out.writeLE(0x0001, 2);
+            out.writeLE(std::uint64_t(extra), 2);
+            if (bigSize) {
+                out.writeLE(entry.size, 8);
+                out.writeLE(entry.size, 8);
+            }
+            if (bigOffset) out.writeLE(entry.offset, 8);
+        }
+    }
+
+    const std::uint64_t directorySize = out.pos() - directory;
+    const bool zip64 = directory >= kZip32Max;
+    if (zip64) {
+        const std::uint64_t record = out.pos();
+        out.writeLE(0x06064b50, 4);
+        out.writeLE(44, 8);
+        out.writeLE(45, 2);
+        out.writeLE(45, 2);
+        out.writeLE(0, 4);
+        out.writeLE(0, 4);
+        out.writeLE(entries.size(), 8);
+        out.writeLE(entries.size(), 8);
+        out.writeLE(directorySize, 8);
+        out.writeLE(directory, 8);
+
+        out.writeLE(0x07064b50, 4);
+        out.writeLE(0, 4);
+        out.writeLE(record, 8);
+        out.writeLE(1, 4);
+    }
+    out.writeLE(0x06054b50, 4);
+    out.writeLE(0, 2);
+    out.writeLE(0, 2);
+    out.writeLE(entries.size(), 2);
+    out.writeLE(entries.size(), 2);
+    out.writeLE(directorySize, 4);
+    out.writeLE(zip64 ? kZip32Max : directory, 4);
+    out.writeLE(0, 2);
+
+    return out.close(store, readErrors, error);
+}
+
+bool writeArrowIpc(const std::string &path, const SampleStore &store, std::string *error) {
+    OutFile out;
+    const std::uint64_t readErrors = store.readErrors();
+    if (!out.open(path, error)) return false;
+
+    const std::size_t columns = columnCount(store);
+    out.write(std::string("ARROW1\0\0", 8));
+
+    FlatBuffer schemaMessage;
+    FlatBuffer::Table message = schemaMessage.table({ { 0, 2, kMetadataV5 }, { 1, 1, kHeaderSchema }, { 2, 0, 0 }, { 3, 8, 0 } });
+    schemaMessage.root(message.pos);
+    buildSchema(schemaMessage, message.slots[2], columns);
+    writeMessage(out, schemaMessage);
+
+    // One record batch per store chunk: no validity bitmaps, one data buffer
+    // per column, each padded to 8 bytes
+    std::vector<std::uint8_t> blocks;
+    std::size_t batches = 0;
+    std::vector<std::uint8_t> bytes;
+    forEachChunk(store, [&](const xlatData *samples, const std::int64_t *times, std::size_t n) {
+        std::vector<std::uint8_t> nodes(columns * 16);
+        std::vector<std::uint8_t> buffers(columns * 32);
+        std::uint64_t bodyLength = 0;
+        for (std::size_t c = 0; c < columns; ++c) {
+            std::uint64_t length = std::uint64_t(n) * std::uint64_t(columnWidth(c));
+            putLE(putLE(&nodes[c * 16], n, 8), 0, 8);
+            std::uint8_t *b = putLE(putLE(&buffers[c * 32], bodyLength, 8), 0, 8);
+            putLE(putLE(b, bodyLength, 8), length, 8);
+            bodyLength += padded(length, 8);
+        }
+
+        FlatBuffer fb;
+        FlatBuffer::Table header = fb.table({ { 0, 2, kMetadataV5 }, { 1, 1, kHeaderRecordBatch }, { 2, 0, 0 }, { 3, 8, bodyLength } });
+        fb.root(header.pos);
+        FlatBuffer::Table batch = fb.table({ { 0, 8, n }, { 1, 0, 0 }, { 2, 0, 0 } });
+        fb.link(header.slots[2], batch.pos);
+        fb.link(batch.slots[1], fb.structVector(nodes, columns));
+        fb.link(batch.slots[2], fb.structVector(buffers, columns * 2));
+
+        const std::uint64_t offset = out.pos();
+        const std::uint64_t metadataLength = writeMessage(out, fb);
+        for (std::size_t c = 0; c < columns; ++c) {
+            bytes.resize(n * std::size_t(columnWidth(c)));
+            std::uint8_t *p = bytes.data();
+            for (std::size_t i = 0; i < n; ++i) {
+                p = putLE(p, static_cast<std::uint64_t>(columnValue(c, samples[i], times[i])), columnWidth(c));
+            }
+            out.write(bytes);
+            out.padTo(8);
+        }
+
+        std::uint8_t block[24] = {};
+        putLE(putLE(putLE(block, offset, 8), metadataLength, 4) + 4, bodyLength, 8);
+        blocks.insert(blocks.end(), block, block + 24);
+        ++batches;
+    });
+
+    // End-of-stream marker, then the footer repeating the schema and
+    // pointing at every batch
+    out.writeLE(0xFFFFFFFFu, 4);
+    out.writeLE(0, 4);
+
+    FlatBuffer footer;
+    FlatBuffer::Table root = footer.table({ { 0, 2, kMetadataV5 }, { 1, 0, 0 }, { 2, 0, 0 }, { 3, 0, 0 } });
+    footer.root(root.pos);
+    buildSchema(footer, root.slots[1], columns);
+    footer.link(root.slots[2], footer.structVector(std::vector<std::uint8_t>(), 0));
+    footer.link(root.slots[3], footer.structVector(blocks, batches));
+
+    out.write(footer.bytes());
+    out.writeLE(footer.bytes().size(), 4);
+    out.write(std::string("ARROW1", 6));
+
+    return out.close(store, readErrors, error);
+}
+
+} // namespace xlat
@@ -0,0 +1,45 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_COLUMNAR_H
+#define XLAT_COLUMNAR_H
+
+#include <string>
+
+namespace xlat {
+
+class SampleStore;
+
+// Column exports for NumPy / pandas / Arrow users, written natively and
+// streamed chunk by chunk from the store. Columns are reportNumber, latency,
+// avgLatency, stdev (int32) and, when every sample has one, hostTimeNs
+// (int64, ns since the first report). All little-endian.
+
+// One structured array: np.load(path)["latency"]
+bool writeNpy(const std::string &path, const SampleStore &store, std::string *error = nullptr);
+
+// One 1-D array per column in an uncompressed zip: np.load(path)["latency"]
+bool writeNpz(const std::string &path, const SampleStore &store, std::string *error = nullptr);
+
+// Arrow IPC file (Feather v2), one record batch per 64k samples:
+// pyarrow.ipc.open_file(path).read_all() or pandas.read_feather(path)
+bool writeArrowIpc(const std::string &path, const SampleStore &store, std::string *error = nullptr);
+
+} // namespace xlat
+
+#endif // XLAT_COLUMNAR_H
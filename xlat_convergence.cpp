@@ -0,0 +1,101 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_convergence.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace xlat {
+
+const std::uint64_t ConvergenceMonitor::kCheckInterval;
+
+void ConvergenceMonitor::setSettings(const EarlyStopSettings &settings, std::uint64_t armedAtSamples) {
+    m_settings = settings;
+    reset(armedAtSamples);
+}
+
+void ConvergenceMonitor::reset(std::uint64_t armedAtSamples) {
+    m_state = ConvergenceState();
+    m_reason = StopReason::None;
+    m_lastCheck = 0;
+    m_armedAt = armedAtSamples;
+    m_medians.clear();
+}
+
+StopReason ConvergenceMonitor::update(const LatencyHistogram &histogram, double elapsedSeconds) {
+    const std::uint64_t n = histogram.count();
+    m_state.samples = n;
+    if (!m_settings.enabled || m_reason != StopReason::None || n == 0) {
+        return StopReason::None;
+    }
+
+    if (m_settings.maxSamples && n >= m_armedAt + m_settings.maxSamples) {
+        return m_reason = StopReason::SampleLimit;
+    }
+    if (m_settings.maxSeconds > 0.0 && elapsedSeconds >= m_settings.maxSeconds) {
+        return m_reason = StopReason::TimeLimit;
+    }
+    if (n < m_lastCheck + kCheckInterval) {
+        return StopReason::None;
+    }
+    m_lastCheck = n;
+
+    // Median and the p95 interval bounds, one walk over the bins. The median
+    // rank never exceeds the lower bound: 0.45n + 0.5 >= 0.43 sqrt(n)
+    const double p = 0.95;
+    const double centre = double(n) * p;
+    const double spread = 1.96 * std::sqrt(double(n) * p * (1.0 - p));
+    const std::uint64_t ranks[3] = {
+        (n - 1) / 2,
+        std::uint64_t(std::max(0.0, std::floor(centre - spread))),
+        std::min(n - 1, std::uint64_t(std::ceil(centre + spread))),
+    };
+    int values[3];
+    histogram.valuesAtRanks(ranks, values, 3);
+    const int median = values[0];
+    m_state.p95CiWidthUs = double(values[2] - values[1]);
+
+    m_medians.push_back({ n, median });
+    while (m_medians.size() > 1 && m_medians[1].samples + m_settings.window <= n) {
+        m_medians.pop_front();
+    }
+    if (m_medians.front().samples + m_settings.window <= n && median != 0) {
+        m_state.medianDriftPercent = 100.0 * std::abs(median - m_medians.front().median) / std::abs(double(median));
+    }
+
+    if (n >= m_settings.minSamples && converged()) {
+        return m_reason = StopReason::Converged;
+    }
+    return StopReason::None;
+}
+
+bool ConvergenceMonitor::converged() const {
+    bool anyTarget = false;
+    if (m_settings.p95CiWidthUs > 0.0) {
+        anyTarget = true;
+        if (m_state.p95CiWidthUs < 0.0 || m_state.p95CiWidthUs > m_settings.p95CiWidthUs) return false;
+    }
+    if (m_settings.medianDriftPercent > 0.0) {
+        anyTarget = true;
+        if (m_state.medianDriftPercent < 0.0 || m_state.medianDriftPercent > m_settings.medianDriftPercent) return false;
+    }
+    return anyTarget;
+}
+
+} // namespace xlat
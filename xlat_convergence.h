@@ -0,0 +1,99 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_CONVERGENCE_H
+#define XLAT_CONVERGENCE_H
+
+#include "xlat_histogram.h"
+#include <cstdint>
+#include <deque>
+
+namespace xlat {
+
+// Adaptive capture length: stop once the chosen metrics have settled, or at a
+// hard limit. Targets set to 0 are not used; with no target enabled only the
+// limits apply.
+struct EarlyStopSettings {
+    bool enabled = false;
+    double p95CiWidthUs = 0.0;       // width of the 95% interval of p95
+    double medianDriftPercent = 0.0; // change of the median over the last `window` samples
+    std::uint64_t window = 1000;
+    std::uint64_t minSamples = 500;  // no convergence verdict before this
+    std::uint64_t maxSamples = 0;    // counted from arming, see ConvergenceMonitor::reset()
+    double maxSeconds = 0.0;
+    bool stopCapture = true;         // false: only signal the operator
+};
+
+enum class StopReason {
+    None,
+    Converged,
+    SampleLimit,
+    TimeLimit
+};
+
+struct ConvergenceState {
+    std::uint64_t samples = 0;
+    double p95CiWidthUs = -1.0;       // -1 until known
+    double medianDriftPercent = -1.0;
+};
+
+// Runs on the live histogram. The limits are checked on every update(); the
+// histogram is walked once every kCheckInterval samples at most, for both
+// targets together, so the per-sample cost stays negligible.
+//
+// The p95 interval is the distribution-free one from order statistics: the
+// ranks n*p -/+ 1.96*sqrt(n*p*(1-p)), read off the histogram. Unlike the
+// bootstrap it needs no resampling, just the same rank walk as the metrics.
+class ConvergenceMonitor
+{
+public:
+    static const std::uint64_t kCheckInterval = 50;
+
+    void setSettings(const EarlyStopSettings &settings, std::uint64_t armedAtSamples = 0);
+    const EarlyStopSettings &settings() const { return m_settings; }
+
+    // Arms again with `armedAtSamples` already in the histogram, they still
+    // count towards convergence but not towards maxSamples
+    void reset(std::uint64_t armedAtSamples = 0);
+
+    // Returns the reason once, on the update that reaches it, None otherwise.
+    // elapsedSeconds is the time since arming.
+    StopReason update(const LatencyHistogram &histogram, double elapsedSeconds);
+
+    const ConvergenceState &state() const { return m_state; }
+    StopReason reason() const { return m_reason; }
+
+private:
+    struct Checkpoint {
+        std::uint64_t samples;
+        int median;
+    };
+
+    bool converged() const;
+
+    EarlyStopSettings m_settings;
+    ConvergenceState m_state;
+    StopReason m_reason = StopReason::None;
+    std::uint64_t m_lastCheck = 0;
+    std::uint64_t m_armedAt = 0;
+    std::deque<Checkpoint> m_medians;
+};
+
+} // namespace xlat
+
+#endif // XLAT_CONVERGENCE_H
@@ -0,0 +1,327 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_csv.h"
+#include <algorithm>
+#include <cerrno>
+#include <clocale>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#define XLAT_HAVE_FROM_CHARS
+#endif
+#endif
+
+namespace xlat {
+
+const std::size_t CaptureCsv::kMaxErrors;
+
+namespace {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+void trim(const char *&begin, const char *&end) {
+    while (begin != end && isBlank(*begin)) ++begin;
+    while (end != begin && isBlank(end[-1])) --end;
+}
+
+// Whole-field integer, surrounding blanks allowed. MinGW 7.3 (Qt 5.12) ships
+// no <charconv>, it gets the hand-rolled loop.
+template <typename T>
+bool parseInt(const char *begin, const char *end, T &value) {
+    trim(begin, end);
+    if (begin != end && *begin == '+') ++begin;
+    if (begin == end) return false;
+#ifdef XLAT_HAVE_FROM_CHARS
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    bool negative = *begin == '-';
+    if (negative && ++begin == end) return false;
+    typedef typename std::make_unsigned<T>::type U;
+    const U limit = static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+    U result = 0;
+    for (; begin != end; ++begin) {
+        if (!isDigit(*begin)) return false;
+        U digit = static_cast<U>(*begin - '0');
+        if (result > (limit - digit) / 10) return false;
+        result = result * 10 + digit;
+    }
+    value = negative ? static_cast<T>(U(0) - result) : static_cast<T>(result);
+    return true;
+#endif
+}
+
+// Metric lines are "label: value", the label never holds a comma. Sample
+// lines have no colon at all.
+bool isHeaderLine(const char *begin, const char *end) {
+    for (const char *p = begin; p != end; ++p) {
+        if (*p == ':') return true;
+        if (*p == ',') return false;
+    }
+    return false;
+}
+
+class Parser
+{
+public:
+    explicit Parser(CaptureCsv &capture) : m_capture(capture) {}
+
+    void headerLine(const char *begin, const char *end) {
+        const char *colon = static_cast<const char *>(std::memchr(begin, ':', std::size_t(end - begin)));
+        if (!colon) {
+            error("unrecognised line in the metric header");
+            return;
+        }
+
+        CsvHeaderField field;
+        const char *labelEnd = colon;
+        trim(begin, labelEnd);
+        const char *text = colon + 1;
+        trim(text, end);
+        field.label.assign(begin, labelEnd);
+        field.text.assign(text, end);
+
+        // "value" or "low - high". The separator is the first '-' after a digit,
+        // which skips a leading sign and the one in an exponent like 1.2e-05.
+        const char *separator = end;
+        for (const char *p = text; p != end && separator == end; ++p) {
+            const char *before = p;
+            while (before != text && isBlank(before[-1])) --before;
+            if (*p == '-' && before != text && (isDigit(before[-1]) || before[-1] == '.')) {
+                separator = p;
+            }
+        }
+        bool ok = parseNumber(text, separator, field.value);
+        field.high = field.value;
+        if (ok && separator != end) {
+            ok = parseNumber(separator + 1, end, field.high);
+        }
+        if (!ok) {
+            // Free-text values, e.g. the gap ranges, or "nan" for an empty capture
+            field.value = field.high = std::numeric_limits<double>::quiet_NaN();
+        }
+        m_capture.header.push_back(std::move(field));
+    }
+
+    void sampleLine(const char *begin, const char *end) {
+        // Fields are split in place, the fifth one is optional
+        const char *fields[6];
+        int count = 0;
+        fields[count++] = begin;
+        for (const char *p = begin; p != end && count < 6; ++p) {
+            if (*p == ',') fields[count++] = p + 1;
+        }
+        if (count < 4 || count > 5) {
+            error(count < 4 ? "expected at least 4 fields" : "too many fields");
+            return;
+        }
+
+        int values[4];
+        for (int i = 0; i < 4; ++i) {
+            if (!parseInt(fields[i], i + 1 < count ? fields[i + 1] - 1 : end, values[i])) {
+                error("non-numeric data in field " + std::to_string(i + 1));
+                return;
+            }
+        }
+
+        std::int64_t hostTime = 0;
+        bool timed = count == 5 && parseInt(fields[4], end, hostTime);
+        if (count == 5 && !timed) {
+            error("non-numeric host time");
+            return;
+        }
+
+        m_capture.samples.push_back({ values[0], values[1], values[2], values[3] });
+        if (timed && m_timesComplete) {
+            m_capture.hostTimesNs.push_back(hostTime);
+        } else {
+            m_timesComplete = false;
+        }
+    }
+
+    void line(const char *begin, const char *end) {
+        ++m_line;
+        const char *first = begin;
+        while (first != end && isBlank(*first)) ++first;
+
+        // The metric block ends at the first blank line. Files without one,
+        // or written by hand, may start with samples straight away. Labels can
+        // start with a digit ("10% Trimmed Mean"), so lines are told apart by
+        // their shape.
+        if (m_inHeader) {
+            if (first == end) {
+                m_inHeader = false;
+                return;
+            }
+            if (isHeaderLine(first, end) || (!isDigit(*first) && *first != '-')) {
+                headerLine(first, end);
+                return;
+            }
+            m_inHeader = false;
+        }
+        if (first != end) {
+            sampleLine(first, end);
+        }
+    }
+
+    void finish() {
+        if (!m_timesComplete || m_capture.hostTimesNs.size() != m_capture.samples.size()) {
+            m_capture.hostTimesNs.clear();
+        }
+    }
+
+private:
+    void error(std::string message) {
+        if (m_capture.errorCount++ < CaptureCsv::kMaxErrors) {
+            m_capture.errors.push_back({ m_line, std::move(message) });
+        }
+    }
+
+    CaptureCsv &m_capture;
+    std::size_t m_line = 0;
+    bool m_inHeader = true;
+    bool m_timesComplete = true;
+};
+
+// `fixed` decimals or `precision` significant digits
+void appendFormatted(std::string &out, double value, bool fixed, int precision) {
+    char buffer[512];
+#if defined(XLAT_HAVE_FROM_CHARS) && defined(__cpp_lib_to_chars)
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                                fixed ? std::chars_format::fixed : std::chars_format::general, precision);
+    if (result.ec == std::errc()) {
+        out.append(buffer, result.ptr);
+        return;
+    }
+#endif
+    // snprintf follows LC_NUMERIC, which Qt sets from the environment on Unix
+    int n = std::snprintf(buffer, sizeof(buffer), fixed ? "%.*f" : "%.*g", precision, value);
+    if (n < 0) return;
+    n = std::min(n, int(sizeof(buffer)) - 1);
+    const char point = *std::localeconv()->decimal_point;
+    for (int i = 0; i < n; ++i) {
+        if (buffer[i] == point) buffer[i] = '.';
+    }
+    out.append(buffer, std::size_t(n));
+}
+
+} // namespace
+
+void appendNumber(std::string &out, double value, int decimals) {
+    if (decimals < 0) {
+        appendFormatted(out, value, false, 6);
+    } else {
+        appendFormatted(out, value, true, decimals);
+    }
+}
+
+void appendGeneral(std::string &out, double value, int significant) {
+    appendFormatted(out, value, false, significant);
+}
+
+bool parseNumber(const char *begin, const char *end, double &value) {
+    trim(begin, end);
+    if (begin != end && *begin == '+') ++begin;
+    if (begin == end) return false;
+#if defined(XLAT_HAVE_FROM_CHARS) && defined(__cpp_lib_to_chars)
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    // strtod wants the locale's decimal point, and a terminated copy
+    char buffer[64];
+    const std::size_t length = std::size_t(end - begin);
+    if (length >= sizeof(buffer)) return false;
+    const char point = *std::localeconv()->decimal_point;
+    for (std::size_t i = 0; i < length; ++i) {
+        buffer[i] = begin[i] == '.' ? point : begin[i];
+    }
+    buffer[length] = '\0';
+    char *parsed = nullptr;
+    errno = 0;
+    double result = std::strtod(buffer, &parsed);
+    if (parsed != buffer + length || errno == ERANGE) return false;
+    value = result;
+    return true;
+#endif
+}
+
+const CsvHeaderField *CaptureCsv::headerField(const std::string &label) const {
+    for (const CsvHeaderField &field : header) {
+        if (field.label == label) return &field;
+    }
+    return nullptr;
+}
+
+CsvReadStatus parseCaptureCsv(const char *data, std::size_t size, CaptureCsv &capture) {
+    capture = CaptureCsv();
+    // ~20 bytes per row, one reservation instead of a dozen regrowths
+    capture.samples.reserve(size / 20);
+    capture.hostTimesNs.reserve(size / 20);
+
+    Parser parser(capture);
+    const char *end = data + size;
+    const char *lineStart = data;
+    while (lineStart < end) {
+        const char *newline = static_cast<const char *>(std::memchr(lineStart, '\n', std::size_t(end - lineStart)));
+        const char *lineEnd = newline ? newline : end;
+        parser.line(lineStart, lineEnd);
+        lineStart = lineEnd + 1;
+    }
+    parser.finish();
+
+    return capture.errorCount ? CsvReadStatus::ParseError : CsvReadStatus::Ok;
+}
+
+CsvReadStatus readCaptureCsv(const std::string &path, CaptureCsv &capture, std::string *openError) {
+    capture = CaptureCsv();
+
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        if (openError) *openError = std::strerror(errno);
+        return CsvReadStatus::OpenFailed;
+    }
+
+    std::vector<char> buffer;
+    char block[1 << 16];
+    std::size_t n;
+    while ((n = std::fread(block, 1, sizeof(block), file)) > 0) {
+        buffer.insert(buffer.end(), block, block + n);
+    }
+    bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed) {
+        if (openError) *openError = "read error";
+        return CsvReadStatus::OpenFailed;
+    }
+
+    return parseCaptureCsv(buffer.data(), buffer.size(), capture);
+}
+
+} // namespace xlat
@@ -0,0 +1,88 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_CSV_H
+#define XLAT_CSV_H
+
+#include "xlat_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xlat {
+
+enum class CsvReadStatus {
+    Ok,
+    OpenFailed,
+    ParseError // some lines were rejected, see CaptureCsv::errors
+};
+
+// One "label: value" line of the metric block saveCSV() writes above the
+// samples. Bootstrap lines carry an interval, "p5 95% CI: 10 - 12".
+struct CsvHeaderField {
+    std::string label;
+    std::string text;  // value as written
+    double value = 0.0; // NaN for text values such as the gap ranges
+    double high = 0.0; // upper bound, same as value unless an interval
+};
+
+struct CsvError {
+    std::size_t line; // 1-based
+    std::string message;
+};
+
+struct CaptureCsv {
+    std::vector<CsvHeaderField> header;
+    std::vector<xlatData> samples;
+    // Optional fifth column (host arrival time), empty for older exports or
+    // when not every row carries one
+    std::vector<std::int64_t> hostTimesNs;
+    // The first kMaxErrors rejected lines, errorCount has them all
+    std::vector<CsvError> errors;
+    std::size_t errorCount = 0;
+
+    static const std::size_t kMaxErrors = 100;
+
+    const CsvHeaderField *headerField(const std::string &label) const;
+};
+
+// Parses a capture exported by xlat_evtool::saveCSV() straight from its bytes.
+// Rows are converted in place with std::from_chars, nothing is allocated per
+// line. Bad lines are skipped and recorded with their line number, the rest
+// of the file is still read.
+CsvReadStatus parseCaptureCsv(const char *data, std::size_t size, CaptureCsv &capture);
+
+// Reads the whole file in one go, then parseCaptureCsv()
+CsvReadStatus readCaptureCsv(const std::string &path, CaptureCsv &capture, std::string *openError = nullptr);
+
+// Number text for the files the app writes, always with a '.' whatever the C
+// locale: `decimals` fixed places like QString::number(x, 'f', decimals), or
+// six significant digits like QString::number(x) when negative
+void appendNumber(std::string &out, double value, int decimals = -1);
+
+// Same for values that are read back, `significant` digits like "%.10g"
+void appendGeneral(std::string &out, double value, int significant = 10);
+
+// Whole-field number as appendNumber()/appendGeneral() write it, exponent
+// allowed, whatever the C locale. False leaves `value` untouched.
+bool parseNumber(const char *begin, const char *end, double &value);
+
+} // namespace xlat
+
+#endif // XLAT_CSV_H
@@ -0,0 +1,133 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_density.h"
+#include "xlat_parallel.h"
+#include "xlat_samplestore.h"
+#include <algorithm>
+
+namespace xlat {
+
+namespace {
+
+struct Extent {
+    double xMin;
+    double xMax;
+};
+
+Extent segmentExtent(const SegmentSummary &segment, DensityAxis axis, std::int64_t origin) {
+    if (axis == DensityAxis::ReportNumber) {
+        return { double(std::min(segment.firstReport, segment.lastReport)),
+                 double(std::max(segment.firstReport, segment.lastReport)) };
+    }
+    return { double(segment.firstHostTime - origin) / 1e9, double(segment.lastHostTime - origin) / 1e9 };
+}
+
+} // namespace
+
+DensityView fullDensityView(const SampleStore &store, DensityAxis axis) {
+    DensityView view;
+    const std::vector<SegmentSummary> segments = store.segments();
+    if (segments.empty()) return view;
+
+    const std::int64_t origin = store.hostTimeOrigin();
+    Extent first = segmentExtent(segments.front(), axis, origin);
+    view.xMin = first.xMin;
+    view.xMax = first.xMax;
+    view.yMin = segments.front().minLatency;
+    view.yMax = segments.front().maxLatency;
+    for (const SegmentSummary &segment : segments) {
+        Extent e = segmentExtent(segment, axis, origin);
+        view.xMin = std::min(view.xMin, e.xMin);
+        view.xMax = std::max(view.xMax, e.xMax);
+        view.yMin = std::min(view.yMin, double(segment.minLatency));
+        view.yMax = std::max(view.yMax, double(segment.maxLatency));
+    }
+    // Upper edges inclusive, and never a zero-width axis
+    view.xMax += 1.0;
+    view.yMax += 1.0;
+    return view;
+}
+
+DensityGrid binDensity(const SampleStore &store, DensityAxis axis, const DensityView &view, int columns, int rows) {
+    DensityGrid grid;
+    grid.columns = std::max(columns, 1);
+    grid.rows = std::max(rows, 1);
+    grid.view = view;
+    const std::size_t cells = std::size_t(grid.columns) * std::size_t(grid.rows);
+    grid.counts.assign(cells, 0);
+    if (!(view.xMax > view.xMin) || !(view.yMax > view.yMin)) return grid;
+
+    // Host time ordering isn't guaranteed across imported files, so a chunk is
+    // only skipped on a summary that can't overlap the view
+    const std::int64_t origin = store.hostTimeOrigin();
+    const std::vector<SegmentSummary> segments = store.segments();
+    std::vector<std::size_t> chunks;
+    std::size_t visibleSamples = 0;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        Extent e = segmentExtent(segments[i], axis, origin);
+        if (e.xMax < view.xMin || e.xMin >= view.xMax
+            || segments[i].maxLatency < view.yMin || segments[i].minLatency >= view.yMax) {
+            continue;
+        }
+        chunks.push_back(i);
+        visibleSamples += segments[i].count;
+    }
+
+    const double xScale = grid.columns / (view.xMax - view.xMin);
+    const double yScale = grid.rows / (view.yMax - view.yMin);
+    const bool timed = axis == DensityAxis::HostTime;
+
+    // Per-worker grids are merged at the end; their count is capped so the
+    // scratch memory stays a few times the image size
+    const unsigned workers = std::min(workerCount(visibleSamples, 1 << 18), 8u);
+    std::vector<std::vector<std::uint32_t>> partial(workers);
+    std::vector<std::uint64_t> inside(workers, 0);
+    parallelChunks(chunks.size(), workers, [&](std::size_t begin, std::size_t end, unsigned worker) {
+        std::vector<std::uint32_t> &counts = partial[worker];
+        counts.assign(cells, 0);
+        std::vector<xlatData> samples(SampleStore::kChunkSize);
+        std::vector<std::int64_t> times(timed ? SampleStore::kChunkSize : 0);
+        for (std::size_t c = begin; c < end; ++c) {
+            std::size_t n = store.readChunk(chunks[c], samples.data(), timed ? times.data() : nullptr);
+            for (std::size_t i = 0; i < n; ++i) {
+                double x = timed ? double(times[i] - origin) / 1e9 : double(samples[i].reportNumber);
+                double y = samples[i].latency;
+                if (x < view.xMin || x >= view.xMax || y < view.yMin || y >= view.yMax) continue;
+                int column = std::min(int((x - view.xMin) * xScale), grid.columns - 1);
+                int row = std::min(int((y - view.yMin) * yScale), grid.rows - 1);
+                ++counts[std::size_t(row) * std::size_t(grid.columns) + std::size_t(column)];
+                ++inside[worker];
+            }
+        }
+    });
+
+    // Sum the partial grids, split by cell range
+    parallelChunks(cells, std::min(workers, workerCount(cells)), [&](std::size_t begin, std::size_t end, unsigned) {
+        for (const auto &counts : partial) {
+            if (counts.empty()) continue;
+            for (std::size_t i = begin; i < end; ++i) grid.counts[i] += counts[i];
+        }
+    });
+
+    for (std::size_t i = 0; i < cells; ++i) grid.maxCount = std::max(grid.maxCount, grid.counts[i]);
+    for (std::uint64_t n : inside) grid.samples += n;
+    return grid;
+}
+
+} // namespace xlat
@@ -0,0 +1,66 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_DENSITY_H
+#define XLAT_DENSITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xlat {
+
+class SampleStore;
+
+enum class DensityAxis {
+    ReportNumber,
+    HostTime // seconds since the first report
+};
+
+// Visible region, x in DensityAxis units and y in us of latency
+struct DensityView {
+    double xMin = 0.0;
+    double xMax = 0.0;
+    double yMin = 0.0;
+    double yMax = 0.0;
+};
+
+// Sample counts over a columns x rows grid; row 0 is the lowest latency
+struct DensityGrid {
+    int columns = 0;
+    int rows = 0;
+    DensityView view;
+    std::vector<std::uint32_t> counts;
+    std::uint32_t maxCount = 0;
+    std::uint64_t samples = 0; // inside the view
+
+    std::uint32_t at(int column, int row) const { return counts[std::size_t(row) * std::size_t(columns) + std::size_t(column)]; }
+};
+
+// Whole capture, from the resident segment summaries only
+DensityView fullDensityView(const SampleStore &store, DensityAxis axis);
+
+// Bins every sample inside `view`. Chunks whose summaries fall outside it are
+// skipped without being read, so zooming in costs less than the full view.
+// The rest is split across worker threads, each with its own grid. Must not
+// run concurrently with SampleStore::append().
+DensityGrid binDensity(const SampleStore &store, DensityAxis axis, const DensityView &view, int columns, int rows);
+
+} // namespace xlat
+
+#endif // XLAT_DENSITY_H
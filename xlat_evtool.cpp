@@ -18,19 +18,36 @@
 
 #include "xlat_evtool.h"
 #include "ui_xlat_evtool.h"
+#include "catalogwindow.h"
+#include "chartrenderer.h"
+#include "comparisonwindow.h"
+#include "densitywindow.h"
+#include "distributionwindow.h"
+#include "earlystopdialog.h"
+#include "outlierdialog.h"
+#include "renderchartsdialog.h"
+#include "samplefilterdialog.h"
+#include "timelinewindow.h"
+#include "timingdialog.h"
+#include "xlat_alloctrack.h"
+#include "xlat_archive.h"
+#include "xlat_columnar.h"
+#include "xlat_csv.h"
 #include "qserialport.h"
 #include <QDebug>
 #include <QtCharts>
 #include <QCoreApplication>
+#include <QApplication>
 #include <QtCharts/QChartView>
 #include <QtCharts/QScatterSeries>
 #include <QtCharts/QValueAxis>
 #include <QAbstractAxis>
 #include <QString>
-#include <QStandardItemModel>
+#include <QDir>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QPushButton>
 #include <algorithm> // for std::sort
 #include <cmath>     // for std::round
@@ -43,12 +60,19 @@
 #include <QDesktopServices> // for github logo (https://github.com/logos)
 #include <QUrl> // for github logo
 #include <QDialog> // brand ownership disclaimer
+#include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QColor>
+#include <QMenu>
+#include <QAction>
+#include <QInputDialog>
+#include <QDateTime>
 
 xlat_evtool::xlat_evtool(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::xlat_evtool)
+    , session(QFile::encodeName(QDir::temp().filePath(
+          QString("xlat-evtool-%1.spill").arg(QCoreApplication::applicationPid()))).toStdString())
 {
     ui->setupUi(this);
 
@@ -72,34 +96,50 @@ xlat_evtool::xlat_evtool(QWidget *parent)
     vidLineEdit = findChild<QLineEdit*>("vid");
     pidLineEdit = findChild<QLineEdit*>("pid");
 
+    typedef xlat::LatencyMetrics M;
+    metricFields = {
+        { M::indexOf<xlat::P90>(), p90LineEdit, &xlat::BootstrapIntervals::p90, 9 },
+        { M::indexOf<xlat::P95>(), p95LineEdit, &xlat::BootstrapIntervals::p95, 11 },
+        { M::indexOf<xlat::InterquartileRange>(), iqrLineEdit, &xlat::BootstrapIntervals::iqr, 5 },
+        { M::indexOf<xlat::P5>(), p5LineEdit, &xlat::BootstrapIntervals::p5, 0 },
+        { M::indexOf<xlat::P10>(), p10LineEdit, &xlat::BootstrapIntervals::p10, 0 },
+        { M::indexOf<xlat::MaxLatency>(), maxLatLineEdit, nullptr, 0 },
+        { M::indexOf<xlat::MinLatency>(), minLatLineEdit, nullptr, 0 },
+        { M::indexOf<xlat::MedianLatency>(), medLatLineEdit, &xlat::BootstrapIntervals::median, 0 },
+        { M::indexOf<xlat::MeanLatency>(), avgLatLineEdit, &xlat::BootstrapIntervals::avgLatency, 0 },
+        { M::indexOf<xlat::StandardDeviation>(), stdevLineEdit, nullptr, 0 },
+        { M::indexOf<xlat::MeanAbsoluteDeviation>(), avgMadLineEdit, nullptr, 0 },
+    };
+
     LedWidget *vcomStatus = findChild<LedWidget*>("vcomStatus");
     tableView = findChild<QTableView*>("tableView");
+    model = new SampleTableModel(allData, outlierDetector, this);
+    tableView->setModel(model);
 
-    // Initialize the serial port
-    serialPort = new QSerialPort(this);
-
-    foreach(const QSerialPortInfo &port, QSerialPortInfo::availablePorts()) {
-        if (port.isValid() && !port.isBusy()) {
-            serialPort->setPortName(port.portName());
-            break;
-        }
-    }
-
-    serialPort->setBaudRate(QSerialPort::Baud1m);
+    // The serial port lives on its own thread, the port itself is picked by the first scan
+    serialReader = new SerialReader();
+    serialReader->moveToThread(&serialThread);
+    connect(&serialThread, &QThread::finished, serialReader, &QObject::deleteLater);
+    connect(serialReader, &SerialReader::portScanned, this, &xlat_evtool::serialPortScanned);
+    connect(serialReader, &SerialReader::portOpened, this, &xlat_evtool::serialPortOpened);
+    connect(serialReader, &SerialReader::dataRead, this, &xlat_evtool::readSerialData);
+    connect(serialReader, &SerialReader::portLost, this, &xlat_evtool::serialPortLost);
+    serialThread.start();
 
-    serialPort->setDataBits(QSerialPort::Data8);
-    serialPort->setStopBits(QSerialPort::TwoStop);
-    serialPort->setParity(QSerialPort::NoParity);
-    serialPort->setFlowControl(QSerialPort::HardwareControl);
+    intervalRefreshTimer->setSingleShot(true);
+    intervalRefreshTimer->setInterval(1000);
+    connect(intervalRefreshTimer, &QTimer::timeout, this, &xlat_evtool::refreshConfidenceIntervals);
 
-    connect(serialPort, &QSerialPort::readyRead, this, &xlat_evtool::readSerialData);
+    storageStatusTimer->setInterval(1000);
+    connect(storageStatusTimer, &QTimer::timeout, this, &xlat_evtool::updateStorageStatus);
+    storageStatusTimer->start();
 
-    connect(serialPort, QOverload<QSerialPort::SerialPortError>::of(&QSerialPort::errorOccurred),
-            this, &xlat_evtool::handleError);
+    metricsPublishTimer->setInterval(500);
+    connect(metricsPublishTimer, &QTimer::timeout, this, &xlat_evtool::publishMetrics);
 
     connect(connectionCheckTimer, &QTimer::timeout, this, &xlat_evtool::checkConnectionStatus);
     connectionCheckTimer->start(1000);
-    checkConnectionStatus();
+    checkConnectionStatus(); // returns at once, the port opens when the scan is done
 
     connect(ui->csvSaving, &QPushButton::clicked, this, &xlat_evtool::saveCSV);
 
@@ -111,12 +151,16 @@ xlat_evtool::xlat_evtool(QWidget *parent)
     QString pngPath = executablePath + "/logo.png";
 
     QPushButton *github = findChild<QPushButton*>("github");
-    QIcon icon(pngPath); // Replace ":/github_logo.png" with the actual path to your GitHub logo resource
-        github->setIcon(icon);
         github->setIconSize(QSize(64, 64));
         github->setFlat(true);
         connect(github, &QPushButton::clicked, this, &xlat_evtool::openGitHubLink);
 
+    // The logo is read from disk once the window is up
+    QTimer::singleShot(0, github, [github, pngPath] {
+        QIcon icon(pngPath); // Replace ":/github_logo.png" with the actual path to your GitHub logo resource
+        github->setIcon(icon);
+    });
+
     QPushButton *ownership = findChild<QPushButton*>("xlatDisclaimer");
     ownership->setFlat(true);
     connect(ownership, &QPushButton::clicked, this, &xlat_evtool::disclaimer);
@@ -127,70 +171,65 @@ xlat_evtool::xlat_evtool(QWidget *parent)
     // Distribution Bar Plot
     connect(ui->visualizeChart_2, &QPushButton::clicked, this, &xlat_evtool::showHistogramWindow);
 
+    initializeMenus();
 
 }
 
 xlat_evtool::~xlat_evtool()
 {
+    // The server thread reads metricsSnapshots, it has to be gone before our members are
+    metricsServer->stop();
+    // The reader, and with it the port, is deleted when its thread finishes.
+    // A scan still running posts its result to us, wait for it before we go away.
+    serialThread.quit();
+    serialThread.wait();
     delete ui;
-    if (serialPort->isOpen()) {
-        serialPort->close();
-    }
 }
 
 
 void xlat_evtool::initializeUI() {
 
-    QString headerStyleSheet = "QMainWindow::title { background-color: rgb(31, 32, 41); color: rgb(101, 162, 133); }";
-    this->setStyleSheet(headerStyleSheet);
-
-    this->setStyleSheet("background-color: rgb(31, 32, 41); color: rgb(101, 162, 133);");
-
-    QString buttonStyle = "background-color: rgb(61, 62, 71); color: rgb(101, 162, 133);";
-        ui->csvSaving->setStyleSheet(buttonStyle);
-        ui->csvImport->setStyleSheet(buttonStyle);
-        ui->clearAll->setStyleSheet(buttonStyle);
-        ui->visualizeChart_2->setStyleSheet(buttonStyle);
-        ui->visualizeChart->setStyleSheet(buttonStyle);
-
-    QString groupBoxStyle = "QGroupBox { border: 2px solid rgb(101, 162, 133); }"; // Border color for group boxes
-        ui->groupBox->setStyleSheet(groupBoxStyle);
-        ui->groupBox_2->setStyleSheet(groupBoxStyle);
-        ui->groupBox_3->setStyleSheet(groupBoxStyle);
-        ui->groupBox_6->setStyleSheet(groupBoxStyle);
-
-     QString headerStyle = "QHeaderView::section { background-color: rgb(41, 42, 51); color: rgb(101, 162, 133); }";
-     ui->tableView->horizontalHeader()->setStyleSheet(headerStyle);
-     ui->tableView->verticalHeader()->setStyleSheet(headerStyle);
-
-     QString scrollBarStyle =
-         "QScrollBar:vertical {"
-         "    border: none;"
-         "    background-color: #000000;"
-         "    width: 20px;"
-         "    margin: 22px 0 22px 0;"
-         "}"
-         "QScrollBar::handle:vertical {"
-         "    background-color: #32CC99;"
-         "    min-height: 25px;"
-         "}"
-         "QScrollBar::add-line:vertical {"
-         "    background-color: #32CC99;"
-         "    height: 20px;"
-         "    subcontrol-position: bottom;"
-         "    subcontrol-origin: margin;"
-         "}"
-         "QScrollBar::sub-line:vertical {"
-         "    background-color: #32CC99;"
-         "    height: 20px;"
-         "    subcontrol-position: top;"
-         "    subcontrol-origin: margin;"
-         "}"
-         "QScrollBar::add-page:vertical, QScrollBar::sub-page:vertical {"
-         "    background: none;"
-         "}";
-
-    ui->tableView->verticalScrollBar()->setStyleSheet(scrollBarStyle);
+    // One style sheet for the whole window, each setStyleSheet() call re-polishes
+    // every widget below it
+    QString buttonStyle = "{ background-color: rgb(61, 62, 71); color: rgb(101, 162, 133); }";
+    QString groupBoxStyle = "{ border: 2px solid rgb(101, 162, 133); }"; // Border color for group boxes
+    QString headerStyle = "{ background-color: rgb(41, 42, 51); color: rgb(101, 162, 133); }";
+
+    QString styleSheet =
+        "* { background-color: rgb(31, 32, 41); color: rgb(101, 162, 133); }"
+        "QPushButton#csvSaving, QPushButton#csvImport, QPushButton#clearAll,"
+        "QPushButton#visualizeChart_2, QPushButton#visualizeChart " + buttonStyle +
+        "QGroupBox#groupBox, QGroupBox#groupBox_2, QGroupBox#groupBox_3, QGroupBox#groupBox_6 " + groupBoxStyle +
+        "QTableView#tableView QHeaderView::section " + headerStyle;
+
+    QString scrollBarStyle =
+        "QTableView#tableView QScrollBar:vertical {"
+        "    border: none;"
+        "    background-color: #000000;"
+        "    width: 20px;"
+        "    margin: 22px 0 22px 0;"
+        "}"
+        "QTableView#tableView QScrollBar::handle:vertical {"
+        "    background-color: #32CC99;"
+        "    min-height: 25px;"
+        "}"
+        "QTableView#tableView QScrollBar::add-line:vertical {"
+        "    background-color: #32CC99;"
+        "    height: 20px;"
+        "    subcontrol-position: bottom;"
+        "    subcontrol-origin: margin;"
+        "}"
+        "QTableView#tableView QScrollBar::sub-line:vertical {"
+        "    background-color: #32CC99;"
+        "    height: 20px;"
+        "    subcontrol-position: top;"
+        "    subcontrol-origin: margin;"
+        "}"
+        "QTableView#tableView QScrollBar::add-page:vertical, QTableView#tableView QScrollBar::sub-page:vertical {"
+        "    background: none;"
+        "}";
+
+    this->setStyleSheet(styleSheet + scrollBarStyle);
 
     // Tooltips for IQR and MAD
     ui->label_8->setToolTip("Median Absolute Deviation (MAD) is a robust measure of variability that is less influenced by outliers compared to Standard Deviation. MAD is computed as the median of the absolute deviations from the dataset's median, contrasting with STDEV, which calculates the average distance of data points from the mean and is typically applied to symmetric distributions.");
@@ -205,156 +244,232 @@ void xlat_evtool::initializeUI() {
 
 }
 
+void xlat_evtool::initializeMenus() {
 
-void xlat_evtool::checkAndOpenSerialPort() {
-    if (!serialPort->isOpen()) {
-        // Iterate through available serial ports
-        foreach(const QSerialPortInfo &port, QSerialPortInfo::availablePorts()) {
-            // Check if the port is open
-            if (port.isValid() && !port.isBusy()) {
-                // Set the port name to the first open port found
-                serialPort->setPortName(port.portName());
-
-                // Retrieve port information
-                QSerialPortInfo portInfo(port.portName());
-                // Update line edits with port information
-                portNameLineEdit->setText(portInfo.portName());
-                descriptionLineEdit->setText(portInfo.description());
-                serialNumberLineEdit->setText(portInfo.serialNumber());
-                manufacturerLineEdit->setText(portInfo.manufacturer());
-
-                QString vidString = QString::number(portInfo.vendorIdentifier(), 16);
-                QString pidString = QString::number(portInfo.productIdentifier(), 16);
-                vidLineEdit->setText(vidString);
-                pidLineEdit->setText(pidString);
-
-                // Break the loop after finding and setting port information
-                break;
-            }
-        }
+    QMenu *analysisMenu = ui->menubar->addMenu("Analysis");
 
-        // If no open port is found, use a default port (COM5)
-        if (serialPort->portName().isEmpty()) {
-            serialPort->setPortName("COM5");
-
-            // Set line edits to indicate default port
-            portNameLineEdit->setText("Connection Unavailable");
-            descriptionLineEdit->setText("Connection Unavailable");
-            serialNumberLineEdit->setText("Connection Unavailable");
-            manufacturerLineEdit->setText("Connection Unavailable");
-            vidLineEdit->setText("N/A");
-            pidLineEdit->setText("N/A");
-        }
+    QAction *catalogAction = analysisMenu->addAction("Session Catalog...");
+    connect(catalogAction, &QAction::triggered, this, &xlat_evtool::showCatalogWindow);
 
-        // Try to open the serial port
-        if (serialPort->open(QIODevice::ReadOnly)) {
-            // Serial port opened successfully
-            ui->vcomStatus->setColor(Qt::green);
+    QAction *compareAction = analysisMenu->addAction("Compare Sessions...");
+    connect(compareAction, &QAction::triggered, this, &xlat_evtool::showComparisonWindow);
 
-            // Enable line edits
-            portNameLineEdit->setEnabled(true);
-            descriptionLineEdit->setEnabled(true);
-            serialNumberLineEdit->setEnabled(true);
-            manufacturerLineEdit->setEnabled(true);
-        } else {
-            // Failed to open serial port
-            qWarning() << "Failed to open serial port:" << serialPort->errorString();
-            ui->vcomStatus->setColor(Qt::red);
-
-            // Set line edits to indicate connection unavailable
-            portNameLineEdit->setEnabled(false);
-            descriptionLineEdit->setEnabled(false);
-            serialNumberLineEdit->setEnabled(false);
-            manufacturerLineEdit->setEnabled(false);
-        }
+    QAction *renderAction = analysisMenu->addAction("Render Charts...");
+    connect(renderAction, &QAction::triggered, this, &xlat_evtool::showRenderChartsDialog);
+
+    QAction *metricsTableAction = analysisMenu->addAction("All Metrics...");
+    connect(metricsTableAction, &QAction::triggered, this, &xlat_evtool::showAllMetrics);
+
+    QAction *bootstrapAction = analysisMenu->addAction("Confidence Intervals...");
+    connect(bootstrapAction, &QAction::triggered, this, &xlat_evtool::configureBootstrap);
+
+    QAction *outlierAction = analysisMenu->addAction("Outliers...");
+    connect(outlierAction, &QAction::triggered, this, &xlat_evtool::showOutlierDialog);
+
+    QAction *filterAction = analysisMenu->addAction("Filter Samples...");
+    connect(filterAction, &QAction::triggered, this, &xlat_evtool::showSampleFilterDialog);
+
+    QAction *distributionAction = analysisMenu->addAction("Distribution (ECDF / Percentiles)...");
+    connect(distributionAction, &QAction::triggered, this, &xlat_evtool::showDistributionWindow);
+
+    QAction *densityAction = analysisMenu->addAction("Density Map...");
+    connect(densityAction, &QAction::triggered, this, &xlat_evtool::showDensityWindow);
+
+    QAction *timelineAction = analysisMenu->addAction("Stats Timeline...");
+    connect(timelineAction, &QAction::triggered, this, &xlat_evtool::showTimelineWindow);
+
+    QAction *earlyStopAction = analysisMenu->addAction("Early Stop...");
+    connect(earlyStopAction, &QAction::triggered, this, &xlat_evtool::configureEarlyStop);
+
+    QAction *timingAction = analysisMenu->addAction("Report Timing...");
+    connect(timingAction, &QAction::triggered, this, &xlat_evtool::showTimingDialog);
+
+    QAction *metricsAction = analysisMenu->addAction("Metrics Endpoint...");
+    connect(metricsAction, &QAction::triggered, this, &xlat_evtool::configureMetricsEndpoint);
+
+    // Only in builds with CONFIG+=alloc_tracking
+    if (xlat::allocTrackingEnabled()) {
+        QAction *allocAction = analysisMenu->addAction("Allocation Profile...");
+        connect(allocAction, &QAction::triggered, this, &xlat_evtool::showAllocationProfile);
     }
+
+    timingLabel = new QLabel();
+    ui->statusbar->addPermanentWidget(timingLabel);
+    updateTimingStatus();
+
+    storageLabel = new QLabel();
+    ui->statusbar->addPermanentWidget(storageLabel);
+    updateStorageStatus();
+
+    outlierLabel = new QLabel();
+    ui->statusbar->addPermanentWidget(outlierLabel);
+    updateOutlierStatus();
+
+    filterLabel = new QLabel();
+    ui->statusbar->addPermanentWidget(filterLabel);
+    updateFilterStatus();
+
+    earlyStopLabel = new QLabel();
+    ui->statusbar->addPermanentWidget(earlyStopLabel);
+    updateEarlyStopStatus();
 }
 
-void xlat_evtool::checkConnectionStatus() {
-    checkAndOpenSerialPort();
+
+void xlat_evtool::checkAndOpenSerialPort() {
+    if (serialPortOpen || portScanRunning) {
+        return;
+    }
+
+    // Enumerate, probe and open off the GUI thread, the results come back as queued signals
+    portScanRunning = true;
+    QMetaObject::invokeMethod(serialReader, &SerialReader::connectPort, Qt::QueuedConnection);
 }
 
-void xlat_evtool::handleError(QSerialPort::SerialPortError error) {
-    if (error == QSerialPort::ResourceError) {
+void xlat_evtool::serialPortScanned(const QSerialPortInfo& port, bool found, bool fallback) {
 
-        //qDebug() << "Serial port disconnected.";
+    if (startupTimer.isValid()) {
+        qint64 portsMs = startupTimer.elapsed();
+        startupTimer.invalidate();
+        if (startupEventLoopMs < 0) {
+            startupEventLoopMs = portsMs; // the scan beat the first timer
+        }
+        QString text = "Startup: window " + QString::number(startupWindowMs) + " ms, event loop "
+                     + QString::number(startupEventLoopMs) + " ms, port scan " + QString::number(portsMs) + " ms";
+        qInfo().noquote() << text;
+        ui->statusbar->showMessage(text, 10000);
+        if (exitAfterStartup) {
+            QCoreApplication::exit(0);
+            return;
+        }
+    }
 
-        ui->vcomStatus->setColor(Qt::red);
+    if (found) {
+        // Update line edits with port information
+        portNameLineEdit->setText(port.portName());
+        descriptionLineEdit->setText(port.description());
+        serialNumberLineEdit->setText(port.serialNumber());
+        manufacturerLineEdit->setText(port.manufacturer());
+
+        QString vidString = QString::number(port.vendorIdentifier(), 16);
+        QString pidString = QString::number(port.productIdentifier(), 16);
+        vidLineEdit->setText(vidString);
+        pidLineEdit->setText(pidString);
+    }
 
+    if (fallback) {
+        // Set line edits to indicate default port
         portNameLineEdit->setText("Connection Unavailable");
         descriptionLineEdit->setText("Connection Unavailable");
         serialNumberLineEdit->setText("Connection Unavailable");
         manufacturerLineEdit->setText("Connection Unavailable");
         vidLineEdit->setText("N/A");
         pidLineEdit->setText("N/A");
-
-        // Attempt to reconnect the serial port
-        serialPort->close();
-        checkAndOpenSerialPort();
-
-        // Restart the timer
-        connectionCheckTimer->start(1000);
     }
 }
 
+void xlat_evtool::serialPortOpened(bool ok, const QString &error) {
+    portScanRunning = false;
+    serialPortOpen = ok;
 
-void xlat_evtool::readSerialData() {
+    if (ok) {
+        // Serial port opened successfully
+        ui->vcomStatus->setColor(Qt::green);
 
-    checkAndOpenSerialPort();
+        // Enable line edits
+        portNameLineEdit->setEnabled(true);
+        descriptionLineEdit->setEnabled(true);
+        serialNumberLineEdit->setEnabled(true);
+        manufacturerLineEdit->setEnabled(true);
+    } else {
+        // Failed to open serial port
+        qWarning() << "Failed to open serial port:" << error;
+        ui->vcomStatus->setColor(Qt::red);
 
-    QByteArray data = serialPort->readAll();
+        // Set line edits to indicate connection unavailable
+        portNameLineEdit->setEnabled(false);
+        descriptionLineEdit->setEnabled(false);
+        serialNumberLineEdit->setEnabled(false);
+        manufacturerLineEdit->setEnabled(false);
+    }
+}
 
-    // Emit a signal containing the raw serial port input
-    emit serialDataReceived(data);
+void xlat_evtool::checkConnectionStatus() {
+    checkAndOpenSerialPort();
+    checkEarlyStopTimeLimit();
+}
 
-    // Converting QByteArray to QString
-    QString dataString(data);
+void xlat_evtool::serialPortLost() {
 
-    // Parsing logic
-    QStringList dataList = dataString.split(';');
+    //qDebug() << "Serial port disconnected.";
+    serialPortOpen = false;
 
-    if (dataList.size() >= 4) {
+    ui->vcomStatus->setColor(Qt::red);
 
-        myData.reportNumber = dataList[0].toInt();
-        myData.latency = dataList[1].toInt();
-        myData.avgLatency = dataList[2].toInt();
-        myData.stdev = dataList[3].toInt();
+    portNameLineEdit->setText("Connection Unavailable");
+    descriptionLineEdit->setText("Connection Unavailable");
+    serialNumberLineEdit->setText("Connection Unavailable");
+    manufacturerLineEdit->setText("Connection Unavailable");
+    vidLineEdit->setText("N/A");
+    pidLineEdit->setText("N/A");
 
-        /*
-        // Print the parsed xlatData using qDebug
-        qDebug() << "Parsed xlatData:";
-        qDebug() << "Report Number:" << myData.reportNumber;
-        qDebug() << "Latency:" << myData.latency;
-        qDebug() << "Average Latency:" << myData.avgLatency;
-        qDebug() << "Standard Deviation:" << myData.stdev;
-        */
+    // Attempt to reconnect the serial port
+    checkAndOpenSerialPort();
 
-        // Add myData to the allData vector
-        allData.push_back(myData);
-        dataInterpolation();
-        updateTableViewDynamic(myData);
-    }
+    // Restart the timer
+    connectionCheckTimer->start(1000);
 }
 
-void xlat_evtool::updateTableViewDynamic(const xlatData& newData) {
 
-    int row = allData.size() - 1; // Get the index of the last row
+void xlat_evtool::readSerialData(const QByteArray &data, qint64 readTimeNs) {
+
+    xlat::AllocScope readScope(xlat::AllocStage::Read);
+    xlat::noteAllocation(std::size_t(data.size())); // QByteArray buffers come from malloc()
+    if (captureStopped) {
+        return;
+    }
 
-    // Insert a new row at the end of the model
-    model->insertRow(row);
+    // Emit a signal containing the raw serial port input
+    emit serialDataReceived(data);
 
-    // Populate the new row with data from newData
-    model->setItem(row, 0, new QStandardItem(QString::number(newData.reportNumber)));
-    model->setItem(row, 1, new QStandardItem(QString::number(newData.latency)));
-    model->setItem(row, 2, new QStandardItem(QString::number(newData.avgLatency)));
-    model->setItem(row, 3, new QStandardItem(QString::number(newData.stdev)));
+    std::size_t firstRow = allData.size();
+    std::size_t firstOutlier = outlierDetector.outliers().size();
+    session.pushBytes(data.constData(), std::size_t(data.size()), readTimeNs);
+
+    // Metrics are evaluated once per read, however many reports it carried
+    if (allData.size() != firstRow) {
+        const auto& outliers = outlierDetector.outliers();
+        {
+            xlat::AllocScope scope(xlat::AllocStage::Table);
+            for (std::size_t i = firstOutlier; i < outliers.size(); ++i) {
+                markOutlierRow(static_cast<int>(outliers[i].sampleIndex));
+            }
+            updateTableViewDynamic();
+        }
+        {
+            xlat::AllocScope scope(xlat::AllocStage::Evaluate);
+            dataInterpolation();
+        }
+        xlat::AllocScope scope(xlat::AllocStage::Status);
+        if (outliers.size() != firstOutlier) {
+            updateOutlierStatus();
+        }
+        updateTimingStatus();
+        checkEarlyStop(readTimeNs);
+    }
+}
 
-    // Set the model for the tableView
-    tableView->setModel(model);
-    //tableView->resizeColumnsToContents();  //Morte a chi ha creato questa funzione.
+void xlat_evtool::updateTableViewDynamic() {
 
-    // Scroll to the bottom to show the latest entry
-    tableView->scrollToBottom();
+    // The model formats rows on demand, only the new row count is announced
+    model->samplesAppended();
+
+    // Scroll to the bottom to show the latest entry, unless a sorted view is being read
+    if (model->filter().order == xlat::SampleOrder::Capture) {
+        tableView->scrollToBottom();
+    }
+    if (model->isFiltered()) {
+        updateFilterStatus();
+    }
     tableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed); // Column 0 has a fixed size
     tableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch); // Column 1 will stretch to fill available space
     tableView->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Fixed); // Column 2 has a fixed size
@@ -364,14 +479,9 @@ void xlat_evtool::updateTableViewDynamic(const xlatData& newData) {
 
 void xlat_evtool::updateTableView() {
 
-    // Loading allData vector in model
-    for (int row = 0; row < allData.size(); ++row) {
-        model->setItem(row, 0, new QStandardItem(QString::number(allData[row].reportNumber)));
-        model->setItem(row, 1, new QStandardItem(QString::number(allData[row].latency)));
-        model->setItem(row, 2, new QStandardItem(QString::number(allData[row].avgLatency)));
-        model->setItem(row, 3, new QStandardItem(QString::number(allData[row].stdev)));
-    }
-    tableView->setModel(model);
+    // Whole capture changed (import, rescan), outlier rows come from the detector
+    model->reload();
+    updateFilterStatus();
 
     tableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed); // Column 0 has a fixed size
     tableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch); // Column 1 will stretch to fill available space
@@ -381,34 +491,319 @@ void xlat_evtool::updateTableView() {
     tableView->scrollToBottom();
 }
 
+void xlat_evtool::markOutlierRow(int row) {
+
+    model->outlierMarked(row);
+}
+
+void xlat_evtool::updateOutlierStatus() {
+
+    const auto& outliers = outlierDetector.outliers();
+    if (outliers.empty()) {
+        outlierLabel->setText("Outliers: 0");
+        return;
+    }
+
+    const xlat::OutlierRecord& last = outliers.back();
+    outlierLabel->setText("Outliers: " + QString::number(outliers.size())
+                          + "  (last: report " + QString::number(last.reportNumber)
+                          + ", latency " + QString::number(last.latency)
+                          + ", " + OutlierDialog::describeRules(last.rules) + ")");
+}
+
+void xlat_evtool::showSampleFilterDialog() {
+
+    SampleFilterDialog dialog(model->filter(), this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    model->setFilter(dialog.filter());
+    updateFilterStatus();
+    if (model->filter().order == xlat::SampleOrder::Capture) {
+        tableView->scrollToBottom();
+    } else {
+        tableView->scrollToTop();
+    }
+}
+
+void xlat_evtool::updateFilterStatus() {
+
+    if (!model->isFiltered()) {
+        filterLabel->setText("Filter: off");
+        return;
+    }
+    filterLabel->setText("Filter: " + QString::number(model->rowCount()) + " of "
+                         + QString::number(allData.size()) + " samples");
+}
+
+void xlat_evtool::showOutlierDialog() {
+
+    OutlierDialog dialog(outlierDetector.rules(), outlierDetector.outliers(), this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    // Past reports are re-classified against the whole capture with the new rules
+    outlierDetector.setRules(dialog.rules());
+    outlierDetector.scan(allData, latencyMetrics.histogram());
+    updateTableView();
+    updateOutlierStatus();
+}
+
+void xlat_evtool::updateTimingStatus() {
+
+    if (arrivalStats.reports() < 2) {
+        timingLabel->setText("Rate: -");
+        return;
+    }
+
+    QString text = "Rate: " + QString::number(arrivalStats.reportRate(), 'f', 1) + "/s"
+                 + "  Jitter: " + QString::number(arrivalStats.jitterUs(), 'f', 1) + " us";
+    if (recordParser.malformedLines()) {
+        text += "  Malformed: " + QString::number(recordParser.malformedLines());
+    }
+    if (sequenceTracker.missing()) {
+        text += "  Missing: " + QString::number(sequenceTracker.missing());
+    }
+    if (sequenceTracker.duplicates() || sequenceTracker.outOfOrder()) {
+        text += "  Dup/late: " + QString::number(sequenceTracker.duplicates()) + "/" + QString::number(sequenceTracker.outOfOrder());
+    }
+    timingLabel->setText(text);
+}
+
+void xlat_evtool::updateStorageStatus() {
+
+    QString text = "RAM: " + QString::number(allData.residentBytes() / 1048576.0, 'f', 1) + " MB";
+    std::uint64_t spilled = allData.spilledBytes();
+    if (spilled) {
+        text += ", spilled: " + QString::number(spilled / 1048576.0, 'f', 1) + " MB";
+    }
+    std::string error = allData.spillError();
+    if (!error.empty()) {
+        text += " (" + QString::fromStdString(error) + ")";
+    }
+    storageLabel->setText(text);
+}
+
+void xlat_evtool::showTimingDialog() {
+
+    xlat::DeviceCrossCheck check;
+    if (!allData.empty()) {
+        check = xlat::crossCheck(allData.back(), latencyMetrics.value<xlat::MeanLatency>(),
+                                 latencyMetrics.value<xlat::StandardDeviation>());
+    }
+    TimingDialog *dialog = new TimingDialog(arrivalStats, sequenceTracker, allData.empty() ? nullptr : &check, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
+void xlat_evtool::configureEarlyStop() {
+
+    EarlyStopDialog dialog(convergenceMonitor.settings(), this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    // New targets start from a clean slate, a stopped capture records again. The
+    // limits count from now, samples already captured don't use them up.
+    convergenceMonitor.setSettings(dialog.settings(), latencyMetrics.histogram().count());
+    earlyStopArmedNs = allData.empty() ? 0 : xlat::monotonicNowNs();
+    captureStopped = false;
+    updateEarlyStopStatus();
+}
+
+void xlat_evtool::checkEarlyStop(std::int64_t hostTimeNs) {
+
+    const xlat::EarlyStopSettings &settings = convergenceMonitor.settings();
+    if (!settings.enabled) {
+        return;
+    }
+
+    if (!earlyStopArmedNs) {
+        earlyStopArmedNs = hostTimeNs; // armed on an empty capture, the first sample starts the clock
+    }
+    double elapsed = double(hostTimeNs - earlyStopArmedNs) / 1e9;
+    xlat::StopReason reason = convergenceMonitor.update(latencyMetrics.histogram(), elapsed);
+    if (reason == xlat::StopReason::None) {
+        updateEarlyStopStatus();
+        return;
+    }
+
+    captureStopped = settings.stopCapture;
+    updateEarlyStopStatus();
+
+    QString text = reason == xlat::StopReason::Converged ? "Capture converged" : "Capture limit reached";
+    text += " after " + QString::number(allData.size()) + " samples";
+    if (!captureStopped) {
+        text += ", still recording";
+    }
+    ui->statusbar->showMessage(text);
+    QApplication::beep();
+    QApplication::alert(this);
+}
+
+// Samples drive checkEarlyStop(), this catches the time limit when the device
+// goes quiet or stalls
+void xlat_evtool::checkEarlyStopTimeLimit() {
+
+    const xlat::EarlyStopSettings &settings = convergenceMonitor.settings();
+    if (!settings.enabled || settings.maxSeconds <= 0.0 || !earlyStopArmedNs
+        || convergenceMonitor.reason() != xlat::StopReason::None) {
+        return;
+    }
+    checkEarlyStop(xlat::monotonicNowNs());
+}
+
+void xlat_evtool::updateEarlyStopStatus() {
+
+    const xlat::EarlyStopSettings &settings = convergenceMonitor.settings();
+    if (!settings.enabled) {
+        earlyStopLabel->clear();
+        earlyStopLabel->hide();
+        return;
+    }
+    earlyStopLabel->show();
+
+    const xlat::ConvergenceState &state = convergenceMonitor.state();
+    QString text;
+    switch (convergenceMonitor.reason()) {
+    case xlat::StopReason::Converged:   text = "Converged"; break;
+    case xlat::StopReason::SampleLimit: text = "Sample limit"; break;
+    case xlat::StopReason::TimeLimit:   text = "Time limit"; break;
+    case xlat::StopReason::None:        text = "Early stop"; break;
+    }
+    if (captureStopped) {
+        text += " (stopped)";
+    }
+    if (settings.p95CiWidthUs > 0.0) {
+        text += "  p95 CI: " + (state.p95CiWidthUs < 0.0 ? QString("-") : QString::number(state.p95CiWidthUs, 'f', 1))
+              + "/" + QString::number(settings.p95CiWidthUs, 'f', 1) + " us";
+    }
+    if (settings.medianDriftPercent > 0.0) {
+        text += "  Median drift: " + (state.medianDriftPercent < 0.0 ? QString("-") : QString::number(state.medianDriftPercent, 'f', 2))
+              + "/" + QString::number(settings.medianDriftPercent, 'f', 2) + "%";
+    }
+    // The state only moves every kCheckInterval samples, skip the no-op redraws
+    if (earlyStopLabel->text() != text) {
+        earlyStopLabel->setText(text);
+    }
+}
+
+void xlat_evtool::measureStartup(const QElapsedTimer& sinceLaunch, bool exitWhenDone) {
+
+    startupTimer = sinceLaunch;
+    startupWindowMs = startupTimer.elapsed();
+    exitAfterStartup = exitWhenDone;
+
+    // Runs on the first turn of the event loop, once show() has been processed
+    QTimer::singleShot(0, this, [this] {
+        startupEventLoopMs = startupTimer.isValid() ? startupTimer.elapsed() : startupWindowMs;
+    });
+}
+
+bool xlat_evtool::startMetricsEndpoint(const QString &address, QString *errorMessage) {
+
+    if (!metricsServer->start(address, errorMessage)) {
+        metricsPublishTimer->stop();
+        return false;
+    }
+    publishMetrics();
+    metricsPublishTimer->start();
+    return true;
+}
+
+void xlat_evtool::configureMetricsEndpoint() {
+
+    bool ok = false;
+    QString current = metricsServer->isRunning() ? metricsServer->address() : QString("127.0.0.1:9464");
+    QString address = QInputDialog::getText(this, "Metrics Endpoint",
+                                            "Serve /metrics (Prometheus) and /metrics.json on\n"
+                                            "127.0.0.1:<port> or unix:<socket path>, leave empty to stop:",
+                                            QLineEdit::Normal, current, &ok).trimmed();
+    if (!ok) {
+        return;
+    }
+
+    if (address.isEmpty()) {
+        metricsServer->stop();
+        metricsPublishTimer->stop();
+        return;
+    }
+
+    QString error;
+    if (!startMetricsEndpoint(address, &error)) {
+        QMessageBox::warning(this, "Metrics Endpoint", "Cannot listen on " + address + ": " + error);
+    }
+}
+
+void xlat_evtool::publishMetrics() {
+
+    // Runs on a timer, not per report: the server only ever sees finished snapshots
+    xlat::MetricsSnapshot snapshot = session.snapshot();
+    snapshot.sequence = ++metricsSequence;
+    snapshot.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    metricsSnapshots.publish(snapshot);
+}
+
 void xlat_evtool::saveCSV() {
 
-    QString filePath = QFileDialog::getSaveFileName(this, tr("Save CSV File"), "", tr("CSV Files (*.csv)"));
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Save CSV File"), "",
+                                                    tr("CSV Files (*.csv);;Compressed Captures (*.xlatc);;"
+                                                       "NumPy Arrays (*.npy);;NumPy Archives (*.npz);;Arrow IPC (*.arrow)"));
+
+    // Binary formats carry the samples only, metrics are recomputed from them
+    typedef bool (*BinaryWriter)(const std::string&, const xlat::SampleStore&, std::string*);
+    const struct { const char *suffix; BinaryWriter write; bool importable; } binaryFormats[] = {
+        { ".xlatc", xlat::writeCaptureArchive, true },
+        { ".npy", xlat::writeNpy, false },
+        { ".npz", xlat::writeNpz, false },
+        { ".arrow", xlat::writeArrowIpc, false },
+    };
+    for (const auto& format : binaryFormats) {
+        if (filePath.endsWith(format.suffix, Qt::CaseInsensitive)) {
+            std::string error;
+            if (!format.write(QFile::encodeName(filePath).toStdString(), allData, &error)) {
+                QMessageBox::critical(this, "Export Error", QString::fromStdString(error));
+            } else if (format.importable) {
+                saveSegmentTimeline(filePath);
+            }
+            return;
+        }
+    }
 
     if (!filePath.isEmpty()) {
         QFile file(filePath);
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&file);
 
-            // Adding data to CSVs, no need to use this program each time you want to see data
-            out << "Minimum Latency: " << QString::number(minLatency) << "\n";
-            out << "Maximum Latency: " << QString::number(maxLatency) << "\n";
-            out << "p5: " << QString::number(p5Value) << "\n";
-            out << "p10: " << QString::number(p10Value) << "\n";
-            out << "p90: " << QString::number(p90Value) << "\n";
-            out << "p95: " << QString::number(p95Value) << "\n";
-            out << "IQR: " << QString::number(iqrValue) << "\n";
-            out << "MAD: " << QString::number(madValue) << "\n";
-            out << "Average Latency: " << QString::number(avgLatency) << "\n";
-            out << "Median Latency: " << QString::number(medianLatency) << "\n";
-            out << "STDEV : " << QString::number(stdev) << "\n";
-            out << "\n";
-
-            for (const auto& data : allData) {
-                out << data.reportNumber << "," << data.latency << "," << data.avgLatency << "," << data.stdev << "\n";
-            }
+            // Adding data to CSVs, no need to use this program each time you want to see data.
+            // Fresh intervals, the live ones may lag behind by one refresh period.
+            session.evaluate();
+            xlat::BootstrapIntervals intervals = xlat::bootstrapIntervals(latencyMetrics.histogram(), bootstrapSettings);
+            out << QString::fromStdString(xlat::captureCsvHeader(session, intervals));
+
+            // Fifth column is the host arrival time in ns since the first report.
+            // Spilled chunks are paged back in one at a time.
+            const bool timed = allData.hasHostTimes();
+            const std::int64_t origin = allData.hostTimeOrigin();
+            const std::uint64_t readErrors = allData.readErrors();
+            allData.forEach([&](std::size_t, const xlatData& data, std::int64_t timestampNs) {
+                out << data.reportNumber << "," << data.latency << "," << data.avgLatency << "," << data.stdev;
+                if (timed) {
+                    out << "," << (timestampNs - origin);
+                }
+                out << "\n";
+            });
 
             file.close();
+            // Unreadable spilled chunks came back as zeros, don't leave them in a file
+            if (allData.readErrors() != readErrors) {
+                file.remove();
+                QMessageBox::critical(this, "Export Error", QString::fromStdString(allData.spillError()));
+                return;
+            }
+            saveSegmentTimeline(filePath);
 
             //qDebug() << "CSV file saved successfully at:" << filePath;
         } else {
@@ -417,58 +812,57 @@ void xlat_evtool::saveCSV() {
     }
 }
 
-void xlat_evtool::importCsv(const QString& filePath) {
+void xlat_evtool::importCapture(const QString& filePath) {
     clearData();
 
-    QFile file(filePath);
-
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-
-        in.readLine();
-
-        int row = 1;
+    const std::string path = QFile::encodeName(filePath).toStdString();
+    xlat::CaptureCsv capture;
+    std::string error;
 
-        while (!in.atEnd()) {
-            row++;
-            QString line = in.readLine();
-            QStringList fields = line.split(',');
-
-            // Ensure that there are enough fields, fails first 13 information fields
-            if (fields.size() >= 4) {
-                xlatData newData;
+    if (filePath.endsWith(".xlatc", Qt::CaseInsensitive)) {
+        xlat::CaptureArchive archive;
+        if (!archive.open(path, &error) || !archive.readAll(capture.samples, &capture.hostTimesNs, &error)) {
+            QMessageBox::critical(this, "Import Error", QString::fromStdString(error));
+            return;
+        }
+    } else if (xlat::readCaptureCsv(path, capture, &error) == xlat::CsvReadStatus::OpenFailed) {
+        qWarning() << "Failed to open file for reading:" << QString::fromStdString(error);
+        return;
+    }
 
-                // Check if each field can be converted to an integer
-                bool conversionError = false;
-                for (int i = 0; i < 4; ++i) {
-                    bool ok;
-                    fields[i].toInt(&ok);
-                    if (!ok) {
-                        QMessageBox::critical(nullptr, "Import Error", "Non-numeric data in field " + QString::number(i) + " of line " + QString::number(row));
-                        conversionError = true;
-                        break;
-                    }
-                }
+    const std::vector<xlatData>& imported = capture.samples;
+    session.pushCapture(imported, capture.hostTimesNs, false);
 
-                if (conversionError) {
-                    clearData();
-                    return;
-                }
+    // The timeline saved with the capture, if it still matches, else rebuilt on all cores
+    if (!segmentTimeline.load(QFile::encodeName(filePath + ".xlatseg").toStdString(), std::uint64_t(QFileInfo(filePath).size()), allData)) {
+        segmentTimeline.rebuild(allData, segmentTimeline.settings());
+    }
 
-                newData.reportNumber = fields[0].toInt();
-                newData.latency = fields[1].toInt();
-                newData.avgLatency = fields[2].toInt();
-                newData.stdev = fields[3].toInt();
-                stdev = newData.stdev; // native XLAT average and STDEV data is 100% accurate according to my tests
-                allData.push_back(newData);
-                dataInterpolation();
-            }
+    if (!allData.empty()) {
+        dataInterpolation();
+        refreshConfidenceIntervals();
+    }
+    updateTableView();
+    updateOutlierStatus();
+    updateTimingStatus();
+    updateStorageStatus();
+
+    // Rejected lines are reported once the good ones are in
+    if (capture.errorCount) {
+        QStringList lines;
+        for (const xlat::CsvError& e : capture.errors) {
+            if (lines.size() == 10) break;
+            lines << "Line " + QString::number(e.line) + ": " + QString::fromStdString(e.message);
         }
-
-        file.close();
-        updateTableView();
-    } else {
-        qWarning() << "Failed to open file for reading:" << file.errorString();
+        if (capture.errorCount > std::size_t(lines.size())) {
+            lines << "... " + QString::number(capture.errorCount - lines.size()) + " more";
+        }
+        QString title = imported.empty() ? "Import Error" : "Import Warning";
+        QString text = QString::number(capture.errorCount) + " line(s) were skipped";
+        if (!imported.empty()) {
+            text += ", " + QString::number(imported.size()) + " samples imported";
+        }
+        QMessageBox::warning(this, title, text + ".\n\n" + lines.join("\n"));
     }
 }
 
@@ -476,10 +870,11 @@ void xlat_evtool::importCsv(const QString& filePath) {
 
 void xlat_evtool::handleCsvImport() {
 
-    QString filePath = QFileDialog::getOpenFileName(this, tr("Open CSV File"), "", tr("CSV Files (*.csv)"));
+    QString filePath = QFileDialog::getOpenFileName(this, tr("Open CSV File"), "",
+                                                    tr("Captures (*.csv *.xlatc);;CSV Files (*.csv);;Compressed Captures (*.xlatc)"));
 
     if (!filePath.isEmpty()) {
-        importCsv(filePath);
+        importCapture(filePath);
     } else {
         //qDebug() << "No file selected for import.";
     }
@@ -487,103 +882,183 @@ void xlat_evtool::handleCsvImport() {
 
 void xlat_evtool::dataInterpolation() {
 
-    std::vector<int> latencies;
-    for (const auto& d : allData) {
-        latencies.push_back(d.latency);
-    }
-    std::sort(latencies.begin(), latencies.end());
+    // One fused evaluation of every metric in xlat::LatencyMetrics, off the
+    // histogram kept up to date on ingest
+    session.evaluate();
 
-    int size = latencies.size();
+    updatePercentileData();
 
-    double sumLatency = 0.0;
-    double sumSqrt = 0.0;
-    double medianLatency = 0.0;
-    double madValue = 0.0;
+    // Bootstrap runs on a timer so fast captures don't resample on every report
+    if (bootstrapSettings.resamples > 0 && !intervalRefreshTimer->isActive()) {
+        intervalRefreshTimer->start();
+    }
+}
 
-    for (const auto& d : allData) {
-        sumLatency += d.latency;
-        double difference = d.latency - latencies[size / 2];
-        madValue += std::abs(difference);
-        sumSqrt += difference * difference;
+static QString withInterval(double value, int decimals, const xlat::ConfidenceInterval *ci) {
+    if (!ci) {
+        return QString::number(value, 'f', decimals);
     }
+    return QString::number(value, 'f', decimals) + " [" + QString::number(ci->low, 'f', 0) + "-" + QString::number(ci->high, 'f', 0) + "]";
+}
 
-    double meanLatency = sumLatency / size;
+void xlat_evtool::updatePercentileData() {
 
-    double p90_index = 0.90 * size;
-    double p95_index = 0.95 * size;
-    double p5_index = 0.05 * size;
-    double p10_index = 0.10 * size;
-    double q1_index = 0.25 * size;
-    double q3_index = 0.75 * size;
+    const std::uint64_t sampleCount = latencyMetrics.count();
+    const bool ci = confidenceIntervals.isValid();
+    const auto& values = latencyMetrics.values();
+    const auto& infos = xlat::LatencyMetrics::infos();
 
-    p90Value = latencies[std::round(p90_index)];
-    p95Value = latencies[std::round(p95_index)];
-    p5Value = latencies[std::round(p5_index)];
-    p10Value = latencies[std::round(p10_index)];
-    iqrValue = latencies[std::round(q3_index)] - latencies[std::round(q1_index)];
-    maxLatency = latencies.back();
-    minLatency = latencies.front();
-    avgLatency = meanLatency;
+    for (const MetricField& field : metricFields) {
+        // Guards against malformed data visualization due to low data pool
+        if (sampleCount < field.minSamples) {
+            field.lineEdit->setText("need more data");
+            continue;
+        }
+        const xlat::ConfidenceInterval *interval = ci && field.interval ? &(confidenceIntervals.*field.interval) : nullptr;
+        field.lineEdit->setText(withInterval(values[field.metric], infos[field.metric].decimals, interval));
+    }
 
-    if (size % 2 == 0) {
-        medianLatency = (latencies[size / 2 - 1] + latencies[size / 2]) / 2;
-    } else {
-        medianLatency = latencies[size / 2];
+    if (allMetricsTable) {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            allMetricsTable->item(int(i), 0)->setText(QString::number(values[i], 'f', infos[i].decimals));
+        }
     }
+}
 
-    // Calculate MAD
-    madValue /= size;
+void xlat_evtool::showAllMetrics() {
 
-    // Calculate standard deviation
-    stdev = static_cast<int>(std::sqrt(sumSqrt / size));
+    if (allMetricsTable) {
+        allMetricsTable->window()->raise();
+        return;
+    }
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("All Metrics");
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->resize(360, 480);
+
+    const auto& infos = xlat::LatencyMetrics::infos();
+    QTableWidget *table = new QTableWidget(int(infos.size()), 1);
+    table->setHorizontalHeaderLabels({ "Value" });
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    QStringList labels;
+    for (std::size_t i = 0; i < infos.size(); ++i) {
+        labels << infos[i].label;
+        table->setItem(int(i), 0, new QTableWidgetItem());
+    }
+    table->setVerticalHeaderLabels(labels);
 
-    updatePercentileData(p90Value, p95Value, p5Value, p10Value, iqrValue,
-                         maxLatency, minLatency, avgLatency, medianLatency,
-                         madValue);
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(table);
 
-    _counterCall++; // Increment counter to prevent malformed data visualization due to low data pool
+    allMetricsTable = table;
+    updatePercentileData();
+    dialog->show();
 }
 
+void xlat_evtool::showAllocationProfile() {
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setWindowTitle("Allocation Profile");
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->resize(560, 400);
+
+    // Heap allocations per pipeline stage since the last reset. Reset once the
+    // capture is running to see the steady state.
+    const int stages = int(xlat::AllocStage::Count);
+    QTableWidget *table = new QTableWidget(stages + 1, 4);
+    table->setHorizontalHeaderLabels({ "Allocations", "Bytes", "Allocs/sample", "Bytes/sample" });
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    QStringList labels;
+    for (int row = 0; row <= stages; ++row) {
+        labels << (row < stages ? xlat::allocStageName(xlat::AllocStage(row)) : "Total");
+        for (int column = 0; column < 4; ++column) {
+            table->setItem(row, column, new QTableWidgetItem());
+        }
+    }
+    table->setVerticalHeaderLabels(labels);
+
+    QLabel *samplesLabel = new QLabel();
+    QPushButton *resetButton = new QPushButton("Reset");
+
+    auto refresh = [table, samplesLabel, stages] {
+        xlat::AllocProfile profile = xlat::allocProfile();
+        double samples = profile.samples ? double(profile.samples) : 1.0;
+        for (int row = 0; row <= stages; ++row) {
+            xlat::AllocCounts counts = row < stages ? profile[xlat::AllocStage(row)] : profile.total();
+            table->item(row, 0)->setText(QString::number(counts.allocations));
+            table->item(row, 1)->setText(QString::number(counts.bytes));
+            table->item(row, 2)->setText(QString::number(double(counts.allocations) / samples, 'f', 4));
+            table->item(row, 3)->setText(QString::number(double(counts.bytes) / samples, 'f', 1));
+        }
+        samplesLabel->setText(QString::number(profile.samples) + " samples since reset");
+    };
+    connect(resetButton, &QPushButton::clicked, dialog, [refresh] {
+        xlat::resetAllocProfile();
+        refresh();
+    });
+    QTimer *refreshTimer = new QTimer(dialog);
+    connect(refreshTimer, &QTimer::timeout, dialog, refresh);
+    refreshTimer->start(1000);
+
+    QHBoxLayout *footer = new QHBoxLayout();
+    footer->addWidget(samplesLabel);
+    footer->addStretch();
+    footer->addWidget(resetButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(table);
+    layout->addLayout(footer);
+
+    refresh();
+    dialog->show();
+}
 
-void xlat_evtool::updatePercentileData(int p90Value, int p95Value, int p5Value, int p10Value, int iqrValue,
-                                       int maxLatency, int minLatency, double avgLatency, int medianLatency,
-                                       int madValue) {
+void xlat_evtool::refreshConfidenceIntervals() {
 
-    if(_counterCall>7){
-    p90LineEdit->setText(QString::number(p90Value));
-    }else{
-    p90LineEdit->setText("need more data");
+    if (latencyMetrics.count() == 0) {
+        return;
     }
 
-    if(_counterCall>9){
-    p95LineEdit->setText(QString::number(p95Value));
-    }else{
-    p95LineEdit->setText("need more data");
-    }
+    confidenceIntervals = xlat::bootstrapIntervals(latencyMetrics.histogram(), bootstrapSettings);
 
-    if(_counterCall>3){
-    iqrLineEdit->setText(QString::number(iqrValue));
-    }else{
-    iqrLineEdit->setText("need more data");
+    QString tip;
+    if (confidenceIntervals.isValid()) {
+        tip = QString::number(confidenceIntervals.confidence * 100, 'f', 0) + "% confidence interval from "
+              + QString::number(confidenceIntervals.resamples) + " bootstrap resamples";
     }
+    QLineEdit *withIntervals[] = { p5LineEdit, p10LineEdit, p90LineEdit, p95LineEdit,
+                                   iqrLineEdit, medLatLineEdit, avgLatLineEdit };
+    for (QLineEdit *lineEdit : withIntervals) {
+        lineEdit->setToolTip(tip);
+    }
+
+    updatePercentileData();
+}
 
+void xlat_evtool::configureBootstrap() {
 
-    p5LineEdit->setText(QString::number(p5Value));
-    p10LineEdit->setText(QString::number(p10Value));
-    maxLatLineEdit->setText(QString::number(maxLatency));
-    minLatLineEdit->setText(QString::number(minLatency));
-    medLatLineEdit->setText(QString::number(medianLatency));
-    avgLatLineEdit->setText(QString::number(avgLatency));
-    stdevLineEdit->setText(QString::number(stdev));
-    avgMadLineEdit->setText(QString::number(madValue));
+    bool ok;
+    int resamples = QInputDialog::getInt(this, "Confidence Intervals",
+                                         "Bootstrap resamples (0 disables confidence intervals):",
+                                         bootstrapSettings.resamples, 0, 100000, 100, &ok);
+    if (!ok) {
+        return;
+    }
+
+    bootstrapSettings.resamples = resamples;
+    confidenceIntervals = xlat::BootstrapIntervals();
+    refreshConfidenceIntervals();
 }
 
 
 void xlat_evtool::clearData() {
 
-    model->removeRows(0, model->rowCount());
-
-    allData.clear();
+    session.clear();
+    model->reload();
+    updateFilterStatus();
 
     // Clearing QLineEdit fields
     p90LineEdit->clear();
@@ -598,19 +1073,15 @@ void xlat_evtool::clearData() {
     stdevLineEdit->clear();
     avgLatLineEdit->clear();
 
-    _counterCall = 0;
+    updateOutlierStatus();
+    updateTimingStatus();
+    convergenceMonitor.reset();
+    earlyStopArmedNs = 0;
+    captureStopped = false;
+    updateEarlyStopStatus();
+    intervalRefreshTimer->stop();
+    confidenceIntervals = xlat::BootstrapIntervals();
 
-    minLatency = 0;
-    maxLatency = 0;
-    p90Value = 0;
-    p95Value = 0;
-    p5Value = 0;
-    p10Value = 0;
-    iqrValue = 0;
-    madValue = 0;
-    avgLatency = 0;
-    medianLatency = 0;
-    stdev = 0;
 
 }
 
@@ -659,6 +1130,7 @@ void xlat_evtool::showScatterChartWindow() {
     QtCharts::QValueAxis *xAxis = new QtCharts::QValueAxis();
     QtCharts::QValueAxis *yAxis = new QtCharts::QValueAxis();
 
+    const int maxLatency = latencyMetrics.histogram().maxValue();
     yAxis->setRange(0, maxLatency * 1.1); // graph 10% higher than max data, prevents splitted data points
 
     scatterChart->addAxis(xAxis, Qt::AlignBottom);
@@ -668,10 +1140,8 @@ void xlat_evtool::showScatterChartWindow() {
     scatterSeries->setMarkerSize(4);
     scatterSeries->setPen(Qt::NoPen);
 
-    for (const auto& data : allData) {
-        QPointF point(data.reportNumber, data.latency);
-        scatterSeries->append(point);
-    }
+    // Long captures are reduced to the min and max of each run of reports, so spikes survive
+    scatterSeries->replace(ChartRenderer::scatterPoints(allData));
 
     // Set color to blue
     scatterSeries->setColor(Qt::blue);
@@ -680,6 +1150,21 @@ void xlat_evtool::showScatterChartWindow() {
     scatterSeries->attachAxis(xAxis);
     scatterSeries->attachAxis(yAxis);
 
+    // Flagged reports drawn on top in red
+    if (!outlierDetector.outliers().empty()) {
+        QtCharts::QScatterSeries *outlierSeries = new QtCharts::QScatterSeries();
+        outlierSeries->setName("Outliers");
+        outlierSeries->setMarkerSize(7);
+        outlierSeries->setPen(Qt::NoPen);
+        outlierSeries->setColor(Qt::red);
+        for (const auto& outlier : outlierDetector.outliers()) {
+            outlierSeries->append(outlier.reportNumber, outlier.latency);
+        }
+        scatterChart->addSeries(outlierSeries);
+        outlierSeries->attachAxis(xAxis);
+        outlierSeries->attachAxis(yAxis);
+    }
+
     QtCharts::QChartView *chartView = new QtCharts::QChartView(scatterChart);
     chartView->setRenderHint(QPainter::Antialiasing);
 
@@ -692,6 +1177,41 @@ void xlat_evtool::showScatterChartWindow() {
 }
 
 
+void xlat_evtool::saveSegmentTimeline(const QString& capturePath) {
+
+    // A sidecar rather than part of the capture, so the CSV stays plain
+    std::string error;
+    if (!segmentTimeline.save(QFile::encodeName(capturePath + ".xlatseg").toStdString(),
+                              std::uint64_t(QFileInfo(capturePath).size()), &error)) {
+        qWarning() << "Segment timeline not saved:" << QString::fromStdString(error);
+    }
+}
+
+void xlat_evtool::showTimelineWindow() {
+
+    // Parented like the density map, it reads the live timeline in place
+    TimelineWindow *timelineWindow = new TimelineWindow(segmentTimeline, allData, this);
+    timelineWindow->setAttribute(Qt::WA_DeleteOnClose);
+    timelineWindow->show();
+}
+
+void xlat_evtool::showDensityWindow() {
+
+    // Parented, it reads the capture in place and must not outlive it
+    DensityWindow *densityWindow = new DensityWindow(allData, this);
+    densityWindow->setAttribute(Qt::WA_DeleteOnClose);
+    densityWindow->show();
+}
+
+
+void xlat_evtool::showDistributionWindow() {
+
+    // Drawn from the metrics' own histogram, parented so it can't outlive it
+    DistributionWindow *distributionWindow = new DistributionWindow(latencyMetrics.histogram(), this);
+    distributionWindow->setAttribute(Qt::WA_DeleteOnClose);
+    distributionWindow->show();
+}
+
 void xlat_evtool::showHistogramWindow() {
 
     QMainWindow *histogramWindow = new QMainWindow();
@@ -706,6 +1226,8 @@ void xlat_evtool::showHistogramWindow() {
     histogramWindow->resize(1600, 900);
     histogramWindow->show();
 
+    const int minLatency = latencyMetrics.histogram().minValue();
+    const int maxLatency = latencyMetrics.histogram().maxValue();
     int range = maxLatency - minLatency;
 
     int step = range / 16;
@@ -752,41 +1274,42 @@ void xlat_evtool::showHistogramWindow() {
     int bar15 = 0;
     int bar16 = 0;
 
-    for (const auto& data : allData) {
-        if (data.latency >= variables[0] && data.latency < variables[1]) {
-            bar1++;
-        } else if (data.latency >= variables[1] && data.latency < variables[2]) {
-            bar2++;
-        } else if (data.latency >= variables[2] && data.latency < variables[3]) {
-            bar3++;
-        } else if (data.latency >= variables[3] && data.latency < variables[4]) {
-            bar4++;
-        } else if (data.latency >= variables[4] && data.latency < variables[5]) {
-            bar5++;
-        } else if (data.latency >= variables[5] && data.latency < variables[6]) {
-            bar6++;
-        } else if (data.latency >= variables[6] && data.latency < variables[7]) {
-            bar7++;
-        } else if (data.latency >= variables[7] && data.latency < variables[8]) {
-            bar8++;
-        } else if (data.latency >= variables[8] && data.latency < variables[9]) {
-            bar9++;
-        } else if (data.latency >= variables[9] && data.latency < variables[10]) {
-            bar10++;
-        } else if (data.latency >= variables[10] && data.latency < variables[11]) {
-            bar11++;
-        } else if (data.latency >= variables[11] && data.latency < variables[12]) {
-            bar12++;
-        } else if (data.latency >= variables[12] && data.latency < variables[13]) {
-            bar13++;
-        } else if (data.latency >= variables[13] && data.latency < variables[14]) {
-            bar14++;
-        } else if (data.latency >= variables[14] && data.latency < variables[15]) {
-            bar15++;
-        } else if (data.latency >= variables[15]) {
-            bar16++;
+    // Counted per histogram bin, not per sample
+    latencyMetrics.histogram().forEachBin([&](int latency, std::uint64_t count) {
+        if (latency >= variables[0] && latency < variables[1]) {
+            bar1 += int(count);
+        } else if (latency >= variables[1] && latency < variables[2]) {
+            bar2 += int(count);
+        } else if (latency >= variables[2] && latency < variables[3]) {
+            bar3 += int(count);
+        } else if (latency >= variables[3] && latency < variables[4]) {
+            bar4 += int(count);
+        } else if (latency >= variables[4] && latency < variables[5]) {
+            bar5 += int(count);
+        } else if (latency >= variables[5] && latency < variables[6]) {
+            bar6 += int(count);
+        } else if (latency >= variables[6] && latency < variables[7]) {
+            bar7 += int(count);
+        } else if (latency >= variables[7] && latency < variables[8]) {
+            bar8 += int(count);
+        } else if (latency >= variables[8] && latency < variables[9]) {
+            bar9 += int(count);
+        } else if (latency >= variables[9] && latency < variables[10]) {
+            bar10 += int(count);
+        } else if (latency >= variables[10] && latency < variables[11]) {
+            bar11 += int(count);
+        } else if (latency >= variables[11] && latency < variables[12]) {
+            bar12 += int(count);
+        } else if (latency >= variables[12] && latency < variables[13]) {
+            bar13 += int(count);
+        } else if (latency >= variables[13] && latency < variables[14]) {
+            bar14 += int(count);
+        } else if (latency >= variables[14] && latency < variables[15]) {
+            bar15 += int(count);
+        } else if (latency >= variables[15]) {
+            bar16 += int(count);
         }
-    }
+    });
 
     *set0 << bar1;
     *set1 << bar2;
@@ -882,3 +1405,37 @@ void xlat_evtool::showHistogramWindow() {
 
     layout->addWidget(chartView);
 }
+
+void xlat_evtool::showComparisonWindow() {
+
+    ComparisonWindow *comparisonWindow = new ComparisonWindow();
+
+    // Current capture is the natural baseline
+    comparisonWindow->addSession("Current capture", latencyMetrics.histogram());
+
+    comparisonWindow->show();
+}
+
+void xlat_evtool::showRenderChartsDialog() {
+
+    RenderChartsDialog *dialog = new RenderChartsDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
+void xlat_evtool::showCatalogWindow() {
+
+    // A single catalog, its background scan keeps running while it is open
+    if (!catalogWindow) {
+        catalogWindow = new CatalogWindow(this);
+        catalogWindow->setAttribute(Qt::WA_DeleteOnClose);
+        connect(catalogWindow, &CatalogWindow::openRequested, this, [this](const QString &path) {
+            importCapture(path);
+            raise();
+            activateWindow();
+        });
+    }
+    catalogWindow->show();
+    catalogWindow->raise();
+    catalogWindow->activateWindow();
+}
@@ -20,14 +20,35 @@
 #define XLAT_EVTOOL_H
 
 #include "ledwidget.h"
+#include "sampletablemodel.h"
+#include "metricsserver.h"
+#include "serialreader.h"
+#include "xlat_data.h"
+#include "xlat_bootstrap.h"
+#include "xlat_convergence.h"
+#include "xlat_histogram.h"
+#include "xlat_metricset.h"
+#include "xlat_metrics.h"
+#include "xlat_outliers.h"
+#include "xlat_parser.h"
+#include "xlat_samplestore.h"
+#include "xlat_sequence.h"
+#include "xlat_session.h"
+#include "xlat_timeline.h"
+#include "xlat_timing.h"
 #include <QMainWindow>
 #include <QSerialPort>
+#include <QSerialPortInfo>
+#include <QElapsedTimer>
 #include <QTableView>
-#include <QStandardItemModel>
 #include <QLineEdit>
 #include <QHeaderView>
 #include <QTimer>
 #include <QDialog>
+#include <QLabel>
+#include <QPointer>
+#include <QTableWidget>
+#include <QThread>
 #include <vector>
 #include <QBarSet>
 
@@ -35,6 +56,8 @@ QT_BEGIN_NAMESPACE
 namespace Ui { class xlat_evtool;}
 QT_END_NAMESPACE
 
+class CatalogWindow;
+
 class xlat_evtool : public QMainWindow
 {
     Q_OBJECT
@@ -42,41 +65,71 @@ class xlat_evtool : public QMainWindow
 public:
     xlat_evtool(QWidget *parent = nullptr);
     ~xlat_evtool();
-    struct xlatData {
-        int reportNumber;
-        int latency;
-        int avgLatency;
-        int stdev;
-    };
+    typedef ::xlatData xlatData;
+
+    // Serves live metrics on `address`, see MetricsServer::start()
+    bool startMetricsEndpoint(const QString &address, QString *errorMessage = nullptr);
+
+    // Times startup from `sinceLaunch` (started at the top of main) to the window,
+    // the first event loop turn and the end of the first port scan. The result
+    // goes to the log and the status bar; exitWhenDone quits after it.
+    void measureStartup(const QElapsedTimer &sinceLaunch, bool exitWhenDone = false);
 
 signals:
     void serialDataReceived(const QByteArray &data);
     void processData(int numInputs, int latency, int average, int stdev);
 
 private slots:
-    void readSerialData();
+    void readSerialData(const QByteArray &data, qint64 readTimeNs);
     void checkAndOpenSerialPort();
+    void serialPortScanned(const QSerialPortInfo& port, bool found, bool fallback);
+    void serialPortOpened(bool ok, const QString &error);
     void checkConnectionStatus();
-    void handleError(QSerialPort::SerialPortError error);
+    void serialPortLost();
     //void printTotalArray();
     void updateTableView();
-    void updateTableViewDynamic(const xlatData& newData);
+    void updateTableViewDynamic();
     void initializeUI();
+    void initializeMenus();
     void saveCSV();
     void handleCsvImport();
-    void importCsv(const QString& filePath);
+    void importCapture(const QString& filePath);
     void dataInterpolation();
-    void updatePercentileData(int p90Value, int p95Value, int p5Value, int p10Value, int iqrValue,
-                              int maxLatency, int minLatency, double avgLatency, int medianLatency,
-                              int madValue);
+    void updatePercentileData();
+    void showAllMetrics();
+    void refreshConfidenceIntervals();
+    void configureBootstrap();
+    void showOutlierDialog();
+    void markOutlierRow(int row);
+    void updateOutlierStatus();
+    void showSampleFilterDialog();
+    void updateFilterStatus();
+    void updateTimingStatus();
+    void updateStorageStatus();
+    void showTimingDialog();
+    void configureEarlyStop();
+    void checkEarlyStop(std::int64_t hostTimeNs);
+    void checkEarlyStopTimeLimit();
+    void updateEarlyStopStatus();
+    void configureMetricsEndpoint();
+    void showAllocationProfile();
+    void publishMetrics();
     void clearData();
     void openGitHubLink();
     void disclaimer();
 
     void showScatterChartWindow();
+    void showDensityWindow();
+    void showTimelineWindow();
     void showHistogramWindow();
+    void showDistributionWindow();
+    void showComparisonWindow();
+    void showCatalogWindow();
+    void showRenderChartsDialog();
 
 private:
+    void saveSegmentTimeline(const QString& capturePath);
+
     Ui::xlat_evtool *ui;
     QTimer *connectionCheckTimer = new QTimer(this);
 
@@ -99,30 +152,66 @@ private:
     QLineEdit *vidLineEdit;
     QLineEdit *pidLineEdit;
 
-    QSerialPort *serialPort;
+    // Port discovery, opening and reads run on serialThread, see SerialReader
+    QThread serialThread;
+    SerialReader *serialReader;
+    bool portScanRunning = false;
+    bool serialPortOpen = false;
+
+    QElapsedTimer startupTimer; // invalid unless measureStartup() was called
+    qint64 startupWindowMs = -1;
+    qint64 startupEventLoopMs = -1;
+    bool exitAfterStartup = false;
 
     LedWidget *comStatus;
 
-    QStandardItemModel *model = new QStandardItemModel(this);
+    SampleTableModel *model;
     QTableView *tableView;
 
-    xlatData myData;
-    std::vector<xlatData> allData;
+    // Ingest and statistics run in the core session, the window only reads them.
+    // Recent sample chunks stay in RAM, older ones spill to a temp file.
+    xlat::CaptureSession session;
+    const xlat::SampleStore& allData = session.store();
+    const xlat::LatencyMetrics& latencyMetrics = session.metrics();
+    const xlat::RecordParser& recordParser = session.parser();
+    const xlat::ArrivalStats& arrivalStats = session.arrival();
+    const xlat::SequenceTracker& sequenceTracker = session.sequence();
+    xlat::OutlierDetector& outlierDetector = session.outliers();
+    xlat::SegmentTimeline& segmentTimeline = session.timeline(); // per-segment percentiles, saved next to captures
 
     bool resize = true;
 
-    int minLatency;
-    int maxLatency;
-    int p90Value;
-    int p95Value;
-    int p5Value;
-    int p10Value;
-    int iqrValue;
-    int madValue;
-    int avgLatency;
-    int medianLatency;
-    int stdev;
-    int _counterCall = 0;
+    // Fixed main window fields, bound to a pipeline metric by index
+    struct MetricField {
+        std::size_t metric;
+        QLineEdit *lineEdit;
+        xlat::ConfidenceInterval xlat::BootstrapIntervals::*interval; // null when not bootstrapped
+        std::uint64_t minSamples;
+    };
+
+    std::vector<MetricField> metricFields;
+    QPointer<QTableWidget> allMetricsTable;
+    QPointer<CatalogWindow> catalogWindow;
+    xlat::BootstrapSettings bootstrapSettings;
+    xlat::BootstrapIntervals confidenceIntervals;
+    QTimer *intervalRefreshTimer = new QTimer(this);
+
+    QLabel *outlierLabel;
+    QLabel *filterLabel;
+
+    QLabel *timingLabel;
+    QLabel *storageLabel;
+    QTimer *storageStatusTimer = new QTimer(this);
+
+    xlat::ConvergenceMonitor convergenceMonitor;
+    bool captureStopped = false; // early stop hit, reads are drained and dropped
+    std::int64_t earlyStopArmedNs = 0; // host time the limits run from, 0: the next sample
+    QLabel *earlyStopLabel;
+
+    xlat::SnapshotExchange<xlat::MetricsSnapshot> metricsSnapshots;
+    std::uint64_t metricsSequence = 0;
+    MetricsServer *metricsServer = new MetricsServer(metricsSnapshots, this);
+    QTimer *metricsPublishTimer = new QTimer(this);
 
 };
 
@@ -0,0 +1,160 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_histogram.h"
+#include "xlat_parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace xlat {
+
+void LatencyHistogram::growDense(int latency) {
+    std::size_t wanted = std::max<std::size_t>(static_cast<std::size_t>(latency) + 1, m_dense.size() * 2);
+    m_dense.resize(std::min<std::size_t>(wanted, m_denseLimit), 0);
+}
+
+void LatencyHistogram::add(int latency, std::uint64_t times) {
+    if (times == 0) return;
+    if (latency >= 0 && latency < m_denseLimit) {
+        if (static_cast<std::size_t>(latency) >= m_dense.size()) {
+            growDense(latency);
+        }
+        m_dense[latency] += times;
+    } else {
+        m_sparse[latency] += times;
+    }
+    if (m_count == 0 || latency < m_min) m_min = latency;
+    if (m_count == 0 || latency > m_max) m_max = latency;
+    m_count += times;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    if (other.m_count == 0) return;
+
+    if (other.m_denseLimit != m_denseLimit) {
+        other.forEachBin([this](int latency, std::uint64_t count) { add(latency, count); });
+        return;
+    }
+
+    if (other.m_dense.size() > m_dense.size()) {
+        m_dense.resize(other.m_dense.size(), 0);
+    }
+    if (other.m_max >= 0) {
+        std::size_t first = other.m_min > 0 ? static_cast<std::size_t>(other.m_min) : 0;
+        std::size_t last = std::min(static_cast<std::size_t>(other.m_max) + 1, other.m_dense.size());
+        for (std::size_t v = first; v < last; ++v) {
+            m_dense[v] += other.m_dense[v];
+        }
+    }
+    for (const auto &bin : other.m_sparse) {
+        m_sparse[bin.first] += bin.second;
+    }
+
+    if (m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+    if (m_count == 0 || other.m_max > m_max) m_max = other.m_max;
+    m_count += other.m_count;
+}
+
+void LatencyHistogram::clear() {
+    m_dense.clear();
+    m_sparse.clear();
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+int LatencyHistogram::valueAtRank(std::uint64_t rank) const {
+    int value = 0;
+    valuesAtRanks(&rank, &value, 1);
+    return value;
+}
+
+void LatencyHistogram::valuesAtRanks(const std::uint64_t *ranks, int *values, std::size_t n) const {
+    if (n == 0) return;
+    if (m_count == 0) {
+        std::fill(values, values + n, 0);
+        return;
+    }
+
+    std::size_t next = 0;
+    std::uint64_t seen = 0;
+    forEachBin([&](int latency, std::uint64_t binCount) {
+        seen += binCount;
+        while (next < n && ranks[next] < seen) {
+            values[next++] = latency;
+        }
+    });
+    // Ranks past the end resolve to the largest sample
+    while (next < n) {
+        values[next++] = m_max;
+    }
+}
+
+std::uint64_t LatencyHistogram::percentileRank(double fraction, std::uint64_t count) {
+    if (count == 0) return 0;
+    double index = std::round(fraction * static_cast<double>(count));
+    if (index < 0) return 0;
+    return std::min<std::uint64_t>(static_cast<std::uint64_t>(index), count - 1);
+}
+
+int LatencyHistogram::percentile(double fraction) const {
+    return valueAtRank(percentileRank(fraction));
+}
+
+int LatencyHistogram::median() const {
+    if (m_count == 0) return 0;
+    if (m_count % 2 == 0) {
+        std::uint64_t ranks[2] = { m_count / 2 - 1, m_count / 2 };
+        int values[2];
+        valuesAtRanks(ranks, values, 2);
+        return (values[0] + values[1]) / 2;
+    }
+    return valueAtRank(m_count / 2);
+}
+
+std::uint64_t LatencyHistogram::countBelow(int latency) const {
+    std::uint64_t below = 0;
+    forEachBin([&](int value, std::uint64_t binCount) {
+        if (value < latency) below += binCount;
+    });
+    return below;
+}
+
+LatencyHistogram LatencyHistogram::fromSamples(const std::vector<xlatData> &samples) {
+    return fromSamples(samples.data(), samples.size());
+}
+
+LatencyHistogram LatencyHistogram::fromSamples(const xlatData *samples, std::size_t n) {
+    unsigned workers = workerCount(n);
+    std::vector<LatencyHistogram> partial(workers);
+
+    parallelChunks(n, workers, [&](std::size_t begin, std::size_t end, unsigned worker) {
+        LatencyHistogram &h = partial[worker];
+        for (std::size_t i = begin; i < end; ++i) {
+            h.add(samples[i].latency);
+        }
+    });
+
+    LatencyHistogram result = std::move(partial[0]);
+    for (unsigned w = 1; w < workers; ++w) {
+        result.merge(partial[w]);
+    }
+    return result;
+}
+
+} // namespace xlat
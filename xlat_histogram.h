@@ -0,0 +1,121 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_HISTOGRAM_H
+#define XLAT_HISTOGRAM_H
+
+#include "xlat_data.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace xlat {
+
+// Exact latency distribution: one counter per distinct latency value.
+// XLAT latencies are small integers clustered in a narrow band, so a dense counter
+// array replaces the sorted copy of every sample. Percentiles, MAD, rank tests and
+// CDFs are answered by walking the occupied bins instead of re-sorting the data.
+// Values outside [0, denseLimit) are kept in a sparse map so a corrupt file can't
+// blow up the dense array.
+class LatencyHistogram
+{
+public:
+    static const int kDenseLimit = 1 << 22;
+
+    explicit LatencyHistogram(int denseLimit = kDenseLimit) : m_denseLimit(denseLimit) {}
+
+    void add(int latency) {
+        if (latency >= 0 && latency < m_denseLimit) {
+            if (static_cast<std::size_t>(latency) >= m_dense.size()) {
+                growDense(latency);
+            }
+            ++m_dense[latency];
+        } else {
+            ++m_sparse[latency];
+        }
+        if (m_count == 0 || latency < m_min) m_min = latency;
+        if (m_count == 0 || latency > m_max) m_max = latency;
+        ++m_count;
+    }
+
+    void add(int latency, std::uint64_t times);
+    void merge(const LatencyHistogram &other);
+    void clear();
+
+    std::uint64_t count() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    int minValue() const { return m_min; }
+    int maxValue() const { return m_max; }
+
+    // Value found at position `rank` of the sorted samples, rank in [0, count())
+    int valueAtRank(std::uint64_t rank) const;
+    // Same as above for many ascending ranks in a single walk over the bins
+    void valuesAtRanks(const std::uint64_t *ranks, int *values, std::size_t n) const;
+
+    // Percentile with the sorted[round(fraction * size)] convention used by the
+    // main window, clamped to the last sample
+    int percentile(double fraction) const;
+    std::uint64_t percentileRank(double fraction) const { return percentileRank(fraction, m_count); }
+    static std::uint64_t percentileRank(double fraction, std::uint64_t count);
+
+    // Median as shown in the main window: mean of the two middle samples when even
+    int median() const;
+
+    // Number of samples strictly lower than `latency`
+    std::uint64_t countBelow(int latency) const;
+
+    // Visits the occupied bins in ascending order: fn(int latency, std::uint64_t count)
+    template <typename Fn>
+    void forEachBin(Fn fn) const {
+        if (m_count == 0) return;
+        auto it = m_sparse.begin();
+        for (; it != m_sparse.end() && it->first < 0; ++it) {
+            fn(it->first, it->second);
+        }
+        if (!m_dense.empty() && m_max >= 0) {
+            std::size_t first = m_min > 0 ? static_cast<std::size_t>(m_min) : 0;
+            std::size_t last = std::min(static_cast<std::size_t>(m_max) + 1, m_dense.size());
+            for (std::size_t v = first; v < last; ++v) {
+                if (m_dense[v]) fn(static_cast<int>(v), m_dense[v]);
+            }
+        }
+        for (; it != m_sparse.end(); ++it) {
+            fn(it->first, it->second);
+        }
+    }
+
+    // Histogram of the latency column, built on all cores for large captures
+    static LatencyHistogram fromSamples(const std::vector<xlatData> &samples);
+    static LatencyHistogram fromSamples(const xlatData *samples, std::size_t n);
+
+private:
+    void growDense(int latency);
+
+    int m_denseLimit;
+    std::vector<std::uint64_t> m_dense;
+    std::map<int, std::uint64_t> m_sparse;
+    std::uint64_t m_count = 0;
+    int m_min = 0;
+    int m_max = 0;
+};
+
+} // namespace xlat
+
+#endif // XLAT_HISTOGRAM_H
@@ -0,0 +1,129 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "xlat_metrics.h"
+#include "xlat_csv.h"
+
+namespace xlat {
+
+namespace {
+
+void appendMetric(std::string &out, const char *name, const char *type, const char *help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// Scrapers only accept '.' as the decimal point, whatever the C locale
+void appendSample(std::string &out, const char *name, const char *labels, double value) {
+    out += name;
+    out += labels;
+    out += ' ';
+    appendGeneral(out, value);
+    out += '\n';
+}
+
+void appendField(std::string &out, const char *name, double value, bool last = false) {
+    out += "  \"";
+    out += name;
+    out += "\": ";
+    appendGeneral(out, value);
+    out += last ? "\n" : ",\n";
+}
+
+} // namespace
+
+std::string formatPrometheus(const MetricsSnapshot &s) {
+    std::string out;
+    out.reserve(2048);
+
+    appendMetric(out, "xlat_samples_total", "counter", "Reports captured in the current session.");
+    appendSample(out, "xlat_samples_total", "", double(s.samples));
+
+    appendMetric(out, "xlat_latency_microseconds", "gauge", "Click-to-report latency of the current session.");
+    appendSample(out, "xlat_latency_microseconds", "{stat=\"min\"}", s.minLatency);
+    appendSample(out, "xlat_latency_microseconds", "{stat=\"max\"}", s.maxLatency);
+    appendSample(out, "xlat_latency_microseconds", "{stat=\"mean\"}", s.avgLatency);
+    appendSample(out, "xlat_latency_microseconds", "{stat=\"stdev\"}", s.stdev);
+    appendSample(out, "xlat_latency_microseconds", "{quantile=\"0.5\"}", s.p50);
+    appendSample(out, "xlat_latency_microseconds", "{quantile=\"0.9\"}", s.p90);
+    appendSample(out, "xlat_latency_microseconds", "{quantile=\"0.95\"}", s.p95);
+    appendSample(out, "xlat_latency_microseconds", "{quantile=\"0.99\"}", s.p99);
+
+    appendMetric(out, "xlat_ingest_rate", "gauge", "Reports per second received by the host.");
+    appendSample(out, "xlat_ingest_rate", "", s.ingestRate);
+
+    appendMetric(out, "xlat_interarrival_jitter_microseconds", "gauge", "Standard deviation of the report inter-arrival time.");
+    appendSample(out, "xlat_interarrival_jitter_microseconds", "", s.jitterUs);
+
+    appendMetric(out, "xlat_dropped_frames_total", "counter", "Malformed lines and missing report numbers.");
+    appendSample(out, "xlat_dropped_frames_total", "", double(s.droppedFrames));
+
+    appendMetric(out, "xlat_duplicate_reports_total", "counter", "Report numbers received more than once.");
+    appendSample(out, "xlat_duplicate_reports_total", "", double(s.duplicateReports));
+
+    appendMetric(out, "xlat_out_of_order_reports_total", "counter", "Reports that arrived after a later report number.");
+    appendSample(out, "xlat_out_of_order_reports_total", "", double(s.outOfOrderReports));
+
+    appendMetric(out, "xlat_outliers_total", "counter", "Reports flagged by the outlier rules.");
+    appendSample(out, "xlat_outliers_total", "", double(s.outliers));
+
+    appendMetric(out, "xlat_snapshot_timestamp_seconds", "gauge", "When the values above were published.");
+    appendSample(out, "xlat_snapshot_timestamp_seconds", "", double(s.timestampMs) / 1000.0);
+    return out;
+}
+
+std::string formatJson(const MetricsSnapshot &s) {
+    std::string out;
+    out.reserve(512);
+    out += "{\n";
+    appendField(out, "sequence", double(s.sequence));
+    appendField(out, "timestamp_ms", double(s.timestampMs));
+    appendField(out, "samples", double(s.samples));
+    appendField(out, "min", s.minLatency);
+    appendField(out, "max", s.maxLatency);
+    appendField(out, "p50", s.p50);
+    appendField(out, "p90", s.p90);
+    appendField(out, "p95", s.p95);
+    appendField(out, "p99", s.p99);
+    appendField(out, "mean", s.avgLatency);
+    appendField(out, "stdev", s.stdev);
+    appendField(out, "ingest_rate", s.ingestRate);
+    appendField(out, "jitter_us", s.jitterUs);
+    appendField(out, "dropped_frames", double(s.droppedFrames));
+    appendField(out, "duplicate_reports", double(s.duplicateReports));
+    appendField(out, "out_of_order_reports", double(s.outOfOrderReports));
+    appendField(out, "outliers", double(s.outliers));
+    out += "  \"metrics\": {\n";
+    const auto &infos = LatencyMetrics::infos();
+    for (std::size_t i = 0; i < infos.size(); ++i) {
+        out += "  ";
+        appendField(out, infos[i].name, s.metrics[i], i + 1 == infos.size());
+    }
+    out += "  }\n}\n";
+    return out;
+}
+
+} // namespace xlat
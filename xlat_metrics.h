@@ -0,0 +1,93 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef XLAT_METRICS_H
+#define XLAT_METRICS_H
+
+#include "xlat_metricset.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace xlat {
+
+// Point-in-time copy of the live counters, published by the capture side and
+// rendered by the metrics endpoint. Latencies are in us, like the device reports.
+struct MetricsSnapshot {
+    std::uint64_t sequence = 0;      // bumped on every publish, 0 = nothing captured yet
+    std::int64_t timestampMs = 0;    // wall clock of the publish, unix epoch
+    std::uint64_t samples = 0;
+    int minLatency = 0;
+    int maxLatency = 0;
+    int p50 = 0;
+    int p90 = 0;
+    int p95 = 0;
+    int p99 = 0;
+    double avgLatency = 0.0;
+    double stdev = 0.0;
+    double ingestRate = 0.0;         // reports/s over the capture
+    double jitterUs = 0.0;
+    std::uint64_t droppedFrames = 0; // malformed lines + gaps in the report numbers
+    std::uint64_t duplicateReports = 0;
+    std::uint64_t outOfOrderReports = 0;
+    std::uint64_t outliers = 0;
+    std::array<double, LatencyMetrics::kSize> metrics{}; // every pipeline value, LatencyMetrics order
+};
+
+// Prometheus text exposition format 0.0.4
+std::string formatPrometheus(const MetricsSnapshot &snapshot);
+// Same values plus a "metrics" object with the whole LatencyMetrics set by name
+std::string formatJson(const MetricsSnapshot &snapshot);
+
+// Triple buffer handing the latest value from one writer thread to one reader
+// thread. Neither side ever blocks or waits on the other: the writer fills its
+// private slot and swaps it with the shared one, the reader swaps the shared
+// slot in only when something newer was published.
+template <typename T>
+class SnapshotExchange
+{
+public:
+    // Writer thread only
+    void publish(const T &value) {
+        m_slots[m_back] = value;
+        m_back = m_shared.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader thread only
+    const T &latest() {
+        if (m_shared.load(std::memory_order_relaxed) & kFresh) {
+            m_front = m_shared.exchange(m_front, std::memory_order_acq_rel) & kIndexMask;
+        }
+        return m_slots[m_front];
+    }
+
+private:
+    static const unsigned kIndexMask = 3;
+    static const unsigned kFresh = 4;
+
+    T m_slots[3];
+    unsigned m_back = 0;
+    unsigned m_front = 1;
+    std::atomic<unsigned> m_shared{ 2 };
+};
+
+} // namespace xlat
+
+#endif // XLAT_METRICS_H
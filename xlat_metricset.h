@@ -0,0 +1,160 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef XLAT_METRICSET_H
+#define XLAT_METRICSET_H
+
+#include "xlat_pipeline.h"
+#include <cmath>
+
+namespace xlat {
+
+// The metrics of a capture. Definitions follow the original dataInterpolation():
+// percentiles are sorted[round(q * size)], the median averages the two middle
+// samples, MAD and STDEV are taken around the middle sample. Adding a metric is a
+// type here plus an entry in LatencyMetrics at the bottom.
+
+struct MinLatency : MetricBase {
+    static constexpr MetricInfo kInfo = { "min", "Minimum Latency", 0 };
+    static constexpr std::size_t kRanks = 1;
+    void ranks(std::uint64_t, std::uint64_t *out) const { out[0] = 0; }
+    double finish(std::uint64_t, const int *values) const { return values[0]; }
+};
+
+struct MaxLatency : MetricBase {
+    static constexpr MetricInfo kInfo = { "max", "Maximum Latency", 0 };
+    static constexpr std::size_t kRanks = 1;
+    void ranks(std::uint64_t count, std::uint64_t *out) const { out[0] = count - 1; }
+    double finish(std::uint64_t, const int *values) const { return values[0]; }
+};
+
+// Fraction given as Numerator / Denominator, so p99.9 stays exact
+template <int Numerator, int Denominator>
+struct Percentile : MetricBase {
+    static constexpr std::size_t kRanks = 1;
+    void ranks(std::uint64_t count, std::uint64_t *out) const {
+        out[0] = LatencyHistogram::percentileRank(double(Numerator) / Denominator, count);
+    }
+    double finish(std::uint64_t, const int *values) const { return values[0]; }
+};
+
+struct P5 : Percentile<5, 100> { static constexpr MetricInfo kInfo = { "p5", "p5", 0 }; };
+struct P10 : Percentile<10, 100> { static constexpr MetricInfo kInfo = { "p10", "p10", 0 }; };
+struct P90 : Percentile<90, 100> { static constexpr MetricInfo kInfo = { "p90", "p90", 0 }; };
+struct P95 : Percentile<95, 100> { static constexpr MetricInfo kInfo = { "p95", "p95", 0 }; };
+struct P99 : Percentile<99, 100> { static constexpr MetricInfo kInfo = { "p99", "p99", 0 }; };
+struct P999 : Percentile<999, 1000> { static constexpr MetricInfo kInfo = { "p99_9", "p99.9", 0 }; };
+
+struct MedianLatency : MetricBase {
+    static constexpr MetricInfo kInfo = { "median", "Median Latency", 0 };
+    static constexpr std::size_t kRanks = 2;
+    void ranks(std::uint64_t count, std::uint64_t *out) const {
+        out[0] = (count - 1) / 2;
+        out[1] = count / 2;
+    }
+    double finish(std::uint64_t, const int *values) const { return (values[0] + values[1]) / 2; }
+};
+
+struct InterquartileRange : MetricBase {
+    static constexpr MetricInfo kInfo = { "iqr", "IQR", 0 };
+    static constexpr std::size_t kRanks = 2;
+    void ranks(std::uint64_t count, std::uint64_t *out) const {
+        out[0] = LatencyHistogram::percentileRank(0.25, count);
+        out[1] = LatencyHistogram::percentileRank(0.75, count);
+    }
+    double finish(std::uint64_t, const int *values) const { return values[1] - values[0]; }
+};
+
+struct MeanLatency : MetricBase {
+    static constexpr MetricInfo kInfo = { "mean", "Average Latency", 1 };
+    void clear() { m_sum = 0; }
+    void add(int latency) { m_sum += latency; }
+    double finish(std::uint64_t count, const int *) const { return double(m_sum) / double(count); }
+
+    std::int64_t m_sum = 0;
+};
+
+// Mean absolute deviation from the middle sample (the "MAD" of the main window)
+struct MeanAbsoluteDeviation : MetricBase {
+    static constexpr MetricInfo kInfo = { "mad", "MAD", 1 };
+    static constexpr std::size_t kRanks = 1;
+    static constexpr bool kVisitsBins = true;
+    void ranks(std::uint64_t count, std::uint64_t *out) const { out[0] = count / 2; }
+    void beginBins(std::uint64_t, const int *values) { m_middle = values[0]; m_sum = 0.0; }
+    void visitBin(int value, std::uint64_t count, std::uint64_t) {
+        m_sum += double(count) * std::abs(double(value) - m_middle);
+    }
+    double finish(std::uint64_t count, const int *) const { return m_sum / double(count); }
+
+    double m_middle = 0.0;
+    double m_sum = 0.0;
+};
+
+// Root mean square deviation from the middle sample
+struct StandardDeviation : MetricBase {
+    static constexpr MetricInfo kInfo = { "stdev", "STDEV", 1 };
+    static constexpr std::size_t kRanks = 1;
+    static constexpr bool kVisitsBins = true;
+    void ranks(std::uint64_t count, std::uint64_t *out) const { out[0] = count / 2; }
+    void beginBins(std::uint64_t, const int *values) { m_middle = values[0]; m_sum = 0.0; }
+    void visitBin(int value, std::uint64_t count, std::uint64_t) {
+        double difference = double(value) - m_middle;
+        m_sum += double(count) * difference * difference;
+    }
+    double finish(std::uint64_t count, const int *) const { return std::sqrt(m_sum / double(count)); }
+
+    double m_middle = 0.0;
+    double m_sum = 0.0;
+};
+
+// Mean of the samples left after dropping Percent % at each end
+template <int Percent>
+struct TrimmedMean : MetricBase {
+    static constexpr bool kVisitsBins = true;
+    void beginBins(std::uint64_t count, const int *) {
+        m_low = count * Percent / 100;
+        m_high = count - m_low;
+        m_sum = 0.0;
+    }
+    void visitBin(int value, std::uint64_t count, std::uint64_t before) {
+        std::uint64_t first = std::max(before, m_low);
+        std::uint64_t last = std::min(before + count, m_high);
+        if (first < last) m_sum += double(last - first) * value;
+    }
+    double finish(std::uint64_t, const int *) const {
+        return m_high > m_low ? m_sum / double(m_high - m_low) : 0.0;
+    }
+
+    std::uint64_t m_low = 0;
+    std::uint64_t m_high = 0;
+    double m_sum = 0.0;
+};
+
+struct TrimmedMean10 : TrimmedMean<10> {
+    static constexpr MetricInfo kInfo = { "trimmed_mean_10", "10% Trimmed Mean", 1 };
+};
+
+// Order is the order of the CSV header and of generic listings
+typedef MetricPipeline<MinLatency, MaxLatency, P5, P10, P90, P95, InterquartileRange,
+                       MeanAbsoluteDeviation, MeanLatency, MedianLatency, StandardDeviation,
+                       P99, P999, TrimmedMean10> LatencyMetrics;
+
+} // namespace xlat
+
+#endif // XLAT_METRICSET_H
@@ -0,0 +1,133 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_outliers.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace xlat {
+
+OutlierDetector::OutlierDetector() {
+    m_outliers.reserve(1024);
+}
+
+void OutlierDetector::setRules(const OutlierRules &rules) {
+    m_rules = rules;
+}
+
+std::uint8_t OutlierDetector::check(std::size_t sampleIndex, const xlatData &sample, std::int64_t hostTimeNs) {
+    std::uint8_t fired = 0;
+    const double latency = sample.latency;
+
+    if (m_rules.absolute && sample.latency >= m_rules.absoluteThreshold) {
+        fired |= AbsoluteThreshold;
+    }
+    if (m_armed) {
+        if (m_rules.tukey && (latency < m_tukeyLow || latency > m_tukeyHigh)) {
+            fired |= TukeyFence;
+        }
+        if (m_rules.mad && (latency < m_madLow || latency > m_madHigh)) {
+            fired |= MadDistance;
+        }
+    }
+
+    if (fired) {
+        m_outliers.push_back({ static_cast<std::uint32_t>(sampleIndex), sample.reportNumber,
+                               sample.latency, fired, hostTimeNs });
+    }
+    return fired;
+}
+
+void OutlierDetector::sampleAdded(const LatencyHistogram &histogram) {
+    ++m_sinceRefresh;
+    if (!m_armed ? histogram.count() >= m_rules.warmup : m_sinceRefresh >= kRefreshInterval) {
+        updateThresholds(histogram);
+    }
+}
+
+void OutlierDetector::updateThresholds(const LatencyHistogram &histogram) {
+    m_sinceRefresh = 0;
+    m_armed = histogram.count() >= std::max<std::uint64_t>(m_rules.warmup, 1);
+    if (!m_armed) {
+        return;
+    }
+
+    std::uint64_t ranks[2] = { histogram.percentileRank(0.25), histogram.percentileRank(0.75) };
+    int quartiles[2];
+    histogram.valuesAtRanks(ranks, quartiles, 2);
+    double iqr = quartiles[1] - quartiles[0];
+    m_tukeyLow = quartiles[0] - m_rules.tukeyK * iqr;
+    m_tukeyHigh = quartiles[1] + m_rules.tukeyK * iqr;
+
+    if (m_rules.mad) {
+        int median = histogram.median();
+        // 1.4826 scales MAD to sigma for normal data; floor it at one count so a
+        // perfectly flat stream doesn't flag every 1-count wobble
+        double sigma = std::max(1.0, 1.4826 * medianAbsoluteDeviation(histogram, median));
+        m_madLow = median - m_rules.madK * sigma;
+        m_madHigh = median + m_rules.madK * sigma;
+    }
+}
+
+double OutlierDetector::medianAbsoluteDeviation(const LatencyHistogram &histogram, int median) {
+    m_bins.clear();
+    histogram.forEachBin([&](int latency, std::uint64_t count) {
+        m_bins.emplace_back(latency, count);
+    });
+    if (m_bins.empty()) return 0.0;
+
+    // Walk outwards from the median, always taking the closer side: deviations come
+    // out in ascending order without sorting them
+    std::size_t right = std::lower_bound(m_bins.begin(), m_bins.end(), std::make_pair(median, std::uint64_t(0))) - m_bins.begin();
+    std::ptrdiff_t left = static_cast<std::ptrdiff_t>(right) - 1;
+    const std::uint64_t target = histogram.count() / 2;
+    std::uint64_t seen = 0;
+
+    while (left >= 0 || right < m_bins.size()) {
+        long long leftDev = left >= 0 ? static_cast<long long>(median) - m_bins[left].first : -1;
+        long long rightDev = right < m_bins.size() ? static_cast<long long>(m_bins[right].first) - median : -1;
+        bool takeRight = leftDev < 0 || (rightDev >= 0 && rightDev <= leftDev);
+
+        long long deviation = takeRight ? rightDev : leftDev;
+        seen += takeRight ? m_bins[right++].second : m_bins[left--].second;
+        if (seen > target) {
+            return static_cast<double>(deviation);
+        }
+    }
+    return 0.0;
+}
+
+void OutlierDetector::scan(const SampleStore &samples, const LatencyHistogram &histogram) {
+    m_outliers.clear();
+    updateThresholds(histogram);
+    const bool timed = samples.hasHostTimes();
+    const std::int64_t origin = samples.hostTimeOrigin();
+    samples.forEach([&](std::size_t i, const xlatData &sample, std::int64_t hostTimeNs) {
+        check(i, sample, timed ? hostTimeNs - origin : -1);
+    });
+}
+
+void OutlierDetector::clear() {
+    m_outliers.clear();
+    m_armed = false;
+    m_sinceRefresh = 0;
+    m_tukeyLow = m_tukeyHigh = 0.0;
+    m_madLow = m_madHigh = 0.0;
+}
+
+} // namespace xlat
@@ -0,0 +1,107 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_OUTLIERS_H
+#define XLAT_OUTLIERS_H
+
+#include "xlat_data.h"
+#include "xlat_histogram.h"
+#include "xlat_samplestore.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xlat {
+
+enum OutlierRule : std::uint8_t {
+    TukeyFence = 1,        // outside [Q1 - k*IQR, Q3 + k*IQR]
+    MadDistance = 2,       // |latency - median| > k * 1.4826 * median absolute deviation
+    AbsoluteThreshold = 4  // latency >= fixed threshold
+};
+
+struct OutlierRules {
+    bool tukey = true;
+    double tukeyK = 3.0;          // "far out" fences, 1.5 flags too much on skewed latency data
+    bool mad = false;
+    double madK = 3.5;
+    bool absolute = false;
+    int absoluteThreshold = 0;
+    std::uint64_t warmup = 30;    // samples needed before the statistical rules engage
+};
+
+// One flagged report. host time is ns since capture start, -1 when unknown (imports)
+struct OutlierRecord {
+    std::uint32_t sampleIndex;
+    std::int32_t reportNumber;
+    std::int32_t latency;
+    std::uint8_t rules;
+    std::int64_t hostTimeNs;
+};
+
+// Streaming spike detector for the ingest path. Fences are derived from the live
+// latency histogram every kRefreshInterval samples, so the per-sample check is a
+// couple of compares and only flagged samples touch memory.
+class OutlierDetector
+{
+public:
+    static const std::uint64_t kRefreshInterval = 64;
+
+    OutlierDetector();
+
+    void setRules(const OutlierRules &rules);
+    const OutlierRules &rules() const { return m_rules; }
+
+    // Rules that fire for `sample` against the current fences, 0 when normal.
+    // Flagged samples are appended to the outlier index.
+    std::uint8_t check(std::size_t sampleIndex, const xlatData &sample, std::int64_t hostTimeNs);
+
+    // To be called after the sample was added to `histogram`, refreshes the fences when due
+    void sampleAdded(const LatencyHistogram &histogram);
+
+    // Recomputes the fences right away
+    void updateThresholds(const LatencyHistogram &histogram);
+
+    // Re-classifies a whole capture against its final distribution (imports, rule changes)
+    void scan(const SampleStore &samples, const LatencyHistogram &histogram);
+
+    void clear();
+
+    const std::vector<OutlierRecord> &outliers() const { return m_outliers; }
+    bool isArmed() const { return m_armed; }
+    std::pair<double, double> tukeyFences() const { return std::make_pair(m_tukeyLow, m_tukeyHigh); }
+    std::pair<double, double> madFences() const { return std::make_pair(m_madLow, m_madHigh); }
+
+private:
+    double medianAbsoluteDeviation(const LatencyHistogram &histogram, int median);
+
+    OutlierRules m_rules;
+    bool m_armed = false;
+    std::uint64_t m_sinceRefresh = 0;
+    double m_tukeyLow = 0.0;
+    double m_tukeyHigh = 0.0;
+    double m_madLow = 0.0;
+    double m_madHigh = 0.0;
+
+    std::vector<OutlierRecord> m_outliers;
+    std::vector<std::pair<int, std::uint64_t>> m_bins; // scratch for the MAD walk, reused
+};
+
+} // namespace xlat
+
+#endif // XLAT_OUTLIERS_H
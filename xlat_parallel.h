@@ -0,0 +1,67 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_PARALLEL_H
+#define XLAT_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace xlat {
+
+// Number of workers worth spawning for `items` units of work. Small jobs stay on
+// the calling thread, thread start-up costs more than it saves below minPerWorker.
+inline unsigned workerCount(std::size_t items, std::size_t minPerWorker = 1 << 16) {
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t wanted = minPerWorker ? items / minPerWorker : items;
+    return static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(hw, wanted)));
+}
+
+// Splits [0, items) into `workers` contiguous chunks and runs fn(begin, end, worker)
+// on each, the last chunk on the calling thread. Blocks until every chunk is done.
+template <typename Fn>
+void parallelChunks(std::size_t items, unsigned workers, Fn fn) {
+    if (workers <= 1 || items < 2) {
+        fn(std::size_t(0), items, 0u);
+        return;
+    }
+    workers = static_cast<unsigned>(std::min<std::size_t>(workers, items));
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    std::size_t chunk = items / workers;
+    for (unsigned w = 0; w + 1 < workers; ++w) {
+        threads.emplace_back(fn, w * chunk, (w + 1) * chunk, w);
+    }
+    fn((workers - 1) * chunk, items, workers - 1);
+
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+template <typename Fn>
+void parallelChunks(std::size_t items, Fn fn) {
+    parallelChunks(items, workerCount(items), fn);
+}
+
+} // namespace xlat
+
+#endif // XLAT_PARALLEL_H
@@ -0,0 +1,91 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_parser.h"
+#include <climits>
+
+namespace xlat {
+
+const std::size_t RecordParser::kMaxLineLength;
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Whole-field integer conversion, surrounding blanks allowed like QString::toInt()
+bool parseField(const char *begin, const char *end, int &value) {
+    while (begin != end && isSpace(*begin)) ++begin;
+    while (end != begin && isSpace(end[-1])) --end;
+    if (begin == end) return false;
+
+    bool negative = false;
+    if (*begin == '-' || *begin == '+') {
+        negative = *begin == '-';
+        if (++begin == end) return false;
+    }
+
+    long long result = 0;
+    for (; begin != end; ++begin) {
+        if (*begin < '0' || *begin > '9') return false;
+        result = result * 10 + (*begin - '0');
+        if (result > INT_MAX) return false;
+    }
+    value = static_cast<int>(negative ? -result : result);
+    return true;
+}
+
+} // namespace
+
+void RecordParser::reset() {
+    m_pending.clear();
+    m_malformed = 0;
+    m_overlong = false;
+}
+
+bool RecordParser::parseLine(const char *begin, const char *end, xlatData &record) {
+    const char *p = begin;
+    while (p != end && isSpace(*p)) ++p;
+    if (p == end) return false; // blank line, not an error
+
+    int values[4];
+    const char *fieldStart = begin;
+    int field = 0;
+    for (p = begin; field < 4; ++p) {
+        if (p == end || *p == ';') {
+            if (!parseField(fieldStart, p, values[field])) break;
+            ++field;
+            if (p == end) break;
+            fieldStart = p + 1;
+        }
+    }
+
+    if (field < 4) {
+        ++m_malformed;
+        return false;
+    }
+
+    record.reportNumber = values[0];
+    record.latency = values[1];
+    record.avgLatency = values[2];
+    record.stdev = values[3];
+    return true;
+}
+
+} // namespace xlat
@@ -0,0 +1,93 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_PARSER_H
+#define XLAT_PARSER_H
+
+#include "xlat_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xlat {
+
+// Frames the raw VCOM byte stream into "report;latency;average;stdev" lines.
+// A read may end in the middle of a line, or carry several lines at once: the
+// unterminated tail is kept and completed by the next feed(). Lines are parsed
+// in place, the only buffer is the carried tail whose capacity is reused.
+//
+// A stream without newlines (wrong baud rate, binary data) would grow that tail
+// forever, so a line longer than kMaxLineLength is dropped and counted as
+// malformed; the parser picks up again after the next '\n'.
+class RecordParser
+{
+public:
+    // Four int fields and separators take under 50 bytes
+    static const std::size_t kMaxLineLength = 256;
+
+    // Calls onRecord(const xlatData &) for every complete, well-formed line in data
+    template <typename Fn>
+    void feed(const char *data, std::size_t size, Fn onRecord) {
+        const char *end = data + size;
+        const char *lineStart = data;
+        for (const char *p = data; p != end; ++p) {
+            if (*p != '\n') continue;
+
+            xlatData record;
+            bool ok;
+            if (m_overlong) {
+                m_overlong = false;
+                ok = false;
+            } else if (m_pending.empty()) {
+                ok = parseLine(lineStart, p, record);
+            } else {
+                m_pending.append(lineStart, p);
+                ok = parseLine(m_pending.data(), m_pending.data() + m_pending.size(), record);
+                m_pending.clear();
+            }
+            if (ok) onRecord(record);
+            lineStart = p + 1;
+        }
+        if (m_overlong) {
+            return;
+        }
+        if (m_pending.size() + std::size_t(end - lineStart) > kMaxLineLength) {
+            m_pending.clear();
+            m_overlong = true;
+            ++m_malformed;
+            return;
+        }
+        m_pending.append(lineStart, end);
+    }
+
+    void reset();
+
+    std::uint64_t malformedLines() const { return m_malformed; }
+
+    // Parses one line without its terminator; false for blank or malformed lines
+    bool parseLine(const char *begin, const char *end, xlatData &record);
+
+private:
+    std::string m_pending;
+    std::uint64_t m_malformed = 0;
+    bool m_overlong = false; // skipping to the end of a line that outgrew the limit
+};
+
+} // namespace xlat
+
+#endif // XLAT_PARSER_H
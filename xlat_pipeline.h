@@ -0,0 +1,182 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef XLAT_PIPELINE_H
+#define XLAT_PIPELINE_H
+
+#include "xlat_data.h"
+#include "xlat_histogram.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace xlat {
+
+// How a metric is called by the UI, the CSV export and the headless/endpoint output
+struct MetricInfo {
+    const char *name;  // stable machine name: "p99", "trimmed_mean"
+    const char *label; // display and CSV header name: "p99", "Average Latency"
+    int decimals;
+};
+
+// A metric is a type deriving from MetricBase with a `static constexpr MetricInfo
+// kInfo` and a `double finish(std::uint64_t count, const int *rankValues) const`.
+// It hides whichever of these stages it needs, the no-op defaults compile away:
+//
+//   add(latency)                     per sample, fused into the single ingest loop
+//   kRanks, ranks(count, out)        sample ranks it wants resolved; the ranks of all
+//                                    metrics are resolved together in one histogram walk
+//   kVisitsBins, beginBins(count, rankValues), visitBin(value, binCount, rankBefore)
+//                                    one shared walk over the histogram bins, after
+//                                    the ranks are known
+//
+// Metrics keep their state in fixed members, evaluation never allocates.
+struct MetricBase {
+    static constexpr std::size_t kRanks = 0;
+    static constexpr bool kVisitsBins = false;
+
+    void clear() {}
+    void add(int) {}
+    void ranks(std::uint64_t, std::uint64_t *) const {}
+    void beginBins(std::uint64_t, const int *) {}
+    void visitBin(int, std::uint64_t, std::uint64_t) {}
+};
+
+// Fuses a compile-time list of distinct metric types: every sample goes through one loop that
+// feeds the shared latency histogram and each metric's add() stage, evaluate()
+// then does one rank walk and at most one bin walk for all of them.
+template <typename... Metrics>
+class MetricPipeline
+{
+public:
+    static constexpr std::size_t kSize = sizeof...(Metrics);
+
+    void add(int latency) {
+        m_histogram.add(latency);
+        (std::get<Metrics>(m_metrics).add(latency), ...);
+    }
+
+    void addBatch(const xlatData *begin, const xlatData *end) {
+        for (const xlatData *sample = begin; sample != end; ++sample) {
+            add(sample->latency);
+        }
+    }
+
+    void clear() {
+        m_histogram.clear();
+        (std::get<Metrics>(m_metrics).clear(), ...);
+        m_values.fill(0.0);
+    }
+
+    const LatencyHistogram &histogram() const { return m_histogram; }
+    std::uint64_t count() const { return m_histogram.count(); }
+
+    // Brings values() up to date with everything added so far
+    void evaluate() {
+        const std::uint64_t n = m_histogram.count();
+        if (n == 0) {
+            m_values.fill(0.0);
+            return;
+        }
+
+        // Stage 1: every requested rank, resolved in ascending order by one walk
+        std::array<std::uint64_t, kTotalRanks + 1> ranks{};
+        std::array<int, kTotalRanks + 1> rankValues{};
+        std::size_t offset = 0;
+        ((std::get<Metrics>(m_metrics).ranks(n, ranks.data() + offset), offset += Metrics::kRanks), ...);
+
+        std::array<std::size_t, kTotalRanks + 1> order{};
+        std::array<std::uint64_t, kTotalRanks + 1> sortedRanks{};
+        std::array<int, kTotalRanks + 1> sortedValues{};
+        for (std::size_t i = 0; i < kTotalRanks; ++i) order[i] = i;
+        std::sort(order.begin(), order.begin() + kTotalRanks,
+                  [&](std::size_t a, std::size_t b) { return ranks[a] < ranks[b]; });
+        for (std::size_t i = 0; i < kTotalRanks; ++i) sortedRanks[i] = ranks[order[i]];
+        m_histogram.valuesAtRanks(sortedRanks.data(), sortedValues.data(), kTotalRanks);
+        for (std::size_t i = 0; i < kTotalRanks; ++i) rankValues[order[i]] = sortedValues[i];
+
+        // Stage 2: one bin walk shared by the metrics that need it
+        if constexpr ((Metrics::kVisitsBins || ...)) {
+            offset = 0;
+            ((std::get<Metrics>(m_metrics).beginBins(n, rankValues.data() + offset), offset += Metrics::kRanks), ...);
+            std::uint64_t before = 0;
+            m_histogram.forEachBin([&](int value, std::uint64_t binCount) {
+                visitBin<Metrics...>(value, binCount, before);
+                before += binCount;
+            });
+        }
+
+        // Stage 3: final values
+        offset = 0;
+        std::size_t index = 0;
+        ((m_values[index++] = std::get<Metrics>(m_metrics).finish(n, rankValues.data() + offset),
+          offset += Metrics::kRanks), ...);
+    }
+
+    const std::array<double, kSize> &values() const { return m_values; }
+
+    template <typename Metric>
+    double value() const { return m_values[indexOf<Metric>()]; }
+
+    template <typename Metric>
+    static constexpr std::size_t indexOf() {
+        constexpr bool matches[] = { std::is_same<Metric, Metrics>::value... };
+        for (std::size_t i = 0; i < kSize; ++i) {
+            if (matches[i]) return i;
+        }
+        return kSize;
+    }
+
+    static const std::array<MetricInfo, kSize> &infos() {
+        static const std::array<MetricInfo, kSize> table = { { Metrics::kInfo... } };
+        return table;
+    }
+
+    // fn(const MetricInfo &, double value) in pipeline order
+    template <typename Fn>
+    void forEachResult(Fn fn) const {
+        for (std::size_t i = 0; i < kSize; ++i) {
+            fn(infos()[i], m_values[i]);
+        }
+    }
+
+private:
+    static constexpr std::size_t kTotalRanks = (Metrics::kRanks + ... + 0);
+
+    template <typename... Visiting>
+    void visitBin(int value, std::uint64_t binCount, std::uint64_t before) {
+        auto visit = [&](auto &metric) {
+            if constexpr (std::decay_t<decltype(metric)>::kVisitsBins) {
+                metric.visitBin(value, binCount, before);
+            }
+        };
+        (visit(std::get<Visiting>(m_metrics)), ...);
+    }
+
+    LatencyHistogram m_histogram;
+    std::tuple<Metrics...> m_metrics;
+    std::array<double, kSize> m_values{};
+};
+
+} // namespace xlat
+
+#endif // XLAT_PIPELINE_H
@@ -0,0 +1,72 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_RANDOM_H
+#define XLAT_RANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+namespace xlat {
+
+// xoshiro256** (Blackman & Vigna): a few cycles per draw, 256 bits of state and
+// good enough statistical quality for resampling. Satisfies
+// UniformRandomBitGenerator so it plugs into the <random> distributions.
+class FastRng
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit FastRng(std::uint64_t seed = 0x9e3779b97f4a7c15ULL) {
+        // State expanded with splitmix64, as recommended by the authors
+        for (int i = 0; i < 4; ++i) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            m_s[i] = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(m_s[1] * 5, 7) * 9;
+        const std::uint64_t t = m_s[1] << 17;
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = rotl(m_s[3], 45);
+        return result;
+    }
+
+    // Uniform double in [0, 1)
+    double uniform() { return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t m_s[4];
+};
+
+} // namespace xlat
+
+#endif // XLAT_RANDOM_H
@@ -0,0 +1,209 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_sampleindex.h"
+#include <algorithm>
+
+namespace xlat {
+
+bool SampleFilter::hasLatencyRange() const {
+    return minLatency != std::numeric_limits<int>::min() || maxLatency != std::numeric_limits<int>::max();
+}
+
+bool SampleFilter::hasReportRange() const {
+    return minReport != std::numeric_limits<int>::min() || maxReport != std::numeric_limits<int>::max();
+}
+
+bool SampleFilter::isActive() const {
+    return hasLatencyRange() || hasReportRange() || outliersOnly || order != SampleOrder::Capture;
+}
+
+void SampleIndex::update(const SampleStore &store) {
+    if (store.size() < size()) {
+        clear(); // cleared and refilled since the last update
+    }
+    if (store.size() == size()) {
+        return;
+    }
+    // Only the first fill is sized exactly, live appends must grow geometrically
+    if (m_latency.empty()) {
+        m_latency.reserve(store.size());
+        m_report.reserve(store.size());
+    }
+    store.forEach(size(), store.size(), [this](std::size_t, const xlatData &sample, std::int64_t) {
+        m_latency.push_back(sample.latency);
+        m_report.push_back(sample.reportNumber);
+    });
+}
+
+void SampleIndex::clear() {
+    m_latency.clear();
+    m_report.clear();
+    m_byLatency.clear();
+    m_sorted = 0;
+}
+
+void SampleIndex::mergeTail() {
+    const std::size_t middle = m_byLatency.size();
+    const std::size_t count = size() - m_sorted;
+    m_byLatency.resize(middle + count);
+    auto tail = m_byLatency.begin() + std::ptrdiff_t(middle);
+    for (std::size_t i = 0; i < count; ++i) {
+        tail[std::ptrdiff_t(i)] = std::uint32_t(m_sorted + i);
+    }
+    m_sorted = size();
+
+    // Tail indexes are all above the sorted ones, so (latency, index) order holds on ties
+    auto byLatency = [this](std::uint32_t a, std::uint32_t b) {
+        return m_latency[a] < m_latency[b] || (m_latency[a] == m_latency[b] && a < b);
+    };
+    if (count < 65536) {
+        std::sort(tail, m_byLatency.end(), byLatency);
+    } else {
+        // Stable radix sort of (latency, index) keys on the latency half, 16 bits
+        // at a time; the tail starts in index order so ties stay that way. Beats
+        // the comparison sort once the whole capture is indexed in one go.
+        std::vector<std::uint64_t> keys(count);
+        std::vector<std::uint64_t> scratch(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint32_t row = tail[std::ptrdiff_t(i)];
+            keys[i] = std::uint64_t(static_cast<std::uint32_t>(m_latency[row]) ^ 0x80000000u) << 32 | row;
+        }
+        std::vector<std::size_t> offsets(65536 + 1);
+        for (int shift = 32; shift < 64; shift += 16) {
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (std::uint64_t key : keys) ++offsets[((key >> shift) & 0xFFFFu) + 1];
+            for (std::size_t d = 1; d < offsets.size(); ++d) offsets[d] += offsets[d - 1];
+            for (std::uint64_t key : keys) scratch[offsets[(key >> shift) & 0xFFFFu]++] = key;
+            keys.swap(scratch);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            tail[std::ptrdiff_t(i)] = std::uint32_t(keys[i]);
+        }
+    }
+    std::inplace_merge(m_byLatency.begin(), tail, m_byLatency.end(), byLatency);
+}
+
+// Ascending sample indexes: a bitmap walk when the rows are a large part of the
+// index, a sort when they're few
+void SampleIndex::toCaptureOrder(std::vector<std::uint32_t> &rows) const {
+    if (rows.size() < size() / 64) {
+        std::sort(rows.begin(), rows.end());
+        return;
+    }
+    std::vector<std::uint64_t> bits((size() + 63) / 64);
+    for (std::uint32_t i : rows) {
+        bits[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+    rows.clear();
+    for (std::size_t word = 0; word < bits.size(); ++word) {
+        std::size_t bit = 0;
+        for (std::uint64_t w = bits[word]; w; w >>= 1, ++bit) {
+            if (w & 1) rows.push_back(std::uint32_t(word * 64 + bit));
+        }
+    }
+}
+
+std::vector<std::uint32_t> SampleIndex::select(const SampleFilter &filter, const std::vector<OutlierRecord> &outliers) {
+    std::vector<std::uint32_t> rows;
+    bool latencyOrdered = false;
+
+    // Start from the smallest candidate set: the outliers, a latency range off
+    // the sorted permutation, or else every sample
+    if (filter.outliersOnly) {
+        for (const OutlierRecord &outlier : outliers) {
+            if (outlier.sampleIndex < size() && inRanges(outlier.sampleIndex, filter)) {
+                rows.push_back(outlier.sampleIndex);
+            }
+        }
+    } else if (filter.hasLatencyRange() || filter.order == SampleOrder::LatencyAscending
+               || filter.order == SampleOrder::LatencyDescending) {
+        // A short tail is scanned as is, merging costs a pass over the index
+        const std::size_t tail = size() - m_sorted;
+        if (tail > 4096 && double(tail) * double(tail) > double(size())) {
+            mergeTail();
+        }
+        auto low = std::lower_bound(m_byLatency.begin(), m_byLatency.end(), filter.minLatency,
+                                    [this](std::uint32_t i, int latency) { return m_latency[i] < latency; });
+        auto high = std::upper_bound(low, m_byLatency.end(), filter.maxLatency,
+                                     [this](int latency, std::uint32_t i) { return latency < m_latency[i]; });
+        rows.reserve(std::size_t(high - low));
+        for (auto it = low; it != high; ++it) {
+            if (!filter.hasReportRange() || inRanges(*it, filter)) rows.push_back(*it);
+        }
+        if (m_sorted == size()) {
+            latencyOrdered = true;
+        } else {
+            for (std::size_t i = m_sorted; i < size(); ++i) {
+                if (inRanges(std::uint32_t(i), filter)) rows.push_back(std::uint32_t(i));
+            }
+        }
+    } else {
+        rows.reserve(filter.hasReportRange() ? 0 : size());
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (m_report[i] >= filter.minReport && m_report[i] <= filter.maxReport) rows.push_back(std::uint32_t(i));
+        }
+    }
+
+    switch (filter.order) {
+    case SampleOrder::Capture:
+        if (latencyOrdered || !std::is_sorted(rows.begin(), rows.end())) {
+            toCaptureOrder(rows);
+        }
+        break;
+    case SampleOrder::LatencyAscending:
+    case SampleOrder::LatencyDescending:
+        if (!latencyOrdered) {
+            std::sort(rows.begin(), rows.end(), [this](std::uint32_t a, std::uint32_t b) {
+                return m_latency[a] < m_latency[b] || (m_latency[a] == m_latency[b] && a < b);
+            });
+        }
+        if (filter.order == SampleOrder::LatencyDescending) {
+            std::reverse(rows.begin(), rows.end());
+        }
+        break;
+    case SampleOrder::ReportNumber:
+        std::sort(rows.begin(), rows.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return m_report[a] < m_report[b] || (m_report[a] == m_report[b] && a < b);
+        });
+        break;
+    }
+    return rows;
+}
+
+void SampleIndex::selectFrom(std::size_t first, const SampleFilter &filter, const std::vector<OutlierRecord> &outliers,
+                             std::vector<std::uint32_t> &rows) const {
+    if (filter.outliersOnly) {
+        auto it = std::lower_bound(outliers.begin(), outliers.end(), first,
+                                   [](const OutlierRecord &o, std::size_t i) { return o.sampleIndex < i; });
+        for (; it != outliers.end() && it->sampleIndex < size(); ++it) {
+            if (inRanges(it->sampleIndex, filter)) rows.push_back(it->sampleIndex);
+        }
+        return;
+    }
+    for (std::size_t i = first; i < size(); ++i) {
+        if (inRanges(std::uint32_t(i), filter)) rows.push_back(std::uint32_t(i));
+    }
+}
+
+std::size_t SampleIndex::memoryBytes() const {
+    return (m_latency.capacity() + m_report.capacity()) * sizeof(std::int32_t)
+         + m_byLatency.capacity() * sizeof(std::uint32_t);
+}
+
+} // namespace xlat
@@ -0,0 +1,92 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_SAMPLEINDEX_H
+#define XLAT_SAMPLEINDEX_H
+
+#include "xlat_outliers.h"
+#include "xlat_samplestore.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace xlat {
+
+enum class SampleOrder {
+    Capture,
+    LatencyAscending,
+    LatencyDescending,
+    ReportNumber
+};
+
+// Which samples the table shows and in what order, bounds are inclusive
+struct SampleFilter {
+    int minLatency = std::numeric_limits<int>::min();
+    int maxLatency = std::numeric_limits<int>::max();
+    int minReport = std::numeric_limits<int>::min();
+    int maxReport = std::numeric_limits<int>::max();
+    bool outliersOnly = false;
+    SampleOrder order = SampleOrder::Capture;
+
+    bool hasLatencyRange() const;
+    bool hasReportRange() const;
+    // Anything but every sample in capture order
+    bool isActive() const;
+};
+
+// Latency and report number of every sample, copied out of the store (8 bytes
+// per sample, so filtering never pages in spilled chunks), plus a permutation
+// sorted by latency for range queries. Appended samples collect in an unsorted
+// tail that is merged in once it outgrows a fraction of the index.
+class SampleIndex
+{
+public:
+    // Indexes store samples [size(), store.size()); the first call reads them all
+    void update(const SampleStore &store);
+    void clear();
+
+    std::size_t size() const { return m_latency.size(); }
+
+    // Sample indexes matching `filter`, in its order. `outliers` is the
+    // detector's list, in sample order.
+    std::vector<std::uint32_t> select(const SampleFilter &filter, const std::vector<OutlierRecord> &outliers);
+    // Matches among samples [first, size()) in capture order, appended to rows;
+    // follows a running capture without a full select()
+    void selectFrom(std::size_t first, const SampleFilter &filter, const std::vector<OutlierRecord> &outliers,
+                    std::vector<std::uint32_t> &rows) const;
+
+    std::size_t memoryBytes() const;
+
+private:
+    bool inRanges(std::uint32_t i, const SampleFilter &filter) const {
+        return m_latency[i] >= filter.minLatency && m_latency[i] <= filter.maxLatency
+            && m_report[i] >= filter.minReport && m_report[i] <= filter.maxReport;
+    }
+    void mergeTail();
+    void toCaptureOrder(std::vector<std::uint32_t> &rows) const;
+
+    std::vector<std::int32_t> m_latency;
+    std::vector<std::int32_t> m_report;
+    std::vector<std::uint32_t> m_byLatency; // (latency, index) order, covers [0, m_sorted)
+    std::size_t m_sorted = 0;
+};
+
+} // namespace xlat
+
+#endif // XLAT_SAMPLEINDEX_H
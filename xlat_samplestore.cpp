@@ -0,0 +1,398 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "xlat_samplestore.h"
+#include "xlat_codec.h"
+#include <cstring>
+
+namespace xlat {
+
+const std::size_t SampleStore::kChunkSize;
+const std::size_t SampleStore::kResidentChunks;
+const std::size_t SampleStore::kCachedChunks;
+const std::int64_t SampleStore::kNoHostTime;
+
+namespace {
+
+bool seekTo(std::FILE *file, std::uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+void updateSummary(SegmentSummary &s, const xlatData &sample, std::int64_t hostTimeNs) {
+    if (s.count == 0) {
+        s.minLatency = s.maxLatency = sample.latency;
+        s.firstReport = sample.reportNumber;
+        s.firstHostTime = hostTimeNs;
+    }
+    s.minLatency = std::min(s.minLatency, sample.latency);
+    s.maxLatency = std::max(s.maxLatency, sample.latency);
+    s.latencySum += sample.latency;
+    s.lastReport = sample.reportNumber;
+    s.lastHostTime = hostTimeNs;
+    ++s.count;
+}
+
+} // namespace
+
+SampleStore::SampleStore(std::string spillPath)
+    : m_spillPath(std::move(spillPath))
+{
+}
+
+SampleStore::~SampleStore() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    if (m_spillThread.joinable()) {
+        m_spillThread.join();
+    }
+    if (m_file) {
+        std::fclose(m_file);
+        std::remove(m_spillPath.c_str());
+    }
+}
+
+void SampleStore::append(const xlatData &sample, std::int64_t hostTimeNs) {
+    if (!m_tail) {
+        m_tail.reset(new Chunk());
+        m_tail->summary.firstIndex = m_size;
+        m_tail->samples.reserve(kChunkSize);
+    }
+
+    if (hostTimeNs == kNoHostTime) {
+        ++m_withoutHostTime;
+        hostTimeNs = 0;
+    }
+    if (m_size == 0) {
+        m_hostTimeOrigin = hostTimeNs;
+    }
+    m_tail->samples.push_back(sample);
+    m_tail->hostTimes.append(hostTimeNs);
+    updateSummary(m_tail->summary, sample, hostTimeNs);
+    m_last = sample;
+    ++m_size;
+
+    if (m_tail->samples.size() == kChunkSize) {
+        seal();
+    }
+}
+
+void SampleStore::seal() {
+    bool spill = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_chunks.push_back(std::move(m_tail));
+        if (!m_spillPath.empty() && m_chunks.size() > kResidentChunks) {
+            m_spillQueue.push_back(m_chunks.size() - 1 - kResidentChunks);
+            spill = true;
+        }
+    }
+
+    if (spill) {
+        if (!m_spillThread.joinable()) {
+            m_spillThread = std::thread(&SampleStore::spillLoop, this);
+        }
+        m_wake.notify_one();
+    }
+}
+
+void SampleStore::spillLoop() {
+    std::vector<std::uint8_t> encoded;
+    std::vector<std::int64_t> times;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this]() { return m_stop || !m_spillQueue.empty(); });
+        if (m_stop) {
+            return;
+        }
+
+        Chunk *chunk = m_chunks[m_spillQueue.front()].get();
+        m_spillQueue.pop_front();
+        m_spilling = true;
+        lock.unlock();
+
+        // Sealed chunks are immutable, they can be read without the lock
+        times.clear();
+        chunk->hostTimes.forEach([&](std::int64_t t) { times.push_back(t); });
+        encoded.clear();
+        encodeBlock(chunk->samples.data(), times.data(), chunk->samples.size(), encoded);
+
+        std::string error;
+        std::uint64_t offset = 0;
+        {
+            std::lock_guard<std::mutex> fileLock(m_fileMutex);
+            if (!m_file) {
+                m_file = std::fopen(m_spillPath.c_str(), "w+b");
+            }
+            offset = m_fileEnd;
+            if (!m_file) {
+                error = "Cannot create spill file " + m_spillPath;
+            } else if (!seekTo(m_file, offset)
+                       || std::fwrite(encoded.data(), 1, encoded.size(), m_file) != encoded.size()
+                       || std::fflush(m_file) != 0) {
+                error = "Cannot write spill file " + m_spillPath;
+            } else {
+                m_fileEnd += encoded.size();
+            }
+        }
+
+        lock.lock();
+        if (error.empty()) {
+            chunk->fileOffset = offset;
+            chunk->summary.spilled = true;
+            chunk->summary.compressedBytes = encoded.size();
+            std::vector<xlatData>().swap(chunk->samples);
+            chunk->hostTimes = HostTimeline();
+            m_spilledBytes += encoded.size();
+        } else {
+            // The chunk simply stays resident, the capture carries on
+            m_error = error;
+        }
+        m_spilling = false;
+        m_idle.notify_all();
+    }
+}
+
+void SampleStore::clear() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_spillQueue.clear();
+        m_idle.wait(lock, [this]() { return !m_spilling; });
+        m_chunks.clear();
+        m_spilledBytes = 0;
+        m_error.clear();
+    }
+    {
+        std::lock_guard<std::mutex> fileLock(m_fileMutex);
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+            std::remove(m_spillPath.c_str());
+        }
+        m_fileEnd = 0;
+    }
+
+    m_cache.clear();
+    m_tail.reset();
+    m_size = 0;
+    m_withoutHostTime = 0;
+    m_hostTimeOrigin = 0;
+    m_last = xlatData();
+}
+
+const SampleStore::CachedChunk &SampleStore::pageIn(std::size_t chunk) const {
+    for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
+        if (it->chunk == chunk) {
+            if (!it->ok) {
+                ++m_readErrors; // still zeros, every read of them counts
+            }
+            if (it != m_cache.begin()) {
+                CachedChunk hit = std::move(*it);
+                m_cache.erase(it);
+                m_cache.push_front(std::move(hit));
+            }
+            return m_cache.front();
+        }
+    }
+
+    CachedChunk cached;
+    cached.chunk = chunk;
+    cached.samples.resize(kChunkSize);
+    cached.hostTimes.resize(kChunkSize);
+    cached.ok = decodeSpilled(chunk, kChunkSize, cached.samples.data(), cached.hostTimes.data());
+
+    m_cache.push_front(std::move(cached));
+    if (m_cache.size() > kCachedChunks) {
+        m_cache.pop_back();
+    }
+    return m_cache.front();
+}
+
+bool SampleStore::decodeSpilled(std::size_t chunk, std::size_t count, xlatData *samples,
+                                std::int64_t *hostTimesNs) const {
+    std::uint64_t offset;
+    std::size_t bytes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Chunk &c = *m_chunks[chunk];
+        offset = c.fileOffset;
+        bytes = c.summary.compressedBytes;
+    }
+
+    std::vector<std::uint8_t> encoded(bytes);
+    bool ok;
+    {
+        std::lock_guard<std::mutex> fileLock(m_fileMutex);
+        ok = m_file && seekTo(m_file, offset) && std::fread(encoded.data(), 1, bytes, m_file) == bytes;
+    }
+    if (ok && decodeBlock(encoded.data(), bytes, count, samples, hostTimesNs) != 0) {
+        return true;
+    }
+
+    // Unreadable spill data shows up as zeros rather than taking the capture
+    // down, readErrors() lets exports refuse to write them
+    std::fill(samples, samples + count, xlatData());
+    if (hostTimesNs) std::fill(hostTimesNs, hostTimesNs + count, 0);
+    ++m_readErrors;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_error = "Cannot read spilled chunk " + std::to_string(chunk) + " back from " + m_spillPath;
+    return false;
+}
+
+std::size_t SampleStore::readChunk(std::size_t chunk, xlatData *samples, std::int64_t *hostTimesNs) const {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const Chunk *c = chunk < m_chunks.size() ? m_chunks[chunk].get() : m_tail.get();
+    if (!c) return 0;
+
+    const std::size_t count = c->summary.count;
+    if (c->summary.spilled) {
+        lock.unlock();
+        decodeSpilled(chunk, count, samples, hostTimesNs);
+        return count;
+    }
+
+    std::copy_n(c->samples.data(), count, samples);
+    if (hostTimesNs) {
+        c->hostTimes.forEach([&](std::int64_t t) { *hostTimesNs++ = t; });
+    }
+    return count;
+}
+
+void SampleStore::read(std::size_t begin, std::size_t count, xlatData *samples, std::int64_t *hostTimesNs) const {
+    const std::size_t sealed = m_chunks.size();
+    while (count > 0) {
+        std::size_t chunk = begin / kChunkSize;
+        std::size_t offset = begin % kChunkSize;
+        std::size_t n = std::min(count, kChunkSize - offset);
+
+        if (chunk >= sealed) {
+            std::copy_n(m_tail->samples.data() + offset, n, samples);
+            if (hostTimesNs) {
+                m_tail->hostTimes.read(offset, n, hostTimesNs);
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const Chunk &c = *m_chunks[chunk];
+            if (!c.summary.spilled) {
+                std::copy_n(c.samples.data() + offset, n, samples);
+                if (hostTimesNs) {
+                    c.hostTimes.read(offset, n, hostTimesNs);
+                }
+            } else {
+                lock.unlock();
+                const CachedChunk &cached = pageIn(chunk);
+                std::copy_n(cached.samples.data() + offset, n, samples);
+                if (hostTimesNs) {
+                    std::copy_n(cached.hostTimes.data() + offset, n, hostTimesNs);
+                }
+            }
+        }
+
+        begin += n;
+        count -= n;
+        samples += n;
+        if (hostTimesNs) hostTimesNs += n;
+    }
+}
+
+xlatData SampleStore::at(std::size_t index) const {
+    std::size_t chunk = index / kChunkSize;
+    std::size_t offset = index % kChunkSize;
+    if (chunk >= m_chunks.size()) {
+        return m_tail->samples[offset];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Chunk &c = *m_chunks[chunk];
+        if (!c.summary.spilled) {
+            return c.samples[offset];
+        }
+    }
+    return pageIn(chunk).samples[offset];
+}
+
+std::int64_t SampleStore::hostTimeAt(std::size_t index) const {
+    std::size_t chunk = index / kChunkSize;
+    std::size_t offset = index % kChunkSize;
+    if (chunk >= m_chunks.size()) {
+        return m_tail->hostTimes.at(offset);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Chunk &c = *m_chunks[chunk];
+        if (!c.summary.spilled) {
+            return c.hostTimes.at(offset);
+        }
+    }
+    return pageIn(chunk).hostTimes[offset];
+}
+
+std::vector<SegmentSummary> SampleStore::segments() const {
+    std::vector<SegmentSummary> result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result.reserve(m_chunks.size() + 1);
+        for (const auto &chunk : m_chunks) {
+            result.push_back(chunk->summary);
+        }
+    }
+    if (m_tail) {
+        result.push_back(m_tail->summary);
+    }
+    return result;
+}
+
+std::size_t SampleStore::residentBytes() const {
+    std::size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bytes += m_chunks.capacity() * sizeof(void *);
+        for (const auto &chunk : m_chunks) {
+            bytes += sizeof(Chunk) + chunk->samples.capacity() * sizeof(xlatData) + chunk->hostTimes.memoryBytes();
+        }
+    }
+    if (m_tail) {
+        bytes += sizeof(Chunk) + m_tail->samples.capacity() * sizeof(xlatData) + m_tail->hostTimes.memoryBytes();
+    }
+    for (const auto &cached : m_cache) {
+        bytes += cached.samples.capacity() * sizeof(xlatData) + cached.hostTimes.capacity() * sizeof(std::int64_t);
+    }
+    return bytes;
+}
+
+std::uint64_t SampleStore::spilledBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_spilledBytes;
+}
+
+std::string SampleStore::spillError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+} // namespace xlat
@@ -0,0 +1,189 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#ifndef XLAT_SAMPLESTORE_H
+#define XLAT_SAMPLESTORE_H
+
+#include "xlat_data.h"
+#include "xlat_timing.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xlat {
+
+// Aggregates kept resident for every chunk, spilled or not
+struct SegmentSummary {
+    std::size_t firstIndex = 0;
+    std::size_t count = 0;
+    int minLatency = 0;
+    int maxLatency = 0;
+    std::int64_t latencySum = 0;
+    int firstReport = 0;
+    int lastReport = 0;
+    std::int64_t firstHostTime = 0;
+    std::int64_t lastHostTime = 0;
+    bool spilled = false;
+    std::size_t compressedBytes = 0; // on disk, 0 while resident
+};
+
+// Capture storage with tiered retention, replacing a flat std::vector<xlatData>.
+// Samples fill fixed-size chunks. The newest kResidentChunks sealed chunks stay
+// in RAM; older ones are compressed (xlat_codec.h) and appended to a spill file
+// by a background thread, after which only their SegmentSummary is kept. Reads
+// of spilled chunks page them back in through a small cache. Resident memory is
+// bounded by (kResidentChunks + kCachedChunks + 1) chunks however long a capture
+// runs.
+//
+// append() and the readers are meant for one owning thread; the spill thread
+// only ever touches sealed chunks.
+class SampleStore
+{
+public:
+    static const std::size_t kChunkSize = 1 << 16;
+    static const std::size_t kResidentChunks = 4;
+    static const std::size_t kCachedChunks = 2;
+    static const std::int64_t kNoHostTime = INT64_MIN;
+
+    // An empty `spillPath` keeps everything in RAM
+    explicit SampleStore(std::string spillPath = std::string());
+    ~SampleStore();
+
+    SampleStore(const SampleStore &) = delete;
+    SampleStore &operator=(const SampleStore &) = delete;
+
+    void append(const xlatData &sample, std::int64_t hostTimeNs = kNoHostTime);
+    void clear();
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const xlatData &back() const { return m_last; }
+
+    // True when every sample came with a host time
+    bool hasHostTimes() const { return m_size != 0 && m_withoutHostTime == 0; }
+    // Host time of the first sample
+    std::int64_t hostTimeOrigin() const { return m_hostTimeOrigin; }
+
+    xlatData at(std::size_t index) const;
+    std::int64_t hostTimeAt(std::size_t index) const;
+
+    // Copies samples [begin, begin + count) out, paging spilled chunks in.
+    // `hostTimesNs` may be null.
+    void read(std::size_t begin, std::size_t count, xlatData *samples, std::int64_t *hostTimesNs = nullptr) const;
+
+    // Visits [begin, end) chunk by chunk: fn(std::size_t index, const xlatData &, std::int64_t hostTimeNs)
+    template <typename Fn>
+    void forEach(std::size_t begin, std::size_t end, Fn fn) const {
+        std::vector<xlatData> samples;
+        std::vector<std::int64_t> times;
+        while (begin < end) {
+            std::size_t n = std::min(end, (begin / kChunkSize + 1) * kChunkSize) - begin;
+            samples.resize(n);
+            times.resize(n);
+            read(begin, n, samples.data(), times.data());
+            for (std::size_t i = 0; i < n; ++i) {
+                fn(begin + i, samples[i], times[i]);
+            }
+            begin += n;
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const { forEach(0, m_size, fn); }
+
+    std::vector<SegmentSummary> segments() const;
+
+    // Chunk i covers samples [i * kChunkSize, (i + 1) * kChunkSize)
+    std::size_t chunkCount() const { return (m_size + kChunkSize - 1) / kChunkSize; }
+
+    // Copies one whole chunk out, decoding it straight from the spill file if
+    // needed. Bypasses the page cache, so several threads may call it at once
+    // for parallel scans, just not while samples are being appended.
+    // Returns the number of samples copied.
+    std::size_t readChunk(std::size_t chunk, xlatData *samples, std::int64_t *hostTimesNs) const;
+
+    std::size_t residentBytes() const;
+    std::uint64_t spilledBytes() const;
+    std::string spillError() const;
+    // Spilled chunks that couldn't be read back, their samples came out as
+    // zeros. Exports compare it before and after and fail when it moved.
+    std::uint64_t readErrors() const { return m_readErrors.load(); }
+
+private:
+    struct Chunk {
+        SegmentSummary summary;
+        std::vector<xlatData> samples; // empty once spilled
+        HostTimeline hostTimes;
+        std::uint64_t fileOffset = 0;
+    };
+
+    struct CachedChunk {
+        std::size_t chunk;
+        std::vector<xlatData> samples;
+        std::vector<std::int64_t> hostTimes;
+        bool ok;
+    };
+
+    void seal();
+    void spillLoop();
+    const CachedChunk &pageIn(std::size_t chunk) const;
+    bool decodeSpilled(std::size_t chunk, std::size_t count, xlatData *samples, std::int64_t *hostTimesNs) const;
+
+    std::string m_spillPath;
+
+    // Tail being filled, owned by the appending thread
+    std::unique_ptr<Chunk> m_tail;
+    std::size_t m_size = 0;
+    std::size_t m_withoutHostTime = 0;
+    std::int64_t m_hostTimeOrigin = 0;
+    xlatData m_last = {};
+
+    // Sealed chunks, structure and spill state guarded by m_mutex
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    std::deque<std::size_t> m_spillQueue;
+    bool m_spilling = false;
+    bool m_stop = false;
+    std::uint64_t m_spilledBytes = 0;
+    mutable std::string m_error; // also set by const reads that fail
+    mutable std::atomic<std::uint64_t> m_readErrors{ 0 };
+    std::thread m_spillThread;
+
+    // Spill file, appended by the spill thread and read back by pageIn()
+    mutable std::mutex m_fileMutex;
+    std::FILE *m_file = nullptr;
+    std::uint64_t m_fileEnd = 0;
+
+    mutable std::deque<CachedChunk> m_cache;
+};
+
+} // namespace xlat
+
+#endif // XLAT_SAMPLESTORE_H
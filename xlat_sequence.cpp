@@ -0,0 +1,122 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_sequence.h"
+#include <algorithm>
+
+namespace xlat {
+
+const int SequenceTracker::kRestartWindow;
+const std::size_t SequenceTracker::kMaxRanges;
+
+void SequenceTracker::add(int reportNumber) {
+    ++m_records;
+    if (!m_started) {
+        m_started = true;
+        m_highest = reportNumber;
+        return;
+    }
+
+    const long long step = static_cast<long long>(reportNumber) - m_highest;
+    if (step == 1) {
+        m_highest = reportNumber;
+        return;
+    }
+
+    if (step > 1) {
+        m_missing += std::uint64_t(step - 1);
+        ++m_gaps;
+        if (m_ranges.size() < kMaxRanges) {
+            m_ranges.push_back({ m_highest + 1, reportNumber - 1 });
+        } else {
+            unlist({ m_highest + 1, reportNumber - 1 });
+        }
+        m_highest = reportNumber;
+        return;
+    }
+
+    // Behind: a late record fills part of a gap, anything else was seen before
+    auto it = std::lower_bound(m_ranges.begin() + std::ptrdiff_t(m_openFrom), m_ranges.end(), reportNumber,
+                               [](const GapRange &range, int report) { return range.last < report; });
+    if (it != m_ranges.end() && it->first <= reportNumber) {
+        ++m_outOfOrder;
+        --m_missing;
+        if (it->first == it->last) {
+            m_ranges.erase(it);
+        } else if (reportNumber == it->first) {
+            ++it->first;
+        } else if (reportNumber == it->last) {
+            --it->last;
+        } else {
+            GapRange tail = { reportNumber + 1, it->last };
+            it->last = reportNumber - 1;
+            if (m_ranges.size() < kMaxRanges) {
+                m_ranges.insert(it + 1, tail);
+            } else {
+                unlist(tail);
+            }
+        }
+        return;
+    }
+    if (m_unlistedMissing && reportNumber >= m_unlistedFrom) {
+        ++m_outOfOrder;
+        --m_missing;
+        --m_unlistedMissing;
+        return;
+    }
+
+    if (-step > kRestartWindow) {
+        ++m_restarts;
+        m_highest = reportNumber;
+        m_openFrom = m_ranges.size(); // the old run's gaps can't be filled any more
+        m_unlistedMissing = 0;
+        return;
+    }
+    ++m_duplicates;
+}
+
+void SequenceTracker::unlist(const GapRange &range) {
+    if (!m_unlistedMissing || range.first < m_unlistedFrom) {
+        m_unlistedFrom = range.first;
+    }
+    m_unlistedMissing += std::uint64_t(static_cast<long long>(range.last) - range.first + 1);
+    m_truncated = true;
+}
+
+void SequenceTracker::clear() {
+    *this = SequenceTracker();
+}
+
+std::string SequenceTracker::formatRanges(std::size_t maxRanges) const {
+    std::string out;
+    std::size_t n = std::min(maxRanges, m_ranges.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i) out += ' ';
+        out += std::to_string(m_ranges[i].first);
+        if (m_ranges[i].last != m_ranges[i].first) {
+            out += '-';
+            out += std::to_string(m_ranges[i].last);
+        }
+    }
+    if (n < m_ranges.size() || m_truncated) {
+        out += n ? " ..." : "...";
+    }
+    return out;
+}
+
+} // namespace xlat
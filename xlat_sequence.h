@@ -0,0 +1,117 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_SEQUENCE_H
+#define XLAT_SEQUENCE_H
+
+#include "xlat_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xlat {
+
+// Report numbers the host never received, both ends inclusive
+struct GapRange {
+    int first;
+    int last;
+};
+
+// Continuity of the device's report numbers as seen on the ingest path. Every
+// record is classified against the highest number so far:
+//  - the next number: in sequence
+//  - further ahead: the numbers in between are missing, a gap opens
+//  - behind, inside an open gap: a late (out-of-order) record, the gap shrinks
+//  - behind otherwise: a duplicate
+// A jump back of more than kRestartWindow outside any gap is taken as the
+// device starting a new run rather than thousands of duplicates.
+//
+// Past kMaxRanges gaps are only counted. A record behind the highest number, at
+// or past the first gap that wasn't listed, is then taken as late while any of
+// those unlisted numbers are still missing.
+class SequenceTracker
+{
+public:
+    static const int kRestartWindow = 1000;
+    static const std::size_t kMaxRanges = 10000; // listed, the counters go on past it
+
+    void add(int reportNumber);
+    void clear();
+
+    std::uint64_t records() const { return m_records; }
+    std::uint64_t missing() const { return m_missing; }
+    std::uint64_t gaps() const { return m_gaps; }
+    std::uint64_t duplicates() const { return m_duplicates; }
+    std::uint64_t outOfOrder() const { return m_outOfOrder; }
+    std::uint64_t restarts() const { return m_restarts; }
+
+    // Every gap still missing, oldest first
+    const std::vector<GapRange> &gapRanges() const { return m_ranges; }
+    bool rangesTruncated() const { return m_truncated; }
+
+    // "12-15 40 97-120", at most maxRanges of them followed by "..."
+    std::string formatRanges(std::size_t maxRanges) const;
+
+private:
+    // Counts a gap that has no room in the list
+    void unlist(const GapRange &range);
+
+    bool m_started = false;
+    int m_highest = 0;
+    std::uint64_t m_records = 0;
+    std::uint64_t m_missing = 0;
+    std::uint64_t m_gaps = 0;
+    std::uint64_t m_duplicates = 0;
+    std::uint64_t m_outOfOrder = 0;
+    std::uint64_t m_restarts = 0;
+    std::vector<GapRange> m_ranges;
+    std::size_t m_openFrom = 0; // first range of the current run
+    bool m_truncated = false;
+    int m_unlistedFrom = 0;              // first report of the unlisted gaps, current run
+    std::uint64_t m_unlistedMissing = 0; // part of m_missing in those gaps
+};
+
+// The device's running average/stdev (last record) against the host's values
+// over the records it received. Loss that isn't random, e.g. reports dropped
+// while the host was busy with a spike, pulls the two apart.
+struct DeviceCrossCheck {
+    double hostMean = 0.0;
+    double deviceMean = 0.0;
+    double hostStdev = 0.0;
+    double deviceStdev = 0.0;
+
+    double meanDelta() const { return hostMean - deviceMean; }
+    double stdevDelta() const { return hostStdev - deviceStdev; }
+    // Relative to the device value, 0 when it has none
+    double meanDeltaPercent() const { return deviceMean != 0.0 ? 100.0 * meanDelta() / deviceMean : 0.0; }
+    double stdevDeltaPercent() const { return deviceStdev != 0.0 ? 100.0 * stdevDelta() / deviceStdev : 0.0; }
+};
+
+inline DeviceCrossCheck crossCheck(const xlatData &last, double hostMean, double hostStdev) {
+    DeviceCrossCheck check;
+    check.hostMean = hostMean;
+    check.deviceMean = last.avgLatency;
+    check.hostStdev = hostStdev;
+    check.deviceStdev = last.stdev;
+    return check;
+}
+
+} // namespace xlat
+
+#endif // XLAT_SEQUENCE_H
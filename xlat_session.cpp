@@ -0,0 +1,229 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_session.h"
+#include "xlat_alloctrack.h"
+#include "xlat_archive.h"
+#include <cctype>
+#include <cstring>
+
+namespace xlat {
+
+CaptureSession::CaptureSession(std::string spillPath)
+    : m_store(std::move(spillPath))
+{
+}
+
+std::uint8_t CaptureSession::ingest(const xlatData &record, std::int64_t hostTimeNs) {
+    std::uint8_t rules;
+    {
+        AllocScope scope(AllocStage::Checks);
+
+        // Report numbers are sequential, gaps mean the host never saw some of them
+        m_sequence.add(record.reportNumber);
+
+        const bool timed = hostTimeNs != SampleStore::kNoHostTime;
+        std::int64_t captureTimeNs = !timed ? -1 : m_store.empty() ? 0 : hostTimeNs - m_store.hostTimeOrigin();
+        if (timed) {
+            m_arrival.add(hostTimeNs);
+        }
+
+        // Spike check runs against the distribution seen so far, before the record joins it
+        rules = m_outliers.check(m_store.size(), record, captureTimeNs);
+    }
+    {
+        AllocScope scope(AllocStage::Store);
+        m_store.append(record, hostTimeNs);
+    }
+    {
+        AllocScope scope(AllocStage::Metrics);
+        m_metrics.add(record.latency);
+        m_outliers.sampleAdded(m_metrics.histogram());
+    }
+    {
+        AllocScope scope(AllocStage::Timeline);
+        m_timeline.add(record.latency, hostTimeNs);
+    }
+    return rules;
+}
+
+std::size_t CaptureSession::pushBytes(const char *data, std::size_t size, std::int64_t hostTimeNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AllocScope scope(AllocStage::Parse);
+    std::size_t records = 0;
+    m_parser.feed(data, size, [&](const xlatData &record) {
+        ingest(record, hostTimeNs);
+        ++records;
+    });
+    noteAllocSamples(records);
+    return records;
+}
+
+std::uint8_t CaptureSession::pushRecord(const xlatData &record, std::int64_t hostTimeNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    noteAllocSamples(1);
+    return ingest(record, hostTimeNs);
+}
+
+void CaptureSession::pushCapture(const std::vector<xlatData> &samples, const std::vector<std::int64_t> &hostTimesNs,
+                                 bool rebuildTimeline) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool timed = hostTimesNs.size() == samples.size();
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        m_store.append(samples[i], timed ? hostTimesNs[i] : SampleStore::kNoHostTime);
+        m_sequence.add(samples[i].reportNumber);
+        if (timed) {
+            m_arrival.add(hostTimesNs[i]);
+        }
+    }
+    m_metrics.addBatch(samples.data(), samples.data() + samples.size());
+    if (!m_store.empty()) {
+        m_outliers.scan(m_store, m_metrics.histogram());
+    }
+    if (rebuildTimeline) {
+        m_timeline.rebuild(m_store, m_timeline.settings());
+    }
+}
+
+void CaptureSession::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_parser.reset();
+    m_store.clear();
+    m_metrics.clear();
+    m_arrival.clear();
+    m_sequence.clear();
+    m_outliers.clear();
+    m_timeline.clear();
+}
+
+void CaptureSession::evaluate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_metrics.evaluate();
+}
+
+MetricsSnapshot CaptureSession::snapshot() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_metrics.evaluate();
+
+    MetricsSnapshot snapshot;
+    snapshot.samples = m_metrics.count();
+    snapshot.minLatency = int(m_metrics.value<MinLatency>());
+    snapshot.maxLatency = int(m_metrics.value<MaxLatency>());
+    snapshot.p50 = int(m_metrics.value<MedianLatency>());
+    snapshot.p90 = int(m_metrics.value<P90>());
+    snapshot.p95 = int(m_metrics.value<P95>());
+    snapshot.p99 = int(m_metrics.value<P99>());
+    snapshot.avgLatency = m_metrics.value<MeanLatency>();
+    snapshot.stdev = m_metrics.value<StandardDeviation>();
+    snapshot.metrics = m_metrics.values();
+    snapshot.ingestRate = m_arrival.reportRate();
+    snapshot.jitterUs = m_arrival.jitterUs();
+    snapshot.droppedFrames = m_parser.malformedLines() + m_sequence.missing();
+    snapshot.duplicateReports = m_sequence.duplicates();
+    snapshot.outOfOrderReports = m_sequence.outOfOrder();
+    snapshot.outliers = m_outliers.outliers().size();
+    return snapshot;
+}
+
+bool readCapture(const std::string &path, CaptureCsv &capture, std::string *error) {
+    const char *suffix = ".xlatc";
+    const std::size_t n = std::strlen(suffix);
+    bool archived = path.size() >= n;
+    for (std::size_t i = 0; archived && i < n; ++i) {
+        archived = std::tolower(static_cast<unsigned char>(path[path.size() - n + i])) == suffix[i];
+    }
+
+    if (archived) {
+        CaptureArchive archive;
+        return archive.open(path, error) && archive.readAll(capture.samples, &capture.hostTimesNs, error);
+    }
+    return readCaptureCsv(path, capture, error) != CsvReadStatus::OpenFailed;
+}
+
+std::string captureCsvHeader(const CaptureSession &session, const BootstrapIntervals &intervals) {
+    std::string out;
+    auto line = [&out](const char *label, double value, int decimals) {
+        out += label;
+        out += ": ";
+        appendNumber(out, value, decimals);
+        out += '\n';
+    };
+    auto count = [&out](const char *label, std::uint64_t value) {
+        out += label;
+        out += ": ";
+        out += std::to_string(value);
+        out += '\n';
+    };
+
+    session.metrics().forEachResult([&](const MetricInfo &info, double value) {
+        line(info.label, value, info.decimals);
+    });
+
+    ArrivalSummary timing = session.arrival().summary();
+    if (timing.reports >= 2) {
+        line("Report Rate", timing.reportRate, 2);
+        line("Mean Inter-arrival (us)", timing.meanIntervalUs, 1);
+        line("Inter-arrival Jitter (us)", timing.jitterUs, 1);
+        count("Median Inter-arrival (us)", std::uint64_t(timing.medianIntervalUs));
+        count("p99 Inter-arrival (us)", std::uint64_t(timing.p99IntervalUs));
+        count("Max Inter-arrival (us)", std::uint64_t(timing.maxIntervalUs));
+        count("Delivery Stalls", timing.stalls);
+    }
+
+    const SequenceTracker &sequence = session.sequence();
+    count("Missing Reports", sequence.missing());
+    count("Report Gaps", sequence.gaps());
+    count("Duplicate Reports", sequence.duplicates());
+    count("Out-of-order Reports", sequence.outOfOrder());
+    if (!sequence.gapRanges().empty()) {
+        out += "Gap Ranges: " + sequence.formatRanges(100) + "\n";
+    }
+    if (!session.store().empty()) {
+        DeviceCrossCheck check = crossCheck(session.store().back(), session.metrics().value<MeanLatency>(),
+                                            session.metrics().value<StandardDeviation>());
+        line("Host-Device Mean Delta (us)", check.meanDelta(), 2);
+        line("Host-Device Stdev Delta (us)", check.stdevDelta(), 2);
+    }
+
+    if (intervals.isValid()) {
+        std::string level;
+        appendNumber(level, intervals.confidence * 100, 0);
+        level += "% CI: ";
+        auto interval = [&](const char *name, const ConfidenceInterval &ci) {
+            out += name;
+            out += ' ';
+            out += level;
+            appendNumber(out, ci.low);
+            out += " - ";
+            appendNumber(out, ci.high);
+            out += '\n';
+        };
+        count("Bootstrap Resamples", std::uint64_t(intervals.resamples));
+        interval("p5", intervals.p5);
+        interval("p10", intervals.p10);
+        interval("p90", intervals.p90);
+        interval("p95", intervals.p95);
+        interval("IQR", intervals.iqr);
+        interval("Average Latency", intervals.avgLatency);
+        interval("Median Latency", intervals.median);
+    }
+    out += '\n';
+    return out;
+}
+
+} // namespace xlat
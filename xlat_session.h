@@ -0,0 +1,125 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_SESSION_H
+#define XLAT_SESSION_H
+
+#include "xlat_bootstrap.h"
+#include "xlat_csv.h"
+#include "xlat_data.h"
+#include "xlat_metrics.h"
+#include "xlat_outliers.h"
+#include "xlat_parser.h"
+#include "xlat_samplestore.h"
+#include "xlat_sequence.h"
+#include "xlat_timeline.h"
+#include "xlat_timing.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xlat {
+
+// One capture, from the raw device bytes to metrics, with no Qt involved.
+// Entry point of the core library (xlat-core.pro):
+//
+//   xlat::CaptureSession session;
+//   session.pushBytes(buffer, n, xlat::monotonicNowNs()); // reader thread
+//   xlat::MetricsSnapshot s = session.snapshot();         // any other thread
+//
+// push*(), clear(), evaluate(), snapshot() and read() take the session lock and
+// may be called from any thread. The component accessors further down don't:
+// they are for an owner that does all the pushing on its own thread, like the
+// main window, and return references valid for the session's lifetime.
+class CaptureSession
+{
+public:
+    // Old chunks spill to `spillPath` once the capture outgrows RAM, empty keeps
+    // everything resident (see SampleStore)
+    explicit CaptureSession(std::string spillPath = std::string());
+
+    CaptureSession(const CaptureSession &) = delete;
+    CaptureSession &operator=(const CaptureSession &) = delete;
+
+    // Bytes as read from the device. Lines split across reads are completed by
+    // the next push; every record of one push shares hostTimeNs, the moment the
+    // read returned. Returns the number of records ingested.
+    std::size_t pushBytes(const char *data, std::size_t size, std::int64_t hostTimeNs);
+    // One record, returns the OutlierRule bits it tripped (0 = normal)
+    std::uint8_t pushRecord(const xlatData &record, std::int64_t hostTimeNs = SampleStore::kNoHostTime);
+    // A finished capture, e.g. a file: metrics in one batch and outliers
+    // classified against the whole distribution. hostTimesNs is empty or holds
+    // one time per sample. The timeline can be left for the caller to load.
+    void pushCapture(const std::vector<xlatData> &samples, const std::vector<std::int64_t> &hostTimesNs,
+                     bool rebuildTimeline = true);
+    void clear();
+
+    // Brings metrics().values() up to date
+    void evaluate();
+    // Evaluated metrics and counters. sequence and timestampMs are left 0 for
+    // the publisher to fill.
+    MetricsSnapshot snapshot();
+
+    // fn(const CaptureSession &) under the lock, for consistent reads of the
+    // whole capture (exports, charts) while another thread is pushing
+    template <typename Fn>
+    auto read(Fn fn) const -> decltype(fn(std::declval<const CaptureSession &>())) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return fn(*this);
+    }
+
+    // Unlocked, see the class comment
+    const SampleStore &store() const { return m_store; }
+    const LatencyMetrics &metrics() const { return m_metrics; }
+    const RecordParser &parser() const { return m_parser; }
+    const ArrivalStats &arrival() const { return m_arrival; }
+    const SequenceTracker &sequence() const { return m_sequence; }
+    const OutlierDetector &outliers() const { return m_outliers; }
+    OutlierDetector &outliers() { return m_outliers; }
+    const SegmentTimeline &timeline() const { return m_timeline; }
+    SegmentTimeline &timeline() { return m_timeline; }
+
+private:
+    std::uint8_t ingest(const xlatData &record, std::int64_t hostTimeNs);
+
+    mutable std::mutex m_mutex;
+    RecordParser m_parser;
+    SampleStore m_store;
+    LatencyMetrics m_metrics;
+    ArrivalStats m_arrival;
+    SequenceTracker m_sequence;
+    OutlierDetector m_outliers;
+    SegmentTimeline m_timeline;
+};
+
+// Reads a .csv or .xlatc capture, picked by extension, for pushCapture(). False
+// when the file can't be read; CSV lines that were rejected are left in
+// capture.errors and don't fail the read.
+bool readCapture(const std::string &path, CaptureCsv &capture, std::string *error = nullptr);
+
+// The "label: value" metric block saveCSV() writes above the samples, with the
+// blank line that ends it. Metrics must be evaluated; no CI lines when
+// `intervals` is invalid.
+std::string captureCsvHeader(const CaptureSession &session, const BootstrapIntervals &intervals);
+
+} // namespace xlat
+
+#endif // XLAT_SESSION_H
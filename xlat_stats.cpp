@@ -0,0 +1,237 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace xlat {
+
+namespace {
+
+typedef std::vector<std::pair<int, std::uint64_t>> BinList;
+
+BinList binsOf(const LatencyHistogram &histogram) {
+    BinList bins;
+    histogram.forEachBin([&](int latency, std::uint64_t count) {
+        bins.emplace_back(latency, count);
+    });
+    return bins;
+}
+
+// Walks the union of both bin lists in ascending latency order: fn(latency, countA, countB)
+template <typename Fn>
+void forEachMergedBin(const BinList &a, const BinList &b, Fn fn) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (j == b.size() || (i < a.size() && a[i].first < b[j].first)) {
+            fn(a[i].first, a[i].second, std::uint64_t(0));
+            ++i;
+        } else if (i == a.size() || b[j].first < a[i].first) {
+            fn(b[j].first, std::uint64_t(0), b[j].second);
+            ++j;
+        } else {
+            fn(a[i].first, a[i].second, b[j].second);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+// Kolmogorov distribution tail, Q_KS(lambda) = 2 * sum (-1)^(k-1) exp(-2 k^2 lambda^2)
+double kolmogorovTail(double lambda) {
+    if (lambda < 1.18) {
+        // Series converges slowly here, use the complementary form instead
+        if (lambda <= 0.0) return 1.0;
+        const double pi = 3.14159265358979323846;
+        double y = std::exp(-pi * pi / (8.0 * lambda * lambda));
+        double sum = y + std::pow(y, 9) + std::pow(y, 25) + std::pow(y, 49);
+        return 1.0 - std::sqrt(2.0 * pi) / lambda * sum;
+    }
+    double sum = 0.0;
+    double sign = 1.0;
+    for (int k = 1; k <= 100; ++k) {
+        double term = std::exp(-2.0 * k * k * lambda * lambda);
+        sum += sign * term;
+        if (term < 1e-12) break;
+        sign = -sign;
+    }
+    return std::min(1.0, std::max(0.0, 2.0 * sum));
+}
+
+} // namespace
+
+LatencySummary summarize(const LatencyHistogram &histogram) {
+    LatencySummary s;
+    s.count = histogram.count();
+    if (s.count == 0) return s;
+
+    const double fractions[] = { 0.05, 0.10, 0.25, 0.75, 0.90, 0.95, 0.99 };
+    const std::size_t n = sizeof(fractions) / sizeof(fractions[0]);
+    std::uint64_t ranks[n];
+    int values[n];
+    for (std::size_t i = 0; i < n; ++i) {
+        ranks[i] = histogram.percentileRank(fractions[i]);
+    }
+    histogram.valuesAtRanks(ranks, values, n);
+
+    s.p5 = values[0];
+    s.p10 = values[1];
+    s.iqr = values[3] - values[2];
+    s.p90 = values[4];
+    s.p95 = values[5];
+    s.p99 = values[6];
+    s.minLatency = histogram.minValue();
+    s.maxLatency = histogram.maxValue();
+    s.medianLatency = histogram.median();
+
+    // Deviations are measured from the middle sample, as dataInterpolation() does
+    int middle = histogram.valueAtRank(s.count / 2);
+    double sum = 0.0;
+    double absDev = 0.0;
+    double sqDev = 0.0;
+    histogram.forEachBin([&](int latency, std::uint64_t count) {
+        double c = static_cast<double>(count);
+        double difference = static_cast<double>(latency) - middle;
+        sum += c * latency;
+        absDev += c * std::abs(difference);
+        sqDev += c * difference * difference;
+    });
+
+    double size = static_cast<double>(s.count);
+    s.avgLatency = sum / size;
+    s.mad = absDev / size;
+    s.stdev = std::sqrt(sqDev / size);
+    return s;
+}
+
+TestResult kolmogorovSmirnov(const LatencyHistogram &a, const LatencyHistogram &b) {
+    TestResult result;
+    if (a.isEmpty() || b.isEmpty()) return result;
+
+    double n = static_cast<double>(a.count());
+    double m = static_cast<double>(b.count());
+    double cumA = 0.0;
+    double cumB = 0.0;
+    double d = 0.0;
+    forEachMergedBin(binsOf(a), binsOf(b), [&](int, std::uint64_t countA, std::uint64_t countB) {
+        cumA += static_cast<double>(countA);
+        cumB += static_cast<double>(countB);
+        d = std::max(d, std::abs(cumA / n - cumB / m));
+    });
+
+    double en = std::sqrt(n * m / (n + m));
+    double lambda = (en + 0.12 + 0.11 / en) * d;
+    result.statistic = d;
+    result.z = lambda;
+    result.pValue = kolmogorovTail(lambda);
+    result.effect = d;
+    return result;
+}
+
+TestResult mannWhitneyU(const LatencyHistogram &a, const LatencyHistogram &b) {
+    TestResult result;
+    if (a.isEmpty() || b.isEmpty()) return result;
+
+    double n = static_cast<double>(a.count());
+    double m = static_cast<double>(b.count());
+    double total = n + m;
+
+    // Tied samples share the average of the ranks they span
+    double rankSumA = 0.0;
+    double ranked = 0.0;
+    double tieTerm = 0.0;
+    forEachMergedBin(binsOf(a), binsOf(b), [&](int, std::uint64_t countA, std::uint64_t countB) {
+        double t = static_cast<double>(countA + countB);
+        double averageRank = ranked + (t + 1.0) / 2.0;
+        rankSumA += static_cast<double>(countA) * averageRank;
+        tieTerm += t * t * t - t;
+        ranked += t;
+    });
+
+    double u = rankSumA - n * (n + 1.0) / 2.0;
+    double mean = n * m / 2.0;
+    double variance = n * m / 12.0 * ((total + 1.0) - tieTerm / (total * (total - 1.0)));
+
+    result.statistic = u;
+    result.effect = 1.0 - u / (n * m);
+    if (variance <= 0.0) {
+        return result; // Every sample identical, nothing to tell apart
+    }
+
+    double deviation = u - mean;
+    double corrected = std::max(0.0, std::abs(deviation) - 0.5);
+    result.z = (deviation < 0 ? -corrected : corrected) / std::sqrt(variance);
+    result.pValue = std::erfc(std::abs(result.z) / std::sqrt(2.0));
+    return result;
+}
+
+std::vector<CdfPoint> ecdfPoints(const LatencyHistogram &histogram, std::size_t maxPoints) {
+    std::vector<CdfPoint> points;
+    if (histogram.isEmpty()) return points;
+
+    const double total = static_cast<double>(histogram.count());
+    const double latencyStep = static_cast<double>(histogram.maxValue() - histogram.minValue()) / std::max<std::size_t>(1, maxPoints);
+    const double fractionStep = 1.0 / std::max<std::size_t>(1, maxPoints);
+    std::uint64_t seen = 0;
+    histogram.forEachBin([&](int latency, std::uint64_t count) {
+        seen += count;
+        CdfPoint point = { latency, static_cast<double>(seen) / total };
+        if (points.empty() || latency == histogram.maxValue()
+            || latency - points.back().latency >= latencyStep
+            || point.fraction - points.back().fraction >= fractionStep) {
+            points.push_back(point);
+        }
+    });
+    return points;
+}
+
+double spectrumPosition(double fraction) {
+    return -std::log10(1.0 - fraction);
+}
+
+std::vector<SpectrumPoint> percentileSpectrum(const LatencyHistogram &histogram, std::size_t points, double highest) {
+    std::vector<SpectrumPoint> spectrum;
+    if (histogram.isEmpty() || points < 2) return spectrum;
+
+    const double first = spectrumPosition(0.5);
+    const double last = std::min(spectrumPosition(highest), std::log10(static_cast<double>(histogram.count())));
+    if (last <= first) {
+        spectrum.push_back({ 0.5, histogram.percentile(0.5) });
+        return spectrum;
+    }
+
+    std::vector<std::uint64_t> ranks(points);
+    std::vector<int> values(points);
+    spectrum.resize(points);
+    for (std::size_t i = 0; i < points; ++i) {
+        double position = first + (last - first) * static_cast<double>(i) / static_cast<double>(points - 1);
+        spectrum[i].fraction = 1.0 - std::pow(10.0, -position);
+        ranks[i] = histogram.percentileRank(spectrum[i].fraction);
+    }
+    histogram.valuesAtRanks(ranks.data(), values.data(), points);
+    for (std::size_t i = 0; i < points; ++i) {
+        spectrum[i].latency = values[i];
+    }
+    return spectrum;
+}
+
+} // namespace xlat
@@ -0,0 +1,93 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_STATS_H
+#define XLAT_STATS_H
+
+#include "xlat_histogram.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xlat {
+
+// The metric set shown in the main window, with the same definitions as
+// xlat_evtool::dataInterpolation(): percentiles are sorted[round(q * size)],
+// MAD and STDEV are taken around the middle sample.
+struct LatencySummary {
+    std::uint64_t count = 0;
+    int minLatency = 0;
+    int maxLatency = 0;
+    int p5 = 0;
+    int p10 = 0;
+    int p90 = 0;
+    int p95 = 0;
+    int p99 = 0;
+    int medianLatency = 0;
+    int iqr = 0;
+    double avgLatency = 0.0;
+    double mad = 0.0;
+    double stdev = 0.0;
+};
+
+LatencySummary summarize(const LatencyHistogram &histogram);
+
+// Result of a two-sample test between two latency distributions
+struct TestResult {
+    double statistic = 0.0; // KS: D, Mann-Whitney: U of the first sample
+    double z = 0.0;         // KS: scaled lambda, Mann-Whitney: normal approximation
+    double pValue = 1.0;    // two-sided
+    double effect = 0.0;    // KS: D, Mann-Whitney: P(b > a) + P(b == a) / 2
+};
+
+// Two-sample Kolmogorov-Smirnov test with the asymptotic p-value
+TestResult kolmogorovSmirnov(const LatencyHistogram &a, const LatencyHistogram &b);
+
+// Mann-Whitney U test, normal approximation with tie and continuity correction.
+// Ranks are assigned per histogram bin so no merged sort of the samples is needed.
+TestResult mannWhitneyU(const LatencyHistogram &a, const LatencyHistogram &b);
+
+struct CdfPoint {
+    int latency;
+    double fraction; // of samples <= latency
+};
+
+// Empirical CDF read off the histogram, thinned to about maxPoints: an occupied
+// bin is kept once the curve has moved by 1/maxPoints of the latency range or
+// of the samples since the last kept one, the first and last always are. The
+// point count depends on maxPoints, not on the capture size.
+std::vector<CdfPoint> ecdfPoints(const LatencyHistogram &histogram, std::size_t maxPoints = 1024);
+
+struct SpectrumPoint {
+    double fraction; // 0.5 for p50, 0.9999 for p99.99
+    int latency;
+};
+
+// Position of a percentile on a spectrum axis, -log10(1 - fraction): every
+// "nine" is one unit wide
+double spectrumPosition(double fraction);
+
+// Percentiles from p50 up to `highest`, spaced evenly on the spectrum axis and
+// resolved in one walk over the bins. Stops where the ranks run out: with n
+// samples nothing beyond 1 - 1/n is returned.
+std::vector<SpectrumPoint> percentileSpectrum(const LatencyHistogram &histogram, std::size_t points = 256,
+                                              double highest = 0.9999);
+
+} // namespace xlat
+
+#endif // XLAT_STATS_H
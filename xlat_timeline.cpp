@@ -0,0 +1,306 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_timeline.h"
+#include "xlat_parallel.h"
+#include "xlat_samplestore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace xlat {
+
+const char SegmentTimeline::kMagic[8] = { 'X', 'L', 'A', 'T', 'S', 'E', 'G', '1' };
+
+namespace {
+
+const std::size_t kHeaderSize = 48;
+const std::size_t kSegmentSize = 28;
+
+void putLE(std::vector<std::uint8_t> &out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+}
+
+std::uint64_t getLE(const std::uint8_t *p, int bytes) {
+    std::uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v |= std::uint64_t(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+bool fail(std::string *error, const std::string &message) {
+    if (error) *error = message;
+    return false;
+}
+
+} // namespace
+
+std::int64_t SegmentTimeline::periodNs() const {
+    return std::max<std::int64_t>(1000000, std::llround(m_settings.size * 1e9));
+}
+
+std::int64_t SegmentTimeline::keyOf(std::size_t index, std::int64_t relativeNs) const {
+    if (m_settings.unit == SegmentUnit::Seconds) {
+        // Samples without a usable time stay in the open segment
+        return relativeNs >= 0 ? relativeNs / periodNs() : m_openKey;
+    }
+    return static_cast<std::int64_t>(index / std::max<std::size_t>(1, std::size_t(std::llround(m_settings.size))));
+}
+
+TimelineSegment SegmentTimeline::summarize(const LatencyHistogram &histogram, std::size_t first, std::int64_t startNs) {
+    TimelineSegment s;
+    s.firstIndex = first;
+    s.count = static_cast<std::uint32_t>(histogram.count());
+    s.startNs = startNs;
+    if (histogram.isEmpty()) return s;
+
+    const double fractions[] = { 0.05, 0.95 };
+    std::uint64_t ranks[2];
+    int values[2];
+    for (int i = 0; i < 2; ++i) {
+        ranks[i] = histogram.percentileRank(fractions[i]);
+    }
+    histogram.valuesAtRanks(ranks, values, 2);
+    s.p5 = values[0];
+    s.p95 = values[1];
+    s.p50 = histogram.median();
+    s.maxLatency = histogram.maxValue();
+    return s;
+}
+
+void SegmentTimeline::add(int latency, std::int64_t hostTimeNs) {
+    const bool timed = hostTimeNs != SampleStore::kNoHostTime;
+    if (m_samples == 0) {
+        m_origin = timed ? hostTimeNs : 0;
+    }
+    const std::int64_t relative = timed ? hostTimeNs - m_origin : -1;
+    const std::int64_t key = keyOf(m_samples, relative);
+
+    if (!m_open.isEmpty() && key > m_openKey) {
+        m_segments.push_back(summarize(m_open, m_openFirst, m_openStart));
+        m_open.clear();
+    }
+    if (m_open.isEmpty()) {
+        m_openFirst = m_samples;
+        m_openStart = relative;
+        m_openKey = key;
+    }
+    m_open.add(latency);
+    ++m_samples;
+}
+
+void SegmentTimeline::clear() {
+    m_segments.clear();
+    m_samples = 0;
+    m_origin = 0;
+    m_open.clear();
+    m_openFirst = 0;
+    m_openStart = -1;
+    m_openKey = 0;
+}
+
+TimelineSegment SegmentTimeline::openSegment() const {
+    return summarize(m_open, m_openFirst, m_openStart);
+}
+
+void SegmentTimeline::rebuild(const SampleStore &store, const SegmentSettings &settings) {
+    m_settings = settings;
+    if (m_settings.unit == SegmentUnit::Seconds && !store.empty() && !store.hasHostTimes()) {
+        m_settings.unit = SegmentUnit::Reports;
+    }
+    clear();
+    const std::size_t n = store.size();
+    if (n == 0) return;
+
+    const bool timed = store.hasHostTimes();
+    m_origin = store.hostTimeOrigin();
+
+    // Segment boundaries first. Report segments are fixed; time segments need
+    // one pass over the host times, kept sequential as a segment only closes
+    // on a later time slot than any seen so far.
+    std::vector<std::size_t> starts;
+    if (m_settings.unit == SegmentUnit::Reports) {
+        const std::size_t size = std::max<std::size_t>(1, std::size_t(std::llround(m_settings.size)));
+        for (std::size_t i = 0; i < n; i += size) {
+            starts.push_back(i);
+        }
+    } else {
+        std::vector<xlatData> samples(SampleStore::kChunkSize);
+        std::vector<std::int64_t> times(SampleStore::kChunkSize);
+        for (std::size_t c = 0; c < store.chunkCount(); ++c) {
+            std::size_t count = store.readChunk(c, samples.data(), times.data());
+            for (std::size_t i = 0; i < count; ++i) {
+                std::size_t index = c * SampleStore::kChunkSize + i;
+                std::int64_t key = keyOf(index, times[i] - m_origin);
+                if (starts.empty() || key > m_openKey) {
+                    starts.push_back(index);
+                    m_openKey = key;
+                }
+            }
+        }
+    }
+    starts.push_back(n);
+
+    // Then the statistics, contiguous runs of segments per worker. The last
+    // worker hands its histogram over as the open segment, live samples
+    // carry on from there.
+    const std::size_t segments = starts.size() - 1;
+    std::vector<TimelineSegment> result(segments);
+    const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(workerCount(n), segments));
+    parallelChunks(segments, workers, [&](std::size_t begin, std::size_t end, unsigned) {
+        LatencyHistogram histogram;
+        std::vector<xlatData> samples(SampleStore::kChunkSize);
+        std::vector<std::int64_t> times(SampleStore::kChunkSize);
+        std::size_t segment = begin;
+        std::size_t loaded = SIZE_MAX;
+        for (std::size_t index = starts[begin]; index < starts[end]; ++index) {
+            std::size_t chunk = index / SampleStore::kChunkSize;
+            if (chunk != loaded) {
+                store.readChunk(chunk, samples.data(), timed ? times.data() : nullptr);
+                loaded = chunk;
+            }
+            std::size_t offset = index % SampleStore::kChunkSize;
+            if (index == starts[segment]) {
+                result[segment].startNs = timed ? times[offset] - m_origin : -1;
+            }
+            histogram.add(samples[offset].latency);
+            if (index + 1 == starts[segment + 1]) {
+                if (segment + 1 == segments) break; // left open
+                result[segment] = summarize(histogram, starts[segment], result[segment].startNs);
+                histogram.clear();
+                ++segment;
+            }
+        }
+        if (end == segments) {
+            m_open = std::move(histogram);
+        }
+    });
+
+    m_openFirst = starts[segments - 1];
+    m_openStart = result.back().startNs;
+    if (m_settings.unit == SegmentUnit::Reports) {
+        m_openKey = keyOf(m_openFirst, m_openStart);
+    }
+    result.pop_back();
+    m_segments = std::move(result);
+    m_samples = n;
+}
+
+bool SegmentTimeline::save(const std::string &path, std::uint64_t captureBytes, std::string *error) const {
+    std::vector<std::uint8_t> buffer(kMagic, kMagic + sizeof(kMagic));
+    std::uint64_t sizeBits;
+    std::memcpy(&sizeBits, &m_settings.size, sizeof(sizeBits));
+
+    std::vector<TimelineSegment> all = m_segments;
+    if (!m_open.isEmpty()) {
+        all.push_back(openSegment());
+    }
+
+    putLE(buffer, m_settings.unit == SegmentUnit::Seconds ? 1 : 0, 8);
+    putLE(buffer, sizeBits, 8);
+    putLE(buffer, captureBytes, 8);
+    putLE(buffer, m_samples, 8);
+    putLE(buffer, all.size(), 8);
+    for (const TimelineSegment &s : all) {
+        putLE(buffer, s.count, 4);
+        putLE(buffer, static_cast<std::uint64_t>(s.startNs), 8);
+        putLE(buffer, static_cast<std::uint32_t>(s.p5), 4);
+        putLE(buffer, static_cast<std::uint32_t>(s.p50), 4);
+        putLE(buffer, static_cast<std::uint32_t>(s.p95), 4);
+        putLE(buffer, static_cast<std::uint32_t>(s.maxLatency), 4);
+    }
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return fail(error, "Cannot create " + path);
+    }
+    bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::remove(path.c_str());
+        return fail(error, "Cannot write " + path);
+    }
+    return true;
+}
+
+bool SegmentTimeline::load(const std::string &path, std::uint64_t captureBytes, const SampleStore &store, std::string *error) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return fail(error, "Cannot open " + path);
+    }
+    std::vector<std::uint8_t> buffer;
+    std::uint8_t block[65536];
+    std::size_t got;
+    while ((got = std::fread(block, 1, sizeof(block), file)) > 0) {
+        buffer.insert(buffer.end(), block, block + got);
+    }
+    std::fclose(file);
+
+    if (buffer.size() < kHeaderSize || std::memcmp(buffer.data(), kMagic, sizeof(kMagic)) != 0) {
+        return fail(error, path + " is not a segment timeline");
+    }
+    const std::uint8_t *p = buffer.data() + sizeof(kMagic);
+    SegmentSettings settings;
+    settings.unit = getLE(p, 8) == 1 ? SegmentUnit::Seconds : SegmentUnit::Reports;
+    std::uint64_t sizeBits = getLE(p + 8, 8);
+    std::memcpy(&settings.size, &sizeBits, sizeof(sizeBits));
+    const std::uint64_t bytes = getLE(p + 16, 8);
+    const std::uint64_t samples = getLE(p + 24, 8);
+    const std::uint64_t count = getLE(p + 32, 8);
+    if (bytes != captureBytes || samples != store.size()) {
+        return fail(error, path + " belongs to another capture");
+    }
+    if (count > (buffer.size() - kHeaderSize) / kSegmentSize) {
+        return fail(error, path + " is truncated");
+    }
+
+    std::vector<TimelineSegment> segments(count);
+    std::size_t first = 0;
+    p = buffer.data() + kHeaderSize;
+    for (TimelineSegment &s : segments) {
+        s.firstIndex = first;
+        s.count = static_cast<std::uint32_t>(getLE(p, 4));
+        s.startNs = static_cast<std::int64_t>(getLE(p + 4, 8));
+        s.p5 = static_cast<std::int32_t>(getLE(p + 12, 4));
+        s.p50 = static_cast<std::int32_t>(getLE(p + 16, 4));
+        s.p95 = static_cast<std::int32_t>(getLE(p + 20, 4));
+        s.maxLatency = static_cast<std::int32_t>(getLE(p + 24, 4));
+        first += s.count;
+        p += kSegmentSize;
+    }
+    if (first != samples) {
+        return fail(error, path + " doesn't add up to the capture");
+    }
+
+    // Everything saved is sealed, live samples open a new segment
+    clear();
+    m_settings = settings;
+    m_segments = std::move(segments);
+    m_samples = store.size();
+    m_origin = store.hostTimeOrigin();
+    if (!m_segments.empty()) {
+        m_openKey = keyOf(m_segments.back().firstIndex, m_segments.back().startNs);
+    }
+    return true;
+}
+
+} // namespace xlat
@@ -0,0 +1,101 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_TIMELINE_H
+#define XLAT_TIMELINE_H
+
+#include "xlat_histogram.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xlat {
+
+class SampleStore;
+
+enum class SegmentUnit {
+    Reports,
+    Seconds // host time, aligned to the first sample
+};
+
+struct SegmentSettings {
+    SegmentUnit unit = SegmentUnit::Reports;
+    double size = 1000.0;
+};
+
+// Statistics of one stretch of the capture
+struct TimelineSegment {
+    std::size_t firstIndex = 0;
+    std::uint32_t count = 0;
+    std::int64_t startNs = -1; // host time of the first sample since the capture origin, -1 if unknown
+    int p5 = 0;
+    int p50 = 0;
+    int p95 = 0;
+    int maxLatency = 0;
+};
+
+// Per-segment percentiles over the session, to show drift that whole-capture
+// metrics average away. Fed one sample at a time during capture, only the open
+// segment keeps a histogram and sealed ones are ~40 bytes each. rebuild()
+// recomputes everything from a store on all cores, save()/load() keep the
+// result next to a capture so large files don't need a rebuild.
+class SegmentTimeline
+{
+public:
+    static const char kMagic[8];
+
+    // Changing the settings only takes effect on clear() or rebuild()
+    const SegmentSettings &settings() const { return m_settings; }
+
+    void add(int latency, std::int64_t hostTimeNs);
+    void clear();
+
+    const std::vector<TimelineSegment> &segments() const { return m_segments; }
+    // The segment being filled, count 0 when there is none
+    TimelineSegment openSegment() const;
+    std::size_t samples() const { return m_samples; }
+
+    // Seconds fall back to reports for a capture without host times
+    void rebuild(const SampleStore &store, const SegmentSettings &settings);
+
+    // `captureBytes` ties the file to the capture it was saved with, load()
+    // refuses it for any other size or sample count
+    bool save(const std::string &path, std::uint64_t captureBytes, std::string *error = nullptr) const;
+    bool load(const std::string &path, std::uint64_t captureBytes, const SampleStore &store, std::string *error = nullptr);
+
+private:
+    std::int64_t periodNs() const;
+    // Segment a sample belongs to: its report index or its time slot
+    std::int64_t keyOf(std::size_t index, std::int64_t relativeNs) const;
+    static TimelineSegment summarize(const LatencyHistogram &histogram, std::size_t first, std::int64_t startNs);
+
+    SegmentSettings m_settings;
+    std::vector<TimelineSegment> m_segments;
+    std::size_t m_samples = 0;
+    std::int64_t m_origin = 0;
+
+    LatencyHistogram m_open;
+    std::size_t m_openFirst = 0;
+    std::int64_t m_openStart = -1;
+    std::int64_t m_openKey = 0;
+};
+
+} // namespace xlat
+
+#endif // XLAT_TIMELINE_H
@@ -0,0 +1,141 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "xlat_timing.h"
+#include <algorithm>
+#include <cmath>
+
+namespace xlat {
+
+const std::size_t HostTimeline::kCheckpointInterval;
+const std::uint32_t HostTimeline::kEscape;
+const int ArrivalStats::kStallFactor;
+
+void HostTimeline::append(std::int64_t timestampNs) {
+    std::int64_t delta = m_deltas.empty() ? timestampNs : timestampNs - m_last;
+    if (m_deltas.empty() || delta < 0 || delta >= static_cast<std::int64_t>(kEscape)) {
+        m_deltas.push_back(kEscape);
+        m_wide.push_back(delta);
+    } else {
+        m_deltas.push_back(static_cast<std::uint32_t>(delta));
+    }
+    m_last = timestampNs;
+
+    if ((m_deltas.size() - 1) % kCheckpointInterval == 0) {
+        m_checkpoints.push_back({ timestampNs, m_wide.size() });
+    }
+}
+
+void HostTimeline::clear() {
+    m_deltas.clear();
+    m_wide.clear();
+    m_checkpoints.clear();
+    m_last = 0;
+}
+
+std::int64_t HostTimeline::at(std::size_t i) const {
+    const Checkpoint &checkpoint = m_checkpoints[i / kCheckpointInterval];
+    std::int64_t time = checkpoint.time;
+    std::size_t wide = checkpoint.wideIndex;
+    for (std::size_t j = i - i % kCheckpointInterval + 1; j <= i; ++j) {
+        time += m_deltas[j] == kEscape ? m_wide[wide++] : m_deltas[j];
+    }
+    return time;
+}
+
+void HostTimeline::read(std::size_t begin, std::size_t count, std::int64_t *timesNs) const {
+    if (count == 0) return;
+    const Checkpoint &checkpoint = m_checkpoints[begin / kCheckpointInterval];
+    std::int64_t time = checkpoint.time;
+    std::size_t wide = checkpoint.wideIndex;
+    for (std::size_t j = begin - begin % kCheckpointInterval + 1; j < begin + count; ++j) {
+        time += m_deltas[j] == kEscape ? m_wide[wide++] : m_deltas[j];
+        if (j >= begin) timesNs[j - begin] = time;
+    }
+    if (begin % kCheckpointInterval == 0) timesNs[0] = checkpoint.time;
+}
+
+std::size_t HostTimeline::memoryBytes() const {
+    return m_deltas.capacity() * sizeof(std::uint32_t)
+         + m_wide.capacity() * sizeof(std::int64_t)
+         + m_checkpoints.capacity() * sizeof(Checkpoint);
+}
+
+ArrivalStats::ArrivalStats()
+    : m_intervals(1 << 16)
+{
+}
+
+void ArrivalStats::add(std::int64_t timestampNs) {
+    if (m_count++ == 0) {
+        m_first = m_last = timestampNs;
+        return;
+    }
+
+    double intervalUs = static_cast<double>(timestampNs - m_last) / 1000.0;
+    m_last = timestampNs;
+
+    // Welford update over the m_count - 1 intervals seen so far
+    double n = static_cast<double>(m_count - 1);
+    double delta = intervalUs - m_mean;
+    m_mean += delta / n;
+    m_m2 += delta * (intervalUs - m_mean);
+
+    long long bucket = std::llround(intervalUs);
+    if (bucket >= (1 << 16)) {
+        bucket = std::llround(intervalUs / 1000.0) * 1000;
+    }
+    m_intervals.add(bucket > 0x7fffffffLL ? 0x7fffffff : static_cast<int>(bucket));
+}
+
+void ArrivalStats::clear() {
+    m_intervals.clear();
+    m_count = 0;
+    m_first = m_last = 0;
+    m_mean = m_m2 = 0.0;
+}
+
+double ArrivalStats::reportRate() const {
+    double spanSeconds = static_cast<double>(m_last - m_first) / 1e9;
+    return m_count > 1 && spanSeconds > 0.0 ? static_cast<double>(m_count - 1) / spanSeconds : 0.0;
+}
+
+double ArrivalStats::jitterUs() const {
+    return m_count > 1 ? std::sqrt(m_m2 / static_cast<double>(m_count - 1)) : 0.0;
+}
+
+ArrivalSummary ArrivalStats::summary() const {
+    ArrivalSummary s;
+    s.reports = m_count;
+    if (m_count < 2) return s;
+
+    s.reportRate = reportRate();
+    s.meanIntervalUs = m_mean;
+    s.jitterUs = jitterUs();
+    s.medianIntervalUs = m_intervals.median();
+    s.p99IntervalUs = m_intervals.percentile(0.99);
+    s.maxIntervalUs = m_intervals.maxValue();
+
+    const double stallLimit = static_cast<double>(kStallFactor) * std::max(s.medianIntervalUs, 1);
+    m_intervals.forEachBin([&](int intervalUs, std::uint64_t count) {
+        if (intervalUs > stallLimit) s.stalls += count;
+    });
+    return s;
+}
+
+} // namespace xlat
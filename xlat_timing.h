@@ -0,0 +1,128 @@
+/******************************************************************************
+* Qt COM listener for XLAT, captures data, charts, interpolates metrics for deeper insights.
+* Copyright (c) 2024 axaro1
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef XLAT_TIMING_H
+#define XLAT_TIMING_H
+
+#include "xlat_histogram.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xlat {
+
+// Monotonic host clock in ns, taken the moment a read returns
+inline std::int64_t monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Host arrival time of every record, stored as 32-bit ns deltas to the previous
+// record (4 bytes per sample). Deltas that don't fit, 4.29 s stalls or
+// non-monotonic imported times, are escaped into a side list. A checkpoint every
+// kCheckpointInterval records keeps random access cheap.
+class HostTimeline
+{
+public:
+    void append(std::int64_t timestampNs);
+    void clear();
+
+    std::size_t size() const { return m_deltas.size(); }
+    bool empty() const { return m_deltas.empty(); }
+    std::int64_t origin() const { return m_checkpoints.empty() ? 0 : m_checkpoints.front().time; }
+    std::int64_t last() const { return m_last; }
+
+    // Absolute time of record i
+    std::int64_t at(std::size_t i) const;
+    // Times of records [begin, begin + count), decoded from the nearest checkpoint
+    void read(std::size_t begin, std::size_t count, std::int64_t *timesNs) const;
+
+    // Decodes every timestamp in order: fn(std::int64_t timestampNs)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        std::int64_t time = 0;
+        std::size_t wide = 0;
+        for (std::size_t i = 0; i < m_deltas.size(); ++i) {
+            time += m_deltas[i] == kEscape ? m_wide[wide++] : m_deltas[i];
+            fn(time);
+        }
+    }
+
+    std::size_t memoryBytes() const;
+
+private:
+    static const std::size_t kCheckpointInterval = 1024;
+    static const std::uint32_t kEscape = 0xFFFFFFFFu;
+
+    struct Checkpoint {
+        std::int64_t time;
+        std::size_t wideIndex;
+    };
+
+    std::vector<std::uint32_t> m_deltas; // first entry is escaped, it holds the origin
+    std::vector<std::int64_t> m_wide;
+    std::vector<Checkpoint> m_checkpoints;
+    std::int64_t m_last = 0;
+};
+
+// Host-side delivery metrics: report rate and inter-arrival jitter
+struct ArrivalSummary {
+    std::uint64_t reports = 0;
+    double reportRate = 0.0;     // reports/s over the whole capture
+    double meanIntervalUs = 0.0;
+    double jitterUs = 0.0;       // standard deviation of the inter-arrival time
+    int medianIntervalUs = 0;
+    int p99IntervalUs = 0;
+    int maxIntervalUs = 0;
+    std::uint64_t stalls = 0;    // intervals above kStallFactor x the median
+};
+
+class ArrivalStats
+{
+public:
+    static const int kStallFactor = 10;
+
+    ArrivalStats();
+
+    void add(std::int64_t timestampNs);
+    void clear();
+
+    // Cheap enough to call on every read, summary() also walks the interval histogram
+    std::uint64_t reports() const { return m_count; }
+    double reportRate() const;
+    double jitterUs() const;
+
+    ArrivalSummary summary() const;
+
+    // Inter-arrival times in us. Above 65 ms they are rounded to whole ms, which
+    // keeps the histogram small when reports come one click at a time.
+    const LatencyHistogram &intervalHistogram() const { return m_intervals; }
+
+private:
+    LatencyHistogram m_intervals;
+    std::uint64_t m_count = 0;
+    std::int64_t m_first = 0;
+    std::int64_t m_last = 0;
+    double m_mean = 0.0; // Welford running mean / M2 of the exact intervals, in us
+    double m_m2 = 0.0;
+};
+
+} // namespace xlat
+
+#endif // XLAT_TIMING_H